@@ -20,22 +20,33 @@ with this program. If not, see <https://www.gnu.org/licenses/>
 #include <util/platform.h>
 #include <obs-frontend-api.h>
 
+#include <QApplication>
+#include <QColor>
+#include <QFont>
 #include <QGridLayout>
 #include <QLabel>
 #include <QTimer>
 #include <QString>
-#include <QTableWidget>
-#include <QTableWidgetItem>
+#include <QTableView>
 #include <QHeaderView>
 #include <QPushButton>
 #include <QHBoxLayout>
-#include <QCheckBox>
 #include <QMouseEvent>
+#include <QPainter>
+#include <QScrollBar>
+#include <QStyle>
+#include <QStyleOptionButton>
 
 #include "../plugin-main.hpp"
+#include "../metrics-exporter.hpp"
+#include "../output-start-scheduler.hpp"
+#include "../trace.hpp"
+#include "../video/video-engine.hpp"
 #include "output-status-dock.hpp"
 
 #define TIMER_INTERVAL 2000
+#define ROW_HEIGHT 32
+#define ROW_REFRESH_MIN_INTERVAL_NS 1000000000ULL // Rows scrolled into view are refreshed early, others wait
 #define SETTINGS_JSON_NAME "outputStatusDock.json"
 
 // FIXME: Duplicated definition error with util/base.h
@@ -49,27 +60,35 @@ BranchOutputStatusDock::BranchOutputStatusDock(QWidget *parent) : QFrame(parent)
 {
     setMinimumWidth(320);
 
-    // Setup statistics table
-    outputTable = new QTableWidget(this);
+    // Setup statistics table (Uniform row height lets the view lay out only visible rows)
+    outputTableModel = new OutputTableModel(this);
+    outputTable = new QTableView(this);
+    outputTable->setModel(outputTableModel);
     outputTable->verticalHeader()->hide();
+    outputTable->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
+    outputTable->verticalHeader()->setDefaultSectionSize(ROW_HEIGHT);
     outputTable->horizontalHeader()->setSectionsClickable(false);
     outputTable->horizontalHeader()->setMinimumSectionSize(100);
     outputTable->setGridStyle(Qt::NoPen);
     outputTable->setHorizontalScrollMode(QTableView::ScrollMode::ScrollPerPixel);
     outputTable->setVerticalScrollMode(QTableView::ScrollMode::ScrollPerPixel);
-    outputTable->setSelectionMode(QTableWidget::SelectionMode::NoSelection);
+    outputTable->setSelectionMode(QTableView::SelectionMode::NoSelection);
+    outputTable->setEditTriggers(QTableView::NoEditTriggers);
     outputTable->setFocusPolicy(Qt::FocusPolicy::NoFocus);
-    outputTable->setColumnCount(8);
 
-    int col = 0;
-    outputTable->setHorizontalHeaderItem(col++, new QTableWidgetItem(QTStr("FilterName")));
-    outputTable->setHorizontalHeaderItem(col++, new QTableWidgetItem(QTStr("SourceName")));
-    outputTable->setHorizontalHeaderItem(col++, new QTableWidgetItem(QTStr("Output")));
-    outputTable->setHorizontalHeaderItem(col++, new QTableWidgetItem(QTStr("Status")));
-    outputTable->setHorizontalHeaderItem(col++, new QTableWidgetItem(QTStr("DropFrames")));
-    outputTable->setHorizontalHeaderItem(col++, new QTableWidgetItem(QTStr("SentDataSize")));
-    outputTable->setHorizontalHeaderItem(col++, new QTableWidgetItem(QTStr("BitRate")));
-    outputTable->setHorizontalHeaderItem(col++, new QTableWidgetItem(QString::fromUtf8("")));
+    auto actionButtonDelegate = new ActionButtonDelegate(this);
+    outputTable->setItemDelegateForColumn(OutputTableModel::COLUMN_ACTION, actionButtonDelegate);
+    connect(actionButtonDelegate, &ActionButtonDelegate::clicked, [this](const QModelIndex &index) {
+        outputTableModel->triggerAction(index.row());
+    });
+    connect(outputTable, &QTableView::clicked, [this](const QModelIndex &index) {
+        if (index.column() == OutputTableModel::COLUMN_SOURCE_NAME) {
+            outputTableModel->openSourceFilters(index.row());
+        }
+    });
+
+    // Newly scrolled rows shouldn't wait for next tick
+    connect(outputTable->verticalScrollBar(), &QScrollBar::valueChanged, [this](int) { update(); });
 
     QObject::connect(&timer, &QTimer::timeout, this, &BranchOutputStatusDock::update);
 
@@ -92,16 +111,65 @@ BranchOutputStatusDock::BranchOutputStatusDock(QWidget *parent) : QFrame(parent)
     interlockComboBox->addItem(QTStr("StreamingOrRecording"), BranchOutputFilter::INTERLOCK_TYPE_STREAMING_RECORDING);
     interlockComboBox->addItem(QTStr("VirtualCam"), BranchOutputFilter::INTERLOCK_TYPE_VIRTUAL_CAM);
 
+    // Output start scheduler controls
+    concurrentStartsLabel = new QLabel(QTStr("ConcurrentStarts"), this);
+    concurrentStartsSpinBox = new QSpinBox(this);
+    concurrentStartsSpinBox->setRange(1, 16);
+    concurrentStartsSpinBox->setValue(DEFAULT_MAX_CONCURRENT_STARTS);
+
+    startIntervalLabel = new QLabel(QTStr("StartInterval"), this);
+    startIntervalSpinBox = new QSpinBox(this);
+    startIntervalSpinBox->setRange(0, 10000);
+    startIntervalSpinBox->setSingleStep(100);
+    startIntervalSpinBox->setSuffix(" ms");
+    startIntervalSpinBox->setValue(DEFAULT_START_INTERVAL_MS);
+
+    // Hardware encoder budget controls
+    hardwareSessionsLabel = new QLabel(QTStr("HardwareEncoderSessions"), this);
+    hardwareSessionsSpinBox = new QSpinBox(this);
+    hardwareSessionsSpinBox->setRange(0, 32);
+    hardwareSessionsSpinBox->setSpecialValueText(QTStr("Unlimited"));
+    hardwareSessionsSpinBox->setToolTip(QTStr("HardwareEncoderSessions.Description"));
+
+    fallbackEncoderLabel = new QLabel(QTStr("FallbackEncoder"), this);
+    fallbackEncoderComboBox = new QComboBox(this);
+    fallbackEncoderComboBox->addItem(QTStr("None"), "");
+    addFallbackEncoderItems(fallbackEncoderComboBox);
+
+    // Metrics exporter controls
+    metricsPortLabel = new QLabel(QTStr("MetricsPort"), this);
+    metricsPortSpinBox = new QSpinBox(this);
+    metricsPortSpinBox->setRange(0, 65535);
+    metricsPortSpinBox->setSpecialValueText(QTStr("Disabled"));
+    metricsPortSpinBox->setToolTip(QTStr("MetricsPort.Description"));
+    metricsRemoteCheckBox = new QCheckBox(QTStr("MetricsRemote"), this);
+    metricsRemoteCheckBox->setToolTip(QTStr("MetricsRemote.Description"));
+
     auto buttonsContainerLayout = new QHBoxLayout();
     buttonsContainerLayout->addWidget(enableAllButton);
     buttonsContainerLayout->addWidget(disableAllButton);
     buttonsContainerLayout->addStretch();
+    buttonsContainerLayout->addWidget(concurrentStartsLabel);
+    buttonsContainerLayout->addWidget(concurrentStartsSpinBox);
+    buttonsContainerLayout->addWidget(startIntervalLabel);
+    buttonsContainerLayout->addWidget(startIntervalSpinBox);
     buttonsContainerLayout->addWidget(interlockLabel);
     buttonsContainerLayout->addWidget(interlockComboBox);
 
+    auto encodersContainerLayout = new QHBoxLayout();
+    encodersContainerLayout->addStretch();
+    encodersContainerLayout->addWidget(hardwareSessionsLabel);
+    encodersContainerLayout->addWidget(hardwareSessionsSpinBox);
+    encodersContainerLayout->addWidget(fallbackEncoderLabel);
+    encodersContainerLayout->addWidget(fallbackEncoderComboBox);
+    encodersContainerLayout->addWidget(metricsPortLabel);
+    encodersContainerLayout->addWidget(metricsPortSpinBox);
+    encodersContainerLayout->addWidget(metricsRemoteCheckBox);
+
     auto *outputContainerLayout = new QVBoxLayout();
     outputContainerLayout->addWidget(outputTable);
     outputContainerLayout->addLayout(buttonsContainerLayout);
+    outputContainerLayout->addLayout(encodersContainerLayout);
     this->setLayout(outputContainerLayout);
 
     // Register hotkeys
@@ -115,6 +183,52 @@ BranchOutputStatusDock::BranchOutputStatusDock(QWidget *parent) : QFrame(parent)
     loadSettings();
     loadHotkey(enableAllHotkey, "EnableAllBranchOutputsHotkey");
     loadHotkey(disableAllHotkey, "DisableAllBranchOutputsHotkey");
+#ifdef ENABLE_TRACING
+    dumpTraceHotkey = obs_hotkey_register_frontend(
+        "DumpBranchOutputTraceHotkey", obs_module_text("DumpTraceHotkey"), onDumpTraceHotkeyPressed, this
+    );
+    loadHotkey(dumpTraceHotkey, "DumpBranchOutputTraceHotkey");
+#endif
+
+    // Interlock conditions are evaluated immediately instead of waiting for next polling
+    connect(interlockComboBox, &QComboBox::currentIndexChanged, [this](int) { superviseAll(); });
+
+    OutputStartScheduler::getInstance()->setMaxConcurrent(concurrentStartsSpinBox->value());
+    OutputStartScheduler::getInstance()->setIntervalMs(startIntervalSpinBox->value());
+    connect(concurrentStartsSpinBox, &QSpinBox::valueChanged, [](int value) {
+        OutputStartScheduler::getInstance()->setMaxConcurrent(value);
+    });
+    connect(startIntervalSpinBox, &QSpinBox::valueChanged, [](int value) {
+        OutputStartScheduler::getInstance()->setIntervalMs(value);
+    });
+
+    // Budget applies to encoders created from now on
+    VideoEngine::getInstance()->setHardwareSessionLimit(hardwareSessionsSpinBox->value());
+    VideoEngine::getInstance()->setFallbackEncoder(fallbackEncoderComboBox->currentData().toString());
+    connect(hardwareSessionsSpinBox, &QSpinBox::valueChanged, [](int value) {
+        VideoEngine::getInstance()->setHardwareSessionLimit(value);
+    });
+    connect(fallbackEncoderComboBox, &QComboBox::currentIndexChanged, [this](int) {
+        VideoEngine::getInstance()->setFallbackEncoder(fallbackEncoderComboBox->currentData().toString());
+    });
+
+    // Listen only after the value is settled (Avoid binding every port typed)
+    if (MetricsExporter::getInstance()) {
+        MetricsExporter::getInstance()->setRemoteAccess(metricsRemoteCheckBox->isChecked());
+        MetricsExporter::getInstance()->setPort(metricsPortSpinBox->value());
+    }
+    metricsPortSpinBox->setKeyboardTracking(false);
+    connect(metricsPortSpinBox, &QSpinBox::valueChanged, [](int value) {
+        if (MetricsExporter::getInstance()) {
+            MetricsExporter::getInstance()->setPort(value);
+        }
+    });
+    connect(metricsRemoteCheckBox, &QCheckBox::toggled, [](bool checked) {
+        if (MetricsExporter::getInstance()) {
+            MetricsExporter::getInstance()->setRemoteAccess(checked);
+        }
+    });
+    obs_frontend_add_event_callback(onFrontendEvent, this);
 
     obs_log(LOG_DEBUG, "BranchOutputStatusDock created");
 }
@@ -123,13 +237,49 @@ BranchOutputStatusDock::~BranchOutputStatusDock()
 {
     saveSettings();
 
+    obs_frontend_remove_event_callback(onFrontendEvent, this);
+
     // Unregister hotkeys
     obs_hotkey_unregister(enableAllHotkey);
     obs_hotkey_unregister(disableAllHotkey);
+#ifdef ENABLE_TRACING
+    obs_hotkey_unregister(dumpTraceHotkey);
+#endif
 
     obs_log(LOG_DEBUG, "BranchOutputStatusDock destroyed");
 }
 
+// Software video encoders which can substitute hardware ones (x264 is offered with light presets)
+void BranchOutputStatusDock::addFallbackEncoderItems(QComboBox *comboBox)
+{
+    const char *encoderId = nullptr;
+    for (size_t i = 0; obs_enum_encoder_types(i, &encoderId); i++) {
+        if (obs_get_encoder_type(encoderId) != OBS_ENCODER_VIDEO) {
+            continue;
+        }
+
+        auto caps = obs_get_encoder_caps(encoderId);
+        if (caps & (OBS_ENCODER_CAP_DEPRECATED | OBS_ENCODER_CAP_INTERNAL)) {
+            continue;
+        }
+
+        if (!VideoEngine::getHardwareFamily(encoderId).isEmpty()) {
+            continue;
+        }
+
+        QString displayName = obs_encoder_get_display_name(encoderId);
+        if (!strcmp(encoderId, "obs_x264")) {
+            for (auto preset : {"veryfast", "superfast", "ultrafast"}) {
+                comboBox->addItem(
+                    QString("%1 (%2)").arg(displayName).arg(preset), QString("%1:%2").arg(encoderId).arg(preset)
+                );
+            }
+        } else {
+            comboBox->addItem(displayName, QString(encoderId));
+        }
+    }
+}
+
 void BranchOutputStatusDock::loadSettings()
 {
     OBSString path = obs_module_get_config_path(obs_current_module(), SETTINGS_JSON_NAME);
@@ -155,6 +305,21 @@ void BranchOutputStatusDock::loadSettings()
     loadColumn(col++, "bitRate");
 
     interlockComboBox->setCurrentIndex(interlockComboBox->findData(obs_data_get_int(settings, "interlock")));
+
+    if (obs_data_has_user_value(settings, "start_concurrency")) {
+        concurrentStartsSpinBox->setValue((int)obs_data_get_int(settings, "start_concurrency"));
+    }
+    if (obs_data_has_user_value(settings, "start_interval_ms")) {
+        startIntervalSpinBox->setValue((int)obs_data_get_int(settings, "start_interval_ms"));
+    }
+    hardwareSessionsSpinBox->setValue((int)obs_data_get_int(settings, "hw_encoder_sessions"));
+    auto fallbackEncoderIndex =
+        fallbackEncoderComboBox->findData(QString(obs_data_get_string(settings, "fallback_encoder")));
+    if (fallbackEncoderIndex >= 0) {
+        fallbackEncoderComboBox->setCurrentIndex(fallbackEncoderIndex);
+    }
+    metricsPortSpinBox->setValue((int)obs_data_get_int(settings, "metrics_port"));
+    metricsRemoteCheckBox->setChecked(obs_data_get_bool(settings, "metrics_remote"));
 }
 
 void BranchOutputStatusDock::saveSettings()
@@ -175,6 +340,14 @@ void BranchOutputStatusDock::saveSettings()
     saveColumn(col++, "bitRate");
 
     obs_data_set_int(settings, "interlock", interlockComboBox->currentData().toInt());
+    obs_data_set_int(settings, "start_concurrency", concurrentStartsSpinBox->value());
+    obs_data_set_int(settings, "start_interval_ms", startIntervalSpinBox->value());
+    obs_data_set_int(settings, "hw_encoder_sessions", hardwareSessionsSpinBox->value());
+    obs_data_set_string(
+        settings, "fallback_encoder", qUtf8Printable(fallbackEncoderComboBox->currentData().toString())
+    );
+    obs_data_set_int(settings, "metrics_port", metricsPortSpinBox->value());
+    obs_data_set_bool(settings, "metrics_remote", metricsRemoteCheckBox->isChecked());
 
     OBSString config_dir_path = obs_module_get_config_path(obs_current_module(), "");
     os_mkdirs(config_dir_path);
@@ -183,110 +356,65 @@ void BranchOutputStatusDock::saveSettings()
     obs_data_save_json_safe(settings, path, "tmp", "bak");
 }
 
-void BranchOutputStatusDock::addRow(BranchOutputFilter *filter, size_t streamingIndex, bool recording, size_t groupIndex)
+void BranchOutputStatusDock::addFilter(BranchOutputFilter *filter)
 {
-    auto parent = obs_filter_get_parent(filter->filterSource);
-    auto row = (int)outputTableRows.size();
-
-    auto otr = new OutputTableRow(this);
-
-    otr->filter = filter;
-    otr->filterCell = new FilterCell(filter->name, filter->filterSource, this);
-    otr->parentCell = new ParentCell(obs_source_get_name(parent), parent, this);
-    otr->outputName = new QLabel(recording ? QTStr("Recording") : QTStr("Streaming%1").arg(streamingIndex + 1), this);
-    otr->status = new StatusCell(QTStr("Status.Inactive"), this);
-    if (recording) {
-        otr->status->setIcon(QPixmap(":/branch-output/images/recording.svg").scaled(16, 16));
-    } else {
-        otr->status->setIcon(QPixmap(":/branch-output/images/streaming.svg").scaled(16, 16));
-    }
-    otr->streamingIndex = streamingIndex;
-    otr->recording = recording;
-    otr->groupIndex = groupIndex;
-    otr->droppedFrames = new QLabel("", this);
-    otr->megabytesSent = new QLabel("", this);
-    otr->bitrate = new QLabel("", this);
-
-    auto col = 0;
-    outputTable->setRowCount(row + 1);
-    outputTable->setCellWidget(row, col++, otr->filterCell);
-    outputTable->setCellWidget(row, col++, otr->parentCell);
-    outputTable->setCellWidget(row, col++, otr->outputName);
-    outputTable->setCellWidget(row, col++, otr->status);
-    outputTable->setCellWidget(row, col++, otr->droppedFrames);
-    outputTable->setCellWidget(row, col++, otr->megabytesSent);
-    outputTable->setCellWidget(row, col++, otr->bitrate);
-
-    outputTable->setRowHeight(row, 32);
-
-    // Setup reset button
-    auto resetButtonContainer = new QWidget(this);
-    auto resetButtonContainerLayout = new QHBoxLayout();
-    resetButtonContainerLayout->setContentsMargins(0, 0, 0, 0);
-    resetButtonContainer->setLayout(resetButtonContainerLayout);
-
-    auto resetButton = new QPushButton(QTStr("Reset"), this);
-    connect(resetButton, &QPushButton::clicked, [this, row]() { outputTableRows[row]->reset(); });
-    resetButton->setProperty("toolButton", true);  // Until OBS 30
-    resetButton->setProperty("class", "btn-tool"); // Since OBS 31
-    resetButton->setSizePolicy(QSizePolicy::MinimumExpanding, QSizePolicy::MinimumExpanding);
-
-    resetButtonContainerLayout->addWidget(resetButton);
-    outputTable->setCellWidget(row, col, resetButtonContainer);
-
-    outputTableRows.push_back(otr);
+    outputTableModel->addFilter(filter);
+    update();
 }
 
-void BranchOutputStatusDock::addFilter(BranchOutputFilter *filter)
+void BranchOutputStatusDock::removeFilter(BranchOutputFilter *filter)
 {
-    // Ensure filter removed
-    removeFilter(filter);
-
-    OBSDataAutoRelease settings = obs_source_get_settings(filter->filterSource);
-
-    auto groupIndex = 0;
+    outputTableModel->removeFilter(filter);
+}
 
-    // Recording row
-    if (filter->isRecordingEnabled(settings)) {
-        addRow(filter, 0, true, groupIndex++);
+void BranchOutputStatusDock::update()
+{
+    // Remove filters that no longer exist in the frontend
+    foreach (auto filter, outputTableModel->getFilters()) {
+        if (!sourceInFrontend(obs_filter_get_parent(filter->filterSource))) {
+            outputTableModel->removeFilter(filter);
+        }
     }
 
-    // Streaming rows
-    auto serviceCount = (size_t)obs_data_get_int(settings, "service_count");
-    for (size_t i = 0; i < MAX_SERVICES && i < serviceCount; i++) {
-        if (filter->isStreamingEnabled(settings, i)) {
-            addRow(filter, i, false, groupIndex++);
-        }
+    if (!isVisible() || !outputTableModel->rowCount()) {
+        return;
     }
+
+    // Only visible rows are sampled
+    auto first = outputTable->rowAt(0);
+    auto last = outputTable->rowAt(outputTable->viewport()->height() - 1);
+    outputTableModel->refresh(first < 0 ? 0 : first, last < 0 ? outputTableModel->rowCount() - 1 : last);
 }
 
-void BranchOutputStatusDock::removeFilter(BranchOutputFilter *filter)
+void BranchOutputStatusDock::superviseAll()
 {
-    // DO NOT access filter resources at this time (It may be already deleted)
-    foreach (auto row, outputTableRows) {
-        if (row->filter == filter) {
-            outputTable->removeRow((int)outputTableRows.indexOf(row));
-            outputTableRows.removeOne(row);
-            row->deleteLater();
-        }
+    foreach (auto filter, outputTableModel->getFilters()) {
+        filter->requestSupervise();
     }
 }
 
-void BranchOutputStatusDock::update()
+void BranchOutputStatusDock::onFrontendEvent(enum obs_frontend_event event, void *data)
 {
-    foreach (auto row, outputTableRows) {
-        if (!sourceInFrontend(obs_filter_get_parent(row->filter->filterSource))) {
-            // Remove filter that no longer exists in the frontend
-            removeFilter(row->filter);
-            continue;
-        }
-        row->update();
+    auto dock = static_cast<BranchOutputStatusDock *>(data);
+
+    switch (event) {
+    case OBS_FRONTEND_EVENT_STREAMING_STARTED:
+    case OBS_FRONTEND_EVENT_STREAMING_STOPPED:
+    case OBS_FRONTEND_EVENT_RECORDING_STARTED:
+    case OBS_FRONTEND_EVENT_RECORDING_STOPPED:
+    case OBS_FRONTEND_EVENT_VIRTUALCAM_STARTED:
+    case OBS_FRONTEND_EVENT_VIRTUALCAM_STOPPED:
+        dock->superviseAll();
+        break;
+    default:
+        break;
     }
 }
 
 void BranchOutputStatusDock::showEvent(QShowEvent *)
 {
     timer.start(TIMER_INTERVAL);
+    update();
 }
 
 void BranchOutputStatusDock::hideEvent(QHideEvent *)
@@ -296,11 +424,8 @@ void BranchOutputStatusDock::hideEvent(QHideEvent *)
 
 void BranchOutputStatusDock::setEabnleAll(bool enabled)
 {
-    foreach (auto row, outputTableRows) {
-        if (row->groupIndex == 0) {
-            // Do only once for each filters
-            obs_source_set_enabled(row->filter->filterSource, enabled);
-        }
+    foreach (auto filter, outputTableModel->getFilters()) {
+        obs_source_set_enabled(filter->filterSource, enabled);
     }
 }
 
@@ -320,59 +445,384 @@ void BranchOutputStatusDock::onDisableAllHotkeyPressed(void *data, obs_hotkey_id
     }
 }
 
-//--- OutputTableRow class ---//
+#ifdef ENABLE_TRACING
+void BranchOutputStatusDock::onDumpTraceHotkeyPressed(void *, obs_hotkey_id, obs_hotkey *, bool pressed)
+{
+    if (!pressed) {
+        return;
+    }
 
-OutputTableRow::OutputTableRow(QObject *parent) : QObject(parent) {}
+    Tracer::logHistograms();
 
-OutputTableRow::~OutputTableRow() {}
+    OBSString config_dir_path = obs_module_get_config_path(obs_current_module(), "");
+    os_mkdirs(config_dir_path);
 
-// Imitate UI/window-basic-stats.cpp
-void OutputTableRow::update()
+    OBSString path = obs_module_get_config_path(obs_current_module(), TRACE_JSON_NAME);
+    Tracer::writeChromeTrace(path);
+}
+#endif
+
+//--- OutputTableModel class ---//
+
+OutputTableModel::OutputTableModel(QObject *parent)
+    : QAbstractTableModel(parent),
+      streamingIcon(QPixmap(":/branch-output/images/streaming.svg").scaled(16, 16)),
+      recordingIcon(QPixmap(":/branch-output/images/recording.svg").scaled(16, 16))
 {
-    auto output = recording                       ? filter->recordingOutput.Get()
-                  : streamingIndex < MAX_SERVICES ? filter->streamings[streamingIndex].output.Get()
-                                                  : nullptr;
-    uint64_t totalBytes = output ? obs_output_get_total_bytes(output) : 0;
-    uint64_t curTime = os_gettime_ns();
-    uint64_t bytesSent = totalBytes;
+}
 
-    if (bytesSent < lastBytesSent) {
-        bytesSent = 0;
+OutputTableModel::~OutputTableModel() {}
+
+int OutputTableModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : (int)rows.size();
+}
+
+int OutputTableModel::columnCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : COLUMN_COUNT;
+}
+
+QVariant OutputTableModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (orientation != Qt::Horizontal || role != Qt::DisplayRole) {
+        return QVariant();
     }
-    if (bytesSent == 0) {
-        lastBytesSent = 0;
+
+    switch (section) {
+    case COLUMN_FILTER_NAME:
+        return QTStr("FilterName");
+    case COLUMN_SOURCE_NAME:
+        return QTStr("SourceName");
+    case COLUMN_OUTPUT:
+        return QTStr("Output");
+    case COLUMN_STATUS:
+        return QTStr("Status");
+    case COLUMN_DROP_FRAMES:
+        return QTStr("DropFrames");
+    case COLUMN_SENT_DATA_SIZE:
+        return QTStr("SentDataSize");
+    case COLUMN_BIT_RATE:
+        return QTStr("BitRate");
+    default:
+        return QString();
     }
+}
 
-    uint64_t bitsBetween = (bytesSent - lastBytesSent) * 8;
-    long double timePassed = (long double)(curTime - lastBytesSentTime) / 1000000000.0l;
-    kbps = (long double)bitsBetween / timePassed / 1000.0l;
+QVariant OutputTableModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() >= rows.size()) {
+        return QVariant();
+    }
 
-    if (timePassed < 0.01l) {
-        kbps = 0.0l;
+    auto &row = rows[index.row()];
+    auto &display = row.display;
+
+    auto themeColor = [](Theme theme) -> QVariant {
+        switch (theme) {
+        case THEME_GOOD:
+            return QColor(0x4c, 0xaf, 0x50);
+        case THEME_WARNING:
+            return QColor(0xe6, 0xa2, 0x3c);
+        case THEME_ERROR:
+            return QColor(0xe0, 0x4b, 0x4b);
+        default:
+            return QVariant();
+        }
+    };
+
+    switch (role) {
+    case Qt::DisplayRole:
+        switch (index.column()) {
+        case COLUMN_FILTER_NAME:
+            return display.filterName;
+        case COLUMN_SOURCE_NAME:
+            return display.sourceName;
+        case COLUMN_OUTPUT:
+            return row.outputName;
+        case COLUMN_STATUS:
+            return display.status;
+        case COLUMN_DROP_FRAMES:
+            return display.dropFrames;
+        case COLUMN_SENT_DATA_SIZE:
+            return display.sentDataSize;
+        case COLUMN_BIT_RATE:
+            return display.bitRate;
+        case COLUMN_ACTION:
+            // Replay buffer row has "Save" instead (Nothing to reset)
+            return row.replayBuffer ? QTStr("SaveReplay") : QTStr("Reset");
+        }
+        break;
+
+    case Qt::CheckStateRole:
+        if (index.column() == COLUMN_FILTER_NAME) {
+            return display.enabled ? Qt::Checked : Qt::Unchecked;
+        }
+        break;
+
+    case Qt::DecorationRole:
+        if (index.column() == COLUMN_STATUS && display.statusIcon) {
+            return row.recording || row.replayBuffer ? recordingIcon : streamingIcon;
+        }
+        break;
+
+    case Qt::ForegroundRole:
+        if (index.column() == COLUMN_STATUS) {
+            return themeColor(display.statusTheme);
+        } else if (index.column() == COLUMN_DROP_FRAMES) {
+            return themeColor(display.dropFramesTheme);
+        }
+        break;
+
+    case Qt::FontRole:
+        if (index.column() == COLUMN_SOURCE_NAME) {
+            // Looks like a link (Click to open filters of the source)
+            QFont font;
+            font.setUnderline(true);
+            return font;
+        }
+        break;
+    }
+
+    return QVariant();
+}
+
+Qt::ItemFlags OutputTableModel::flags(const QModelIndex &index) const
+{
+    auto itemFlags = QAbstractTableModel::flags(index);
+    if (index.column() == COLUMN_FILTER_NAME) {
+        itemFlags |= Qt::ItemIsUserCheckable;
+    }
+    return itemFlags;
+}
+
+bool OutputTableModel::setData(const QModelIndex &index, const QVariant &value, int role)
+{
+    if (!index.isValid() || index.row() >= rows.size() || index.column() != COLUMN_FILTER_NAME ||
+        role != Qt::CheckStateRole) {
+        return false;
+    }
+
+    // Every row of the filter follows on next refresh
+    auto enabled = value.toInt() == Qt::Checked;
+    obs_source_set_enabled(rows[index.row()].filter->filterSource, enabled);
+
+    auto display = rows[index.row()].display;
+    display.enabled = enabled;
+    setDisplay(index.row(), display);
+    return true;
+}
+
+void OutputTableModel::addRow(
+    BranchOutputFilter *filter, size_t streamingIndex, bool recording, size_t groupIndex, bool replayBuffer
+)
+{
+    Row row = {};
+    row.filter = filter;
+    row.recording = recording;
+    row.replayBuffer = replayBuffer;
+    row.streamingIndex = streamingIndex;
+    row.groupIndex = groupIndex;
+    row.outputName = replayBuffer ? QTStr("ReplayBuffer")
+                     : recording  ? QTStr("Recording")
+                                  : QTStr("Streaming%1").arg(streamingIndex + 1);
+    row.outputKey = replayBuffer ? QString("replay_buffer")
+                    : recording  ? QString("recording")
+                                 : QString("streaming_%1").arg(streamingIndex + 1);
+
+    auto parent = obs_filter_get_parent(filter->filterSource);
+    row.display.filterName = filter->name;
+    row.display.enabled = obs_source_enabled(filter->filterSource);
+    row.display.sourceName = parent ? obs_source_get_name(parent) : "";
+    row.display.status = QTStr("Status.Inactive");
+
+    rows.append(row);
+}
+
+void OutputTableModel::addFilter(BranchOutputFilter *filter)
+{
+    // Ensure filter removed
+    removeFilter(filter);
+
+    OBSDataAutoRelease settings = obs_source_get_settings(filter->filterSource);
+    auto config = filter->getParsedSettings(settings);
+
+    auto count = (config->streamRecording ? 1 : 0) + (config->replayBuffer ? 1 : 0);
+    for (size_t i = 0; i < (size_t)config->services.size(); i++) {
+        count += config->services[i].isEnabled() ? 1 : 0;
+    }
+    if (!count) {
+        return;
+    }
+
+    beginInsertRows(QModelIndex(), (int)rows.size(), (int)rows.size() + count - 1);
+
+    auto groupIndex = 0;
+
+    // Recording row
+    if (config->streamRecording) {
+        addRow(filter, 0, true, groupIndex++);
+    }
+
+    // Replay buffer row
+    if (config->replayBuffer) {
+        addRow(filter, 0, false, groupIndex++, true);
+    }
+
+    // Streaming rows
+    for (size_t i = 0; i < (size_t)config->services.size(); i++) {
+        if (config->services[i].isEnabled()) {
+            addRow(filter, i, false, groupIndex++);
+        }
+    }
+
+    endInsertRows();
+}
+
+void OutputTableModel::removeFilter(BranchOutputFilter *filter)
+{
+    // DO NOT access filter resources at this time (It may be already deleted)
+    int first = -1;
+    for (int i = 0; i < rows.size(); i++) {
+        if (rows[i].filter == filter) {
+            first = i;
+            break;
+        }
+    }
+    if (first < 0) {
+        return;
+    }
+
+    // Rows of a filter are contiguous
+    auto last = first;
+    while (last + 1 < rows.size() && rows[last + 1].filter == filter) {
+        last++;
+    }
+
+    beginRemoveRows(QModelIndex(), first, last);
+    rows.erase(rows.begin() + first, rows.begin() + last + 1);
+    endRemoveRows();
+}
+
+QList<BranchOutputFilter *> OutputTableModel::getFilters() const
+{
+    QList<BranchOutputFilter *> filters;
+    foreach (auto &row, rows) {
+        if (row.groupIndex == 0) {
+            // First row of each filter
+            filters.append(row.filter);
+        }
+    }
+    return filters;
+}
+
+void OutputTableModel::refresh(int first, int last)
+{
+    // Take one snapshot per filter
+    BranchOutputFilter *sampledFilter = nullptr;
+    MetricsExporter::FilterMetrics metrics;
+    auto sampled = false;
+    auto now = os_gettime_ns();
+
+    for (int i = first; i <= last && i < rows.size(); i++) {
+        if (rows[i].lastBytesSentTime && now - rows[i].lastBytesSentTime < ROW_REFRESH_MIN_INTERVAL_NS) {
+            // Bitrate needs some interval
+            continue;
+        }
+        if (rows[i].filter != sampledFilter) {
+            sampledFilter = rows[i].filter;
+            sampled = MetricsExporter::sampleFilter(sampledFilter, &metrics);
+        }
+        updateRow(i, sampled ? &metrics : nullptr);
+    }
+}
+
+// Imitate UI/window-basic-stats.cpp
+void OutputTableModel::updateRow(int index, const MetricsExporter::FilterMetrics *metrics)
+{
+    auto &row = rows[index];
+    auto filter = row.filter;
+    auto display = row.display;
+
+    auto parent = obs_filter_get_parent(filter->filterSource);
+    display.filterName = filter->name;
+    display.enabled = obs_source_enabled(filter->filterSource);
+    display.sourceName = parent ? obs_source_get_name(parent) : "";
+
+    if (!metrics) {
+        // Outputs are being replaced by worker thread (Statistics stay as they were)
+        if (filter->starting) {
+            display.status = QTStr("Status.Starting");
+            display.statusTheme = THEME_WARNING;
+            display.statusIcon = false;
+        }
+        setDisplay(index, display);
+        return;
+    }
+
+    const MetricsExporter::OutputMetrics *output = nullptr;
+    for (int i = 0; i < metrics->outputs.size(); i++) {
+        if (metrics->outputs[i].output == row.outputKey) {
+            output = &metrics->outputs[i];
+            break;
+        }
     }
 
     // Status display
-    if (output) {
-        bool reconnecting = !recording && output ? !obs_output_active(output) || obs_output_reconnecting(output)
-                                                 : false;
+    if (filter->standby) {
+        display.status = QTStr("Status.Standby");
+        display.statusTheme = THEME_NONE;
+        display.statusIcon = false;
+    } else if (output) {
+        bool reconnecting = !row.recording && !row.replayBuffer ? !output->active || output->reconnecting : false;
 
         if (reconnecting) {
-            status->setText(QTStr("Status.Reconnecting"));
-            status->setTheme("error", "text-danger");
-            status->setIconShow(false);
+            display.status = QTStr("Status.Reconnecting");
+            display.statusTheme = THEME_ERROR;
+            display.statusIcon = false;
         } else {
-            if (recording) {
-                status->setText(QTStr("Status.Recording"));
+            auto statusText = row.replayBuffer ? QTStr("Status.Buffering")
+                              : row.recording  ? QTStr("Status.Recording")
+                                               : QTStr("Status.Live");
+            if (filter->isVideoEncoderFallback(row.streamingIndex, row.recording || row.replayBuffer)) {
+                // Hardware encoder sessions were exhausted
+                display.status = QTStr("Status.Fallback").arg(statusText);
+                display.statusTheme = THEME_WARNING;
             } else {
-                status->setText(QTStr("Status.Live"));
+                display.status = statusText;
+                display.statusTheme = THEME_GOOD;
             }
-            status->setTheme("good", "text-success");
-            status->setIconShow(true);
+            display.statusIcon = true;
         }
     } else {
-        status->setText(QTStr("Status.Inactive"));
-        status->setTheme("", "");
-        status->setIconShow(false);
+        display.status = QTStr("Status.Inactive");
+        display.statusTheme = THEME_NONE;
+        display.statusIcon = false;
+    }
+
+    updateStatistics(row, output, display);
+    setDisplay(index, display);
+}
+
+void OutputTableModel::updateStatistics(Row &row, const MetricsExporter::OutputMetrics *output, RowDisplay &display)
+{
+    uint64_t totalBytes = output ? output->totalBytes : 0;
+    uint64_t curTime = os_gettime_ns();
+    uint64_t bytesSent = totalBytes;
+
+    if (bytesSent < row.lastBytesSent) {
+        bytesSent = 0;
+    }
+    if (bytesSent == 0) {
+        row.lastBytesSent = 0;
+    }
+
+    uint64_t bitsBetween = (bytesSent - row.lastBytesSent) * 8;
+    long double timePassed = (long double)(curTime - row.lastBytesSentTime) / 1000000000.0l;
+    long double kbps = (long double)bitsBetween / timePassed / 1000.0l;
+
+    if (timePassed < 0.01l) {
+        kbps = 0.0l;
     }
 
     long double num = (long double)totalBytes / (1024.0l * 1024.0l);
@@ -381,7 +831,7 @@ void OutputTableRow::update()
         num /= 1024;
         unit = "GiB";
     }
-    megabytesSent->setText(QString("%1 %2").arg((double)num, 0, 'f', 1).arg(unit));
+    display.sentDataSize = QString("%1 %2").arg((double)num, 0, 'f', 1).arg(unit);
 
     num = kbps;
     unit = "kb/s";
@@ -389,161 +839,133 @@ void OutputTableRow::update()
         num /= 1000;
         unit = "Mb/s";
     }
-    bitrate->setText(QString("%1 %2").arg((double)num, 0, 'f', 0).arg(unit));
+    display.bitRate = QString("%1 %2").arg((double)num, 0, 'f', 0).arg(unit);
 
     // Calculate statistics
-    int total = output ? obs_output_get_total_frames(output) : 0;
-    int dropped = output ? obs_output_get_frames_dropped(output) : 0;
-
-    if (total < first_total || dropped < first_dropped) {
-        first_total = 0;
-        first_dropped = 0;
+    int total = output ? output->totalFrames : 0;
+    int dropped = output ? output->droppedFrames : 0;
+    row.lastTotal = total;
+    row.lastDropped = dropped;
+
+    if (total < row.firstTotal || dropped < row.firstDropped) {
+        row.firstTotal = 0;
+        row.firstDropped = 0;
     }
 
-    total -= first_total;
-    dropped -= first_dropped;
+    total -= row.firstTotal;
+    dropped -= row.firstDropped;
 
     num = total ? (long double)dropped / (long double)total * 100.0l : 0.0l;
 
-    QString dropFramesStr =
+    display.dropFrames =
         QString("%1 / %2 (%3%)")
             .arg(QString::number(dropped), QString::number(total), QString::number((double)num, 'f', 1));
-    droppedFrames->setText(dropFramesStr);
 
     if (num > 5.0l) {
-        setThemeID(droppedFrames, "error", "text-danger");
+        display.dropFramesTheme = THEME_ERROR;
     } else if (num > 1.0l) {
-        setThemeID(droppedFrames, "warning", "text-warning");
+        display.dropFramesTheme = THEME_WARNING;
     } else {
-        setThemeID(droppedFrames, "", "");
+        display.dropFramesTheme = THEME_NONE;
     }
 
-    lastBytesSent = bytesSent;
-    lastBytesSentTime = curTime;
+    row.lastBytesSent = bytesSent;
+    row.lastBytesSentTime = curTime;
 }
 
-void OutputTableRow::reset()
+// Notify changed cells only
+void OutputTableModel::setDisplay(int index, const RowDisplay &display)
 {
-    auto output = recording                       ? filter->recordingOutput.Get()
-                  : streamingIndex < MAX_SERVICES ? filter->streamings[streamingIndex].output.Get()
-                                                  : nullptr;
-    if (!output) {
-        return;
-    }
+    auto &current = rows[index].display;
+
+    int first = COLUMN_COUNT;
+    int last = -1;
+    auto changed = [&](bool differs, int column) {
+        if (differs) {
+            first = qMin(first, column);
+            last = qMax(last, column);
+        }
+    };
+    changed(current.filterName != display.filterName || current.enabled != display.enabled, COLUMN_FILTER_NAME);
+    changed(current.sourceName != display.sourceName, COLUMN_SOURCE_NAME);
+    changed(
+        current.status != display.status || current.statusTheme != display.statusTheme ||
+            current.statusIcon != display.statusIcon,
+        COLUMN_STATUS
+    );
+    changed(
+        current.dropFrames != display.dropFrames || current.dropFramesTheme != display.dropFramesTheme,
+        COLUMN_DROP_FRAMES
+    );
+    changed(current.sentDataSize != display.sentDataSize, COLUMN_SENT_DATA_SIZE);
+    changed(current.bitRate != display.bitRate, COLUMN_BIT_RATE);
 
-    first_total = obs_output_get_total_frames(output);
-    first_dropped = obs_output_get_frames_dropped(output);
-    droppedFrames->setText(QString("0 / 0 (0)"));
-    megabytesSent->setText(QString("0 MiB"));
-    bitrate->setText(QString("0 kb/s"));
+    current = display;
+    if (last >= 0) {
+        emit dataChanged(this->index(index, first), this->index(index, last));
+    }
 }
 
-//--- FilterCell class ---//
-
-FilterCell::FilterCell(const QString &text, obs_source_t *source, QWidget *parent) : QWidget(parent)
+void OutputTableModel::triggerAction(int index)
 {
-    setMinimumHeight(27);
-
-    visibilityCheckbox = new QCheckBox(this);
-    visibilityCheckbox->setProperty("visibilityCheckBox", true);      // Until OBS 30
-    visibilityCheckbox->setProperty("class", "indicator-visibility"); // Since OBS 31
-    visibilityCheckbox->setSizePolicy(QSizePolicy::Maximum, QSizePolicy::Maximum);
-    visibilityCheckbox->setChecked(obs_source_enabled(source));
-    visibilityCheckbox->setCursor(Qt::PointingHandCursor);
-
-    connect(visibilityCheckbox, &QCheckBox::clicked, [source](bool visible) {
-        obs_source_set_enabled(source, visible);
-    });
-
-    name = new QLabel(text, this);
-
-    auto checkboxLayout = new QHBoxLayout();
-    checkboxLayout->setContentsMargins(0, 0, 0, 0);
-    checkboxLayout->addWidget(visibilityCheckbox);
-    checkboxLayout->addWidget(name);
-    setLayout(checkboxLayout);
-
-    // Listen signal for filter update
-    filterRenamedSignal.Connect(obs_source_get_signal_handler(source), "rename", FilterCell::onFilterRenamed, this);
-
-    // Listen signal for filter enabled/disabled
-    enableSignal.Connect(obs_source_get_signal_handler(source), "enable", FilterCell::onVisibilityChanged, this);
-}
+    if (index < 0 || index >= rows.size()) {
+        return;
+    }
 
-FilterCell::~FilterCell()
-{
-    filterRenamedSignal.Disconnect();
-    enableSignal.Disconnect();
-}
+    auto &row = rows[index];
+    if (row.replayBuffer) {
+        row.filter->saveReplayBuffer();
+        return;
+    }
 
-void FilterCell::setText(const QString &text)
-{
-    name->setText(text);
-}
+    // Count from last sampled values
+    row.firstTotal = row.lastTotal;
+    row.firstDropped = row.lastDropped;
 
-void FilterCell::onFilterRenamed(void *data, calldata_t *cd)
-{
-    auto item = static_cast<FilterCell *>(data);
-    item->setText(calldata_string(cd, "new_name"));
+    auto display = row.display;
+    display.dropFrames = QString("0 / 0 (0)");
+    display.dropFramesTheme = THEME_NONE;
+    display.sentDataSize = QString("0 MiB");
+    display.bitRate = QString("0 kb/s");
+    setDisplay(index, display);
 }
 
-void FilterCell::onVisibilityChanged(void *data, calldata_t *cd)
+void OutputTableModel::openSourceFilters(int index)
 {
-    auto item = static_cast<FilterCell *>(data);
-    auto enabled = calldata_bool(cd, "enabled");
-    item->visibilityCheckbox->setChecked(enabled);
-}
-
-//--- ParentCell class ---//
+    if (index < 0 || index >= rows.size()) {
+        return;
+    }
 
-ParentCell::ParentCell(const QString &text, obs_source_t *_source, QWidget *parent) : QLabel(parent), source(_source)
-{
-    parentRenamedSignal.Connect(obs_source_get_signal_handler(source), "rename", ParentCell::onParentRenamed, this);
-    setTextFormat(Qt::RichText);
-    setCursor(Qt::PointingHandCursor);
-    setSourceName(text);
+    auto parent = obs_filter_get_parent(rows[index].filter->filterSource);
+    if (parent) {
+        obs_log(LOG_DEBUG, "uuid=%s", obs_source_get_uuid(parent));
+        obs_frontend_open_source_filters(parent);
+    }
 }
 
-ParentCell::~ParentCell()
-{
-    parentRenamedSignal.Disconnect();
-}
+//--- ActionButtonDelegate class ---//
 
-void ParentCell::onParentRenamed(void *data, calldata_t *cd)
+void ActionButtonDelegate::paint(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const
 {
-    auto item = static_cast<ParentCell *>(data);
-    auto newName = calldata_string(cd, "new_name");
-    item->setSourceName(newName);
-}
+    QStyleOptionButton button;
+    button.rect = option.rect.adjusted(2, 2, -2, -2);
+    button.text = index.data(Qt::DisplayRole).toString();
+    button.state = QStyle::State_Enabled | (option.state & QStyle::State_MouseOver);
 
-void ParentCell::setSourceName(const QString &text)
-{
-    setText(QString("<u>%1</u>").arg(text));
+    auto style = option.widget ? option.widget->style() : QApplication::style();
+    style->drawControl(QStyle::CE_PushButton, &button, painter, option.widget);
 }
 
-void ParentCell::mousePressEvent(QMouseEvent *event)
+bool ActionButtonDelegate::editorEvent(
+    QEvent *event, QAbstractItemModel *, const QStyleOptionViewItem &option, const QModelIndex &index
+)
 {
-    if (event->button() == Qt::LeftButton) {
-        obs_log(LOG_DEBUG, "uuid=%s", obs_source_get_uuid(source));
-        obs_frontend_open_source_filters(source);
+    if (event->type() == QEvent::MouseButtonRelease) {
+        auto mouseEvent = static_cast<QMouseEvent *>(event);
+        if (mouseEvent->button() == Qt::LeftButton && option.rect.contains(mouseEvent->position().toPoint())) {
+            emit clicked(index);
+            return true;
+        }
     }
+    return false;
 }
-
-//--- StatusCell class ---//
-
-StatusCell::StatusCell(const QString &text, QWidget *parent) : QWidget(parent)
-{
-    icon = new QLabel(this);
-    statusText = new QLabel(text, this);
-
-    icon->setSizePolicy(QSizePolicy::Maximum, QSizePolicy::Maximum);
-    icon->setVisible(false);
-
-    auto layout = new QHBoxLayout();
-    layout->setContentsMargins(0, 0, 0, 0);
-    layout->addWidget(icon);
-    layout->addWidget(statusText);
-    setLayout(layout);
-}
-
-StatusCell::~StatusCell() {}
@@ -21,96 +21,172 @@ with this program. If not, see <https://www.gnu.org/licenses/>
 #include <obs-module.h>
 #include <obs.hpp>
 
+#include <QAbstractTableModel>
 #include <QFrame>
-#include <QPointer>
+#include <QIcon>
 #include <QList>
 #include <QTimer>
-#include <QTableWidgetItem>
 #include <QLabel>
+#include <QCheckBox>
 #include <QComboBox>
+#include <QSpinBox>
+#include <QStyledItemDelegate>
 
+#include "../metrics-exporter.hpp"
 #include "../utils.hpp"
 
-class QTableWidget;
+class QTableView;
 class QString;
-class QCheckBox;
 class QPushButton;
 class BranchOutputFilter;
-class OutputTableRow;
 
-class FilterCell : public QWidget {
+// Rows of status dock (One per output of each filter, rows of a filter are contiguous).
+// Values are cached per row and refreshed on demand for visible rows only, only changed cells are repainted.
+class OutputTableModel : public QAbstractTableModel {
     Q_OBJECT
 
-    QCheckBox *visibilityCheckbox;
-    QLabel *name;
-
-    OBSSignal enableSignal;
-    OBSSignal filterRenamedSignal;
-
-    static void onVisibilityChanged(void *data, calldata_t *cd);
-    static void onFilterRenamed(void *data, calldata_t *cd);
-
 public:
-    explicit FilterCell(const QString &text, obs_source_t *_source, QWidget *parent = (QWidget *)nullptr);
-    ~FilterCell();
-
-    void setText(const QString &text);
-};
-
-class ParentCell : public QLabel {
-    Q_OBJECT
-
-    OBSSignal parentRenamedSignal;
-    obs_source_t *source;
-
-    static void onParentRenamed(void *data, calldata_t *cd);
-
-protected:
-    void mousePressEvent(QMouseEvent *event) override;
+    enum Column {
+        COLUMN_FILTER_NAME,
+        COLUMN_SOURCE_NAME,
+        COLUMN_OUTPUT,
+        COLUMN_STATUS,
+        COLUMN_DROP_FRAMES,
+        COLUMN_SENT_DATA_SIZE,
+        COLUMN_BIT_RATE,
+        COLUMN_ACTION, // "Reset" or "Save" (Replay buffer)
+        COLUMN_COUNT,
+    };
+
+private:
+    enum Theme {
+        THEME_NONE,
+        THEME_GOOD,
+        THEME_WARNING,
+        THEME_ERROR,
+    };
+
+    // Displayed values (Compared with previous ones to find changed cells)
+    struct RowDisplay {
+        QString filterName;
+        bool enabled;
+        QString sourceName;
+        QString status;
+        Theme statusTheme;
+        bool statusIcon;
+        QString dropFrames;
+        Theme dropFramesTheme;
+        QString sentDataSize;
+        QString bitRate;
+    };
+
+    struct Row {
+        BranchOutputFilter *filter;
+        bool recording;
+        bool replayBuffer;
+        size_t streamingIndex;
+        size_t groupIndex;
+        QString outputName;
+        QString outputKey; // Key of MetricsExporter::OutputMetrics
+        RowDisplay display;
+
+        uint64_t lastBytesSent;
+        uint64_t lastBytesSentTime;
+        int firstTotal;
+        int firstDropped;
+        int lastTotal;
+        int lastDropped;
+    };
+
+    QList<Row> rows;
+    QIcon streamingIcon;
+    QIcon recordingIcon;
+
+    void addRow(
+        BranchOutputFilter *filter, size_t streamingIndex, bool recording = false, size_t groupIndex = 0,
+        bool replayBuffer = false
+    );
+    void updateRow(int index, const MetricsExporter::FilterMetrics *metrics);
+    void updateStatistics(Row &row, const MetricsExporter::OutputMetrics *output, RowDisplay &display);
+    void setDisplay(int index, const RowDisplay &display);
 
 public:
-    explicit ParentCell(const QString &text, obs_source_t *source, QWidget *parent = (QWidget *)nullptr);
-    ~ParentCell();
+    explicit OutputTableModel(QObject *parent = (QObject *)nullptr);
+    ~OutputTableModel();
 
-    void setSourceName(const QString &text);
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+    Qt::ItemFlags flags(const QModelIndex &index) const override;
+    bool setData(const QModelIndex &index, const QVariant &value, int role = Qt::EditRole) override;
+
+    void addFilter(BranchOutputFilter *filter);
+    void removeFilter(BranchOutputFilter *filter);
+    // Rows out of [first, last] keep their last values
+    void refresh(int first, int last);
+    // Reset statistics or save replay buffer
+    void triggerAction(int index);
+    void openSourceFilters(int index);
+    QList<BranchOutputFilter *> getFilters() const;
 };
 
-class StatusCell : public QWidget {
+// Draw push buttons without widgets per row
+class ActionButtonDelegate : public QStyledItemDelegate {
     Q_OBJECT
 
-    QLabel *icon;
-    QLabel *statusText;
-
 public:
-    explicit StatusCell(const QString &text, QWidget *parent = (QWidget *)nullptr);
-    ~StatusCell();
+    explicit ActionButtonDelegate(QObject *parent = (QObject *)nullptr) : QStyledItemDelegate(parent) {}
+
+    void paint(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const override;
+    bool editorEvent(
+        QEvent *event, QAbstractItemModel *model, const QStyleOptionViewItem &option, const QModelIndex &index
+    ) override;
 
-    inline void setText(const QString &text) { statusText->setText(text); };
-    inline void setIcon(const QPixmap &pixmap) { icon->setPixmap(pixmap); };
-    inline void setIconShow(bool show) { icon->setVisible(show); };
-    inline void setTheme(const QString &id, const QString &classes) { setThemeID(statusText, id, classes); };
+signals:
+    void clicked(const QModelIndex &index);
 };
 
 class BranchOutputStatusDock : public QFrame {
     Q_OBJECT
 
     QTimer timer;
-    QTableWidget *outputTable = nullptr;
-    QList<OutputTableRow *> outputTableRows;
+    QTableView *outputTable = nullptr;
+    OutputTableModel *outputTableModel = nullptr;
     QPushButton *enableAllButton = nullptr;
     QPushButton *disableAllButton = nullptr;
     QLabel *interlockLabel = nullptr;
     QComboBox *interlockComboBox = nullptr;
+    QLabel *concurrentStartsLabel = nullptr;
+    QSpinBox *concurrentStartsSpinBox = nullptr;
+    QLabel *startIntervalLabel = nullptr;
+    QSpinBox *startIntervalSpinBox = nullptr;
+    QLabel *hardwareSessionsLabel = nullptr;
+    QSpinBox *hardwareSessionsSpinBox = nullptr;
+    QLabel *fallbackEncoderLabel = nullptr;
+    QComboBox *fallbackEncoderComboBox = nullptr;
+    QLabel *metricsPortLabel = nullptr;
+    QSpinBox *metricsPortSpinBox = nullptr;
+    QCheckBox *metricsRemoteCheckBox = nullptr;
     OBSSignal sourceAddedSignal;
     obs_hotkey_id enableAllHotkey;
     obs_hotkey_id disableAllHotkey;
+#ifdef ENABLE_TRACING
+    obs_hotkey_id dumpTraceHotkey;
+#endif
 
     void update();
     void saveSettings();
     void loadSettings();
+    void superviseAll();
+    void addFallbackEncoderItems(QComboBox *comboBox);
 
     static void onEanbleAllHotkeyPressed(void *data, obs_hotkey_id id, obs_hotkey *hotkey, bool pressed);
     static void onDisableAllHotkeyPressed(void *data, obs_hotkey_id id, obs_hotkey *hotkey, bool pressed);
+#ifdef ENABLE_TRACING
+    static void onDumpTraceHotkeyPressed(void *data, obs_hotkey_id id, obs_hotkey *hotkey, bool pressed);
+#endif
+    static void onFrontendEvent(enum obs_frontend_event event, void *data);
 
 protected:
     virtual void showEvent(QShowEvent *event) override;
@@ -121,43 +197,9 @@ public:
     ~BranchOutputStatusDock();
 
 public slots:
-    void addRow(BranchOutputFilter *filter, size_t streamingIndex, bool recording = false, size_t groupIndex = 0);
     void addFilter(BranchOutputFilter *filter);
     void removeFilter(BranchOutputFilter *filter);
     void setEabnleAll(bool enabled);
 
     inline int getInterlockType() const { return interlockComboBox->currentData().toInt(); };
 };
-
-class OutputTableRow : public QObject {
-    Q_OBJECT
-
-    friend class BranchOutputStatusDock;
-
-    BranchOutputFilter *filter;
-    FilterCell *filterCell;
-    ParentCell *parentCell;
-    StatusCell *status;
-    bool recording;
-    size_t streamingIndex;
-    size_t groupIndex;
-    QLabel *droppedFrames;
-    QLabel *megabytesSent;
-    QLabel *bitrate;
-    QLabel *outputName;
-
-    uint64_t lastBytesSent = 0;
-    uint64_t lastBytesSentTime = 0;
-
-    int first_total = 0;
-    int first_dropped = 0;
-
-    void update();
-    void reset();
-
-    long double kbps = 0.0l;
-
-public:
-    explicit OutputTableRow(QObject *parent = (QObject *)nullptr);
-    ~OutputTableRow();
-};
@@ -0,0 +1,106 @@
+/*
+Branch Output Plugin
+Copyright (C) 2024 OPENSPHERE Inc. info@opensphere.co.jp
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#include <obs-module.h>
+#include <obs.hpp>
+
+#include "adaptive-bitrate.hpp"
+#include "plugin-support.h"
+
+//--- AdaptiveBitrateController class ---//
+
+AdaptiveBitrateController::AdaptiveBitrateController(const QString &_name, obs_encoder_t *_encoder, int minPercent)
+    : name(_name),
+      encoder(_encoder),
+      maxBitrate(0),
+      minBitrate(0),
+      bitrate(0),
+      stableIntervals(0)
+{
+    OBSDataAutoRelease settings = obs_encoder_get_settings(encoder);
+    maxBitrate = obs_data_get_int(settings, "bitrate");
+    minBitrate = qMax(maxBitrate * minPercent / 100, (int64_t)1);
+    bitrate = maxBitrate;
+
+    obs_log(
+        LOG_DEBUG, "%s: Adaptive bitrate enabled for '%s' (%lld-%lld kbps)", qUtf8Printable(name),
+        obs_encoder_get_name(encoder), (long long)minBitrate, (long long)maxBitrate
+    );
+}
+
+AdaptiveBitrateController::~AdaptiveBitrateController() {}
+
+void AdaptiveBitrateController::applyBitrate(int64_t value)
+{
+    obs_log(
+        LOG_INFO, "%s: Adaptive bitrate %lld -> %lld kbps", qUtf8Printable(name), (long long)bitrate, (long long)value
+    );
+    bitrate = value;
+
+    OBSDataAutoRelease settings = obs_data_create();
+    obs_data_set_int(settings, "bitrate", bitrate);
+    obs_encoder_update(encoder, settings);
+}
+
+void AdaptiveBitrateController::evaluate(const QList<obs_output_t *> &outputs)
+{
+    if (maxBitrate <= 0) {
+        // Encoder isn't bitrate based (e.g. CQP, CRF)
+        return;
+    }
+
+    // The worst stream decides (A saturated uplink drags down every stream fed by the encoder)
+    auto congestion = 0.0f;
+    auto congested = false;
+    QHash<obs_output_t *, FrameCounts> counts;
+    foreach (auto output, outputs) {
+        congestion = qMax(congestion, obs_output_get_congestion(output));
+
+        FrameCounts current = {obs_output_get_frames_dropped(output), obs_output_get_total_frames(output)};
+        counts.insert(output, current);
+
+        auto last = lastCounts.find(output);
+        if (last != lastCounts.end() && current.total > last->total) {
+            auto dropped = current.dropped - last->dropped;
+            auto total = current.total - last->total;
+            if (dropped * 1000 >= total * ADAPTIVE_BITRATE_DROP_PERMILLE) {
+                congested = true;
+            }
+        }
+    }
+    // Forget stopped outputs
+    lastCounts = counts;
+
+    if (congested || congestion >= ADAPTIVE_BITRATE_CONGESTION_HIGH) {
+        stableIntervals = 0;
+        auto value = qMax(bitrate * (100 - ADAPTIVE_BITRATE_DECREASE_PERCENT) / 100, minBitrate);
+        if (value < bitrate) {
+            applyBitrate(value);
+        }
+
+    } else if (congestion < ADAPTIVE_BITRATE_CONGESTION_LOW && bitrate < maxBitrate) {
+        // Probe upward slowly
+        if (++stableIntervals >= ADAPTIVE_BITRATE_STABLE_INTERVALS) {
+            stableIntervals = 0;
+            applyBitrate(qMin(bitrate + maxBitrate * ADAPTIVE_BITRATE_INCREASE_PERCENT / 100, maxBitrate));
+        }
+
+    } else {
+        stableIntervals = 0;
+    }
+}
@@ -0,0 +1,63 @@
+/*
+Branch Output Plugin
+Copyright (C) 2024 OPENSPHERE Inc. info@opensphere.co.jp
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#pragma once
+
+#include <obs-module.h>
+
+#include <QHash>
+#include <QList>
+#include <QString>
+
+#define ADAPTIVE_BITRATE_INTERVAL_MS 2000
+#define ADAPTIVE_BITRATE_CONGESTION_HIGH 0.5f
+#define ADAPTIVE_BITRATE_CONGESTION_LOW 0.1f
+#define ADAPTIVE_BITRATE_DROP_PERMILLE 10    // Dropped frames per thousand frames to lower bitrate
+#define ADAPTIVE_BITRATE_DECREASE_PERCENT 25 // Multiplicative decrease
+#define ADAPTIVE_BITRATE_INCREASE_PERCENT 5  // Additive increase (Percentage of the configured bitrate)
+#define ADAPTIVE_BITRATE_STABLE_INTERVALS 5  // Uncongested intervals before raising bitrate
+
+// Lowers and raises bitrate of one video encoder following congestion and dropped frames of the streams fed by it.
+// Bitrate stays between the minimum and the bitrate configured in encoder settings (AIMD, like TCP).
+// The encoder must not be shared with other filters (Acquire it as exclusive from VideoEngine).
+class AdaptiveBitrateController {
+    struct FrameCounts {
+        int dropped;
+        int total;
+    };
+
+    QString name;
+    obs_encoder_t *encoder; // Not owned
+    int64_t maxBitrate;     // kbps
+    int64_t minBitrate;
+    int64_t bitrate;
+    int stableIntervals;
+    QHash<obs_output_t *, FrameCounts> lastCounts;
+
+    void applyBitrate(int64_t value);
+
+public:
+    AdaptiveBitrateController(const QString &name, obs_encoder_t *encoder, int minPercent);
+    ~AdaptiveBitrateController();
+
+    // Call periodically with active stream outputs using the encoder
+    void evaluate(const QList<obs_output_t *> &outputs);
+
+    inline obs_encoder_t *getEncoder() const { return encoder; }
+    inline int64_t getBitrate() const { return bitrate; }
+};
@@ -19,36 +19,106 @@ with this program. If not, see <https://www.gnu.org/licenses/>
 #include <obs-module.h>
 
 #include "audio-capture.hpp"
+#include "audio-engine.hpp"
+#include "audio-mix.hpp"
 #include "../plugin-support.h"
+#include "../trace.hpp"
 
 #define MAX_AUDIO_BUFFER_FRAMES 131071
 
+// Drift compensation tuning
+#define DRIFT_MAX_DEPTH_FACTOR 4               // Bounded depth (Multiple of target depth)
+#define DRIFT_SMOOTHING 0.02                   // EMA coefficient for depth error
+#define DRIFT_GAIN 0.002                       // Resampling ratio per normalized lag error
+#define DRIFT_MAX_RATIO 0.002                  // +-2000ppm at most (Inaudible pitch change)
+#define DRIFT_DISCONTINUITY_NS 100000000LL     // Timestamp jump to resync (100ms)
+#define DRIFT_LOG_INTERVAL_NS 60000000000ULL   // Periodic drift report (60s)
+
 //--- AudioCapture class ---//
 
 AudioCapture::AudioCapture(
-    const char *_name, uint32_t _samplesPerSec, speaker_layout _speakers, audio_input_callback_t _captureCallback,
-    QObject *parent
+    const char *_name, uint32_t _samplesPerSec, speaker_layout _speakers, bool _silence, QObject *parent
 )
     : QObject(parent),
+      audio(nullptr),
+      mixIndex(0),
+      silence(_silence),
       name(_name),
       samplesPerSec(_samplesPerSec),
       speakers(_speakers),
+      channels(get_audio_channels(_speakers)),
+      audioBuffer(new AudioRingBuffer(channels, _silence ? 0 : MAX_AUDIO_BUFFER_FRAMES)),
+      readerId(-1),
+      active(false),
+      overflowFlushes(0),
+      underruns(0),
+      driftCompensation(false),
+      driftPrimed(false),
+      driftTargetLagNs(0),
+      driftFillError(0.0),
+      driftPhase(0.0),
+      driftExpectedReadTs(0),
+      driftLastLogAt(0),
+      resampleBuffer{}
+{
+    // Never processes events, so detach from creating thread (Created in worker thread, deleted in any thread)
+    if (!parent) {
+        moveToThread(nullptr);
+    }
+
+    if (silence) {
+        audio = AudioEngine::getInstance()->acquireSilence(_samplesPerSec, _speakers);
+        return;
+    }
+
+    readerId = audioBuffer->addReader();
+    audio = AudioEngine::getInstance()->attach(this, _samplesPerSec, _speakers, &mixIndex);
+    if (!audio) {
+        return;
+    }
+
+    active = true;
+}
+
+AudioCapture::AudioCapture(
+    const char *_name, uint32_t _samplesPerSec, speaker_layout _speakers, QSharedPointer<AudioRingBuffer> sharedBuffer,
+    QObject *parent
+)
+    : QObject(parent),
       audio(nullptr),
-      audioBuffer({0}),
-      audioBufferFrames(0),
-      audioConvBuffer(nullptr),
-      audioConvBufferSize(0)
+      mixIndex(0),
+      silence(false),
+      name(_name),
+      samplesPerSec(_samplesPerSec),
+      speakers(_speakers),
+      channels(sharedBuffer->getChannels()),
+      audioBuffer(sharedBuffer),
+      readerId(-1),
+      active(false),
+      overflowFlushes(0),
+      underruns(0),
+      driftCompensation(false),
+      driftPrimed(false),
+      driftTargetLagNs(0),
+      driftFillError(0.0),
+      driftPhase(0.0),
+      driftExpectedReadTs(0),
+      driftLastLogAt(0),
+      resampleBuffer{}
 {
-    audio_output_info aoi = {0};
-    aoi.name = _name;
-    aoi.samples_per_sec = _samplesPerSec;
-    aoi.speakers = _speakers;
-    aoi.format = AUDIO_FORMAT_FLOAT_PLANAR;
-    aoi.input_param = this;
-    aoi.input_callback = _captureCallback;
-
-    if (audio_output_open(&audio, &aoi) < 0) {
-        audio = nullptr;
+    // Never processes events, so detach from creating thread (Created in worker thread, deleted in any thread)
+    if (!parent) {
+        moveToThread(nullptr);
+    }
+
+    readerId = audioBuffer->addReader();
+    if (readerId < 0) {
+        obs_log(LOG_ERROR, "%s: No more reader can be attached to shared audio buffer", qUtf8Printable(name));
+        return;
+    }
+
+    audio = AudioEngine::getInstance()->attach(this, _samplesPerSec, _speakers, &mixIndex);
+    if (!audio) {
         return;
     }
 
@@ -60,167 +130,223 @@ AudioCapture::~AudioCapture()
     active = false;
 
     if (audio) {
-        audio_output_close(audio);
+        if (silence) {
+            AudioEngine::getInstance()->releaseSilence();
+        } else {
+            AudioEngine::getInstance()->detach(this);
+        }
     }
 
-    deque_free(&audioBuffer);
-    bfree(audioConvBuffer);
+    // Stop holding back the producer
+    audioBuffer->removeReader(readerId);
 }
 
+QSharedPointer<AudioRingBuffer> AudioCapture::createSharedBuffer(speaker_layout speakers)
+{
+    return QSharedPointer<AudioRingBuffer>(new AudioRingBuffer(get_audio_channels(speakers), MAX_AUDIO_BUFFER_FRAMES));
+}
+
+// Called from AudioEngine mixer thread (Consumer)
 uint64_t AudioCapture::popAudio(uint64_t startTsIn, uint32_t mixers, audio_output_data *audioData)
 {
+    TRACE_SCOPE(TRACE_SITE_POP_AUDIO);
+
     if (!active) {
         return startTsIn;
     }
 
-    QMutexLocker locker(&audioBufferMutex);
-    {
-        if (audioBufferFrames < AUDIO_OUTPUT_FRAMES) {
-            // Wait until enough frames are receved.
-            // DO NOT stall audio output pipeline
-            return startTsIn;
-        }
+    // Drop buffered frames when producer detected overflow
+    if (audioBuffer->handleFlush(readerId)) {
+        overflowFlushes.fetch_add(1, std::memory_order_relaxed);
+        driftPrimed = false;
+    }
 
-        size_t maxFrames = AUDIO_OUTPUT_FRAMES;
-
-        while (maxFrames > 0 && audioBufferFrames) {
-            // Peek header of first chunk
-            deque_peek_front(&audioBuffer, audioConvBuffer, sizeof(AudioBufferHeader));
-            auto header = (AudioBufferHeader *)audioConvBuffer;
-            auto dataSize = sizeof(AudioBufferHeader) + header->speakers * header->frames * 4;
-
-            // Read chunk data
-            deque_peek_front(&audioBuffer, audioConvBuffer, dataSize);
-
-            auto chunkFrames = header->frames - header->offset;
-            auto frames = (chunkFrames > maxFrames) ? maxFrames : chunkFrames;
-            auto outOffset = AUDIO_OUTPUT_FRAMES - maxFrames;
-
-            for (auto tr = 0; tr < MAX_AUDIO_MIXES; tr++) {
-                if ((mixers & (1 << tr)) == 0) {
-                    continue;
-                }
-                for (auto ch = 0; ch < header->speakers; ch++) {
-                    auto out = audioData[tr].data[ch] + outOffset;
-                    if (!header->data_idx[ch]) {
-                        continue;
-                    }
-                    auto in = (float *)(audioConvBuffer + header->data_idx[ch]) + header->offset;
-
-                    for (size_t i = 0; i < frames; i++) {
-                        *out += *(in++);
-                        if (*out > 1.0f) {
-                            *out = 1.0f;
-                        } else if (*out < -1.0f) {
-                            *out = -1.0f;
-                        }
-                        out++;
-                    }
-                }
-            }
+    if (driftCompensation.load(std::memory_order_relaxed)) {
+        popAudioCompensated(startTsIn, mixers, audioData);
+        return startTsIn;
+    }
 
-            if (frames == chunkFrames) {
-                // Remove fulfilled chunk from buffer
-                deque_pop_front(&audioBuffer, NULL, dataSize);
-            } else {
-                // Chunk frames are remaining -> modify chunk header
-                header->offset += frames;
-                deque_place(&audioBuffer, 0, header, sizeof(AudioBufferHeader));
-            }
+    if (audioBuffer->size(readerId) < AUDIO_OUTPUT_FRAMES) {
+        // Wait until enough frames are receved.
+        // DO NOT stall audio output pipeline
+        underruns.fetch_add(1, std::memory_order_relaxed);
+        return startTsIn;
+    }
 
-            maxFrames -= frames;
+    for (size_t ch = 0; ch < channels; ch++) {
+        // Read channel plane in place (Two spans at the wrap point)
+        AudioSpan spans[2];
+        auto spanCount = audioBuffer->peek(readerId, ch, AUDIO_OUTPUT_FRAMES, spans);
 
-            // Decrement buffer usage
-            audioBufferFrames -= frames;
+        for (auto tr = 0; tr < MAX_AUDIO_MIXES; tr++) {
+            if ((mixers & (1 << tr)) == 0) {
+                continue;
+            }
+            auto out = audioData[tr].data[ch];
+
+            for (size_t s = 0; s < spanCount; s++) {
+                mixAndClamp(out, spans[s].data, spans[s].frames);
+                out += spans[s].frames;
+            }
         }
     }
-    locker.unlock();
+
+    audioBuffer->consume(readerId, AUDIO_OUTPUT_FRAMES);
 
     return startTsIn;
 }
 
-void AudioCapture::pushAudio(const audio_data *audioData)
+// Called from AudioEngine mixer thread (Consumer)
+// Resample AUDIO_OUTPUT_FRAMES from slightly more or fewer input frames to hold the lag steady.
+// Lag is the consumer clock (startTsIn) minus the timestamp of the frame being read, so producer clock drift shows up
+// as the lag drifting away from the value measured when primed. Buffer depth is used only without timestamps.
+void AudioCapture::popAudioCompensated(uint64_t startTsIn, uint32_t mixers, audio_output_data *audioData)
 {
-    if (!active) {
-        return;
+    auto available = audioBuffer->size(readerId);
+    auto blockFrames = audioBuffer->getMaxBlockFrames();
+    auto target = (size_t)AUDIO_OUTPUT_FRAMES + (blockFrames > AUDIO_OUTPUT_FRAMES / 2 ? blockFrames
+                                                                                        : AUDIO_OUTPUT_FRAMES / 2);
+    auto maxDepth = target * DRIFT_MAX_DEPTH_FACTOR;
+
+    uint64_t readTs = 0;
+    auto hasReadTs = audioBuffer->getReadTimestamp(readerId, samplesPerSec, &readTs);
+
+    if (driftPrimed && hasReadTs && driftExpectedReadTs) {
+        auto jump = (int64_t)(readTs - driftExpectedReadTs);
+        if (jump > DRIFT_DISCONTINUITY_NS || jump < -DRIFT_DISCONTINUITY_NS) {
+            obs_log(
+                LOG_DEBUG, "%s: Audio timestamp jumped %lld ms, resyncing", qUtf8Printable(name),
+                (long long)(jump / 1000000)
+            );
+            driftPrimed = false;
+        }
     }
 
-    QMutexLocker locker(&audioBufferMutex);
-    {
-        // Push audio data to buffer
-        if (audioBufferFrames + audioData->frames > MAX_AUDIO_BUFFER_FRAMES) {
-            obs_log(LOG_WARNING, "%s: The audio buffer is full", qUtf8Printable(name));
-            deque_free(&audioBuffer);
-            deque_init(&audioBuffer);
-            audioBufferFrames = 0;
+    if (!driftPrimed) {
+        if (available < target) {
+            // Wait until target depth is reached (Output silence meanwhile)
+            return;
         }
+        // Start from target depth
+        audioBuffer->consume(readerId, available - target);
+        available = target;
+        driftPrimed = true;
+        driftFillError = 0.0;
+        driftPhase = 0.0;
+
+        hasReadTs = audioBuffer->getReadTimestamp(readerId, samplesPerSec, &readTs);
+        driftTargetLagNs = hasReadTs ? (int64_t)(startTsIn - readTs) : 0;
+    }
 
-        // Compute header
-        AudioBufferHeader header = {0};
-        header.frames = audioData->frames;
-        header.timestamp = audioData->timestamp;
-        header.samples_per_sec = samplesPerSec;
-        header.speakers = speakers;
-        header.format = AUDIO_FORMAT_FLOAT_PLANAR;
+    if (available > maxDepth) {
+        // Bounded depth: Trim oldest frames instead of flushing whole buffer (Also recovers from producer overflow)
+        obs_log(LOG_DEBUG, "%s: Trim %zu audio frames to hold depth", qUtf8Printable(name), available - target);
+        audioBuffer->consume(readerId, available - target);
+        available = target;
+        driftFillError = 0.0;
+        hasReadTs = audioBuffer->getReadTimestamp(readerId, samplesPerSec, &readTs);
+    }
 
-        for (auto i = 0, channels = 0; i < header.speakers; i++) {
-            if (!audioData->data[i]) {
-                continue;
-            }
-            header.data_idx[i] = sizeof(AudioBufferHeader) + channels * audioData->frames * 4;
-            channels++;
+    double error;
+    if (hasReadTs && driftTargetLagNs) {
+        auto lagNs = (int64_t)(startTsIn - readTs);
+        error = (double)(lagNs - driftTargetLagNs) * (double)samplesPerSec / 1000000000.0;
+    } else {
+        error = (double)available - (double)target;
+    }
+    driftFillError += (error - driftFillError) * DRIFT_SMOOTHING;
+
+    auto ratio = driftFillError / (double)target * DRIFT_GAIN;
+    ratio = ratio > DRIFT_MAX_RATIO ? DRIFT_MAX_RATIO : ratio < -DRIFT_MAX_RATIO ? -DRIFT_MAX_RATIO : ratio;
+    auto step = 1.0 + ratio;
+
+    auto endPos = driftPhase + (double)AUDIO_OUTPUT_FRAMES * step;
+    auto consumed = (size_t)endPos;
+    if (consumed + 1 > available) {
+        // Underrun -> Prime again
+        obs_log(LOG_DEBUG, "%s: Audio buffer underrun", qUtf8Printable(name));
+        underruns.fetch_add(1, std::memory_order_relaxed);
+        driftPrimed = false;
+        return;
+    }
+
+    for (size_t ch = 0; ch < channels; ch++) {
+        AudioSpan spans[2];
+        auto spanCount = audioBuffer->peek(readerId, ch, consumed + 1, spans);
+        auto firstFrames = spans[0].frames;
+
+        auto sampleAt = [&](size_t k) {
+            return (k < firstFrames || spanCount < 2) ? spans[0].data[k] : spans[1].data[k - firstFrames];
+        };
+
+        // Linear interpolation
+        for (size_t i = 0; i < AUDIO_OUTPUT_FRAMES; i++) {
+            auto pos = driftPhase + (double)i * step;
+            auto k = (size_t)pos;
+            auto frac = (float)(pos - (double)k);
+            auto s0 = sampleAt(k);
+            auto s1 = sampleAt(k + 1);
+            resampleBuffer[i] = s0 + (s1 - s0) * frac;
         }
 
-        // Push audio data to buffer
-        deque_push_back(&audioBuffer, &header, sizeof(AudioBufferHeader));
-        for (auto i = 0; i < header.speakers; i++) {
-            if (!audioData->data[i]) {
+        for (auto tr = 0; tr < MAX_AUDIO_MIXES; tr++) {
+            if ((mixers & (1 << tr)) == 0) {
                 continue;
             }
-            deque_push_back(&audioBuffer, audioData->data[i], audioData->frames * 4);
+            mixAndClamp(audioData[tr].data[ch], resampleBuffer, AUDIO_OUTPUT_FRAMES);
         }
+    }
 
-        auto dataSize = sizeof(AudioBufferHeader) + header.speakers * header.frames * 4;
-        if (dataSize > audioConvBufferSize) {
-            obs_log(
-                LOG_DEBUG, "%s: Expand audioConvBuffer from %zu to %zu bytes", qUtf8Printable(name),
-                audioConvBufferSize, dataSize
-            );
-            audioConvBuffer = (uint8_t *)brealloc(audioConvBuffer, dataSize);
-            audioConvBufferSize = dataSize;
-        }
+    audioBuffer->consume(readerId, consumed);
+    driftPhase = endPos - (double)consumed;
 
-        audioBufferFrames += audioData->frames;
+    // Expected timestamp at the new read position (Compared on next pop)
+    if (!audioBuffer->getReadTimestamp(readerId, samplesPerSec, &driftExpectedReadTs)) {
+        driftExpectedReadTs = 0;
+    }
+
+    if (startTsIn - driftLastLogAt > DRIFT_LOG_INTERVAL_NS) {
+        driftLastLogAt = startTsIn;
+        obs_log(
+            LOG_DEBUG, "%s: Audio drift compensation ratio=%+.0fppm depth=%zu/%zu lag=%.1fms", qUtf8Printable(name),
+            ratio * 1000000.0, available, target,
+            hasReadTs ? (double)((int64_t)(startTsIn - readTs)) / 1000000.0 : 0.0
+        );
     }
-    locker.unlock();
 }
 
-// Convert obs_audio_data to audio_data
-void AudioCapture::pushAudio(const obs_audio_data *audioData)
+// Called from source audio callback (Producer)
+void AudioCapture::pushAudio(const audio_data *audioData)
 {
-    audio_data ad = {0};
-    ad.frames = audioData->frames;
-    ad.timestamp = audioData->timestamp;
-    memcpy(ad.data, audioData->data, sizeof(audio_data::data));
+    TRACE_SCOPE(TRACE_SITE_PUSH_AUDIO);
 
-    pushAudio(&ad);
-}
+    if (!active) {
+        return;
+    }
 
-// Callback from audio_output_open
-bool AudioCapture::audioCapture(
-    void *param, uint64_t start_ts_in, uint64_t, uint64_t *out_ts, uint32_t mixers, audio_output_data *mixes
-)
-{
-    auto *audioSource = static_cast<AudioCapture *>(param);
-    *out_ts = audioSource->popAudio(start_ts_in, mixers, mixes);
-    return true;
+    if (!audioBuffer->write(audioData->data, audioData->frames, audioData->timestamp)) {
+        if (driftCompensation.load(std::memory_order_relaxed)) {
+            // Consumer trims oldest frames down to target depth by itself (Keep the buffer instead of flushing)
+            obs_log(LOG_DEBUG, "%s: The audio buffer is full, consumer is stalled", qUtf8Printable(name));
+            return;
+        }
+
+        // Let consumer drop buffered frames (Producer must not touch read position)
+        obs_log(LOG_WARNING, "%s: The audio buffer is full", qUtf8Printable(name));
+        audioBuffer->requestFlush();
+    }
 }
 
-// Callback from audio_output_open
-bool AudioCapture::silenceCapture(void *, uint64_t startTsIn, uint64_t, uint64_t *outTs, uint32_t, audio_output_data *)
+// Called from filter audio callback (Producer)
+void AudioCapture::pushAudio(AudioRingBuffer *buffer, const QString &bufferName, const obs_audio_data *audioData)
 {
-    *outTs = startTsIn;
-    return true;
+    TRACE_SCOPE(TRACE_SITE_PUSH_AUDIO);
+
+    if (!buffer->write(audioData->data, audioData->frames, audioData->timestamp)) {
+        // Let consumers drop buffered frames (Producer must not touch read positions)
+        obs_log(LOG_WARNING, "%s: The audio buffer is full", qUtf8Printable(bufferName));
+        buffer->requestFlush();
+    }
 }
 
 //--- SourceAudioCapture class ---//
@@ -228,7 +354,7 @@ bool AudioCapture::silenceCapture(void *, uint64_t startTsIn, uint64_t, uint64_t
 SourceAudioCapture::SourceAudioCapture(
     obs_source_t *source, uint32_t _samplesPerSec, speaker_layout _speakers, QObject *parent
 )
-    : AudioCapture(obs_source_get_name(source), _samplesPerSec, _speakers, AudioCapture::audioCapture, parent),
+    : AudioCapture(obs_source_get_name(source), _samplesPerSec, _speakers, false, parent),
       weakSource(obs_source_get_weak_source(source))
 {
     obs_source_add_audio_capture_callback(source, sourceAudioCallback, this);
@@ -20,59 +20,80 @@ with this program. If not, see <https://www.gnu.org/licenses/>
 
 #include <obs-module.h>
 #include <obs.hpp>
-#include <util/deque.h>
 
 #include <QObject>
-#include <QMutex>
+#include <QSharedPointer>
+
+#include <atomic>
+
+#include "audio-ring-buffer.hpp"
 
 // Base audio capture (default silence)
 class AudioCapture : public QObject {
     Q_OBJECT
 
     audio_t *audio;
+    size_t mixIndex;
+    bool silence;
 
 protected:
     QString name;
     uint32_t samplesPerSec;
     speaker_layout speakers;
+    size_t channels;
 
-    deque audioBuffer;
-    size_t audioBufferFrames;
-    uint8_t *audioConvBuffer;
-    size_t audioConvBufferSize;
-    QMutex audioBufferMutex;
+    // Written by producer and read by popAudio() (consumer) through own cursor without locking
+    QSharedPointer<AudioRingBuffer> audioBuffer;
+    int readerId;
     bool active;
 
-public:
-    struct AudioBufferHeader {
-        size_t data_idx[MAX_AV_PLANES]; // Zero means unused channel
-        uint32_t frames;
-        speaker_layout speakers;
-        audio_format format;
-        uint32_t samples_per_sec;
-        uint64_t timestamp;
-        size_t offset;
-    };
+    // Counted by consumer, read by metrics exporter
+    std::atomic<uint64_t> overflowFlushes;
+    std::atomic<uint64_t> underruns;
+
+    // Drift compensation (Keep small, steady buffer depth instead of flushing on overflow)
+    std::atomic<bool> driftCompensation;
+    // Following members are touched by consumer only
+    bool driftPrimed;
+    int64_t driftTargetLagNs; // Consumer clock minus read timestamp when primed (0 means no timestamps)
+    double driftFillError;    // Smoothed lag error in frames
+    double driftPhase;     // Fractional read position carried between pops
+    uint64_t driftExpectedReadTs;
+    uint64_t driftLastLogAt;
+    float resampleBuffer[AUDIO_OUTPUT_FRAMES];
 
+    void popAudioCompensated(uint64_t startTsIn, uint32_t mixers, audio_output_data *audioData);
+
+    // Read from externally owned (shared) buffer
     explicit AudioCapture(
         const char *_name, uint32_t _samplesPerSec, speaker_layout _speakers,
-        audio_input_callback_t _captureCallback = silenceCapture, QObject *parent = nullptr
+        QSharedPointer<AudioRingBuffer> sharedBuffer, QObject *parent = nullptr
+    );
+
+public:
+    // Audio is hosted by AudioEngine (silence = true uses the shared silence audio)
+    explicit AudioCapture(
+        const char *_name, uint32_t _samplesPerSec, speaker_layout _speakers, bool _silence = true,
+        QObject *parent = nullptr
     );
     ~AudioCapture();
 
+    // Buffer for FilterAudioCapture fan-out (Written once, read by every filter track)
+    static QSharedPointer<AudioRingBuffer> createSharedBuffer(speaker_layout speakers);
+
     inline audio_t *getAudio() { return audio; }
+    // Mix index of the shared audio assigned to this capture
+    inline size_t getMixIndex() { return mixIndex; }
+    inline void setDriftCompensation(bool enabled) { driftCompensation.store(enabled, std::memory_order_relaxed); }
     uint64_t popAudio(uint64_t startTsIn, uint32_t mixers, audio_output_data *audioData);
     void pushAudio(const audio_data *audioData);
-    void pushAudio(const obs_audio_data *audioData);
+    // Push to shared buffer (Fan-out to all attached readers)
+    static void pushAudio(AudioRingBuffer *buffer, const QString &bufferName, const obs_audio_data *audioData);
     virtual bool hasSource() { return true; }
     inline QString getName() { return name; }
-
-    static bool audioCapture(
-        void *param, uint64_t startTsIn, uint64_t, uint64_t *outTs, uint32_t mixers, audio_output_data *audioData
-    );
-    static bool silenceCapture(
-        void *param, uint64_t startTsIn, uint64_t, uint64_t *outTs, uint32_t mixers, audio_output_data *audioData
-    );
+    inline size_t getBufferedFrames() const { return readerId >= 0 ? audioBuffer->size(readerId) : 0; }
+    inline uint64_t getOverflowFlushes() const { return overflowFlushes.load(std::memory_order_relaxed); }
+    inline uint64_t getUnderruns() const { return underruns.load(std::memory_order_relaxed); }
 };
 
 // Audio capture from source
@@ -90,15 +111,16 @@ public:
     ~SourceAudioCapture();
 };
 
-// Audio capture from filter (Audio will be pushed externally)
+// Audio capture from filter (Audio will be pushed externally into the shared buffer)
 class FilterAudioCapture : public AudioCapture {
     Q_OBJECT
 
 public:
     explicit FilterAudioCapture(
-        const char *_name, uint32_t _samplesPerSec, speaker_layout _speakers, QObject *parent = nullptr
+        const char *_name, uint32_t _samplesPerSec, speaker_layout _speakers,
+        QSharedPointer<AudioRingBuffer> sharedBuffer, QObject *parent = nullptr
     )
-        : AudioCapture(_name, _samplesPerSec, _speakers, audioCapture, parent)
+        : AudioCapture(_name, _samplesPerSec, _speakers, sharedBuffer, parent)
     {
     }
     ~FilterAudioCapture() {}
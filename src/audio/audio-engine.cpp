@@ -0,0 +1,243 @@
+/*
+Branch Output Plugin
+Copyright (C) 2024 OPENSPHERE Inc. info@opensphere.co.jp
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#include <obs-module.h>
+
+#include "audio-engine.hpp"
+#include "audio-capture.hpp"
+#include "../plugin-support.h"
+
+AudioEngine *AudioEngine::instance = nullptr;
+
+//--- AudioEngine class ---//
+
+AudioEngine::AudioEngine()
+    : silenceAudio(nullptr),
+      silenceSamplesPerSec(0),
+      silenceSpeakers(SPEAKERS_UNKNOWN),
+      silenceRefs(0)
+{
+}
+
+AudioEngine::~AudioEngine()
+{
+    // Normally all captures have been detached at this time
+    foreach (auto pool, pools) {
+        obs_log(LOG_WARNING, "Audio engine: Closing mixer pool with %zu captures", pool->used);
+        audio_output_close(pool->audio);
+        delete pool;
+    }
+    pools.clear();
+
+    if (silenceAudio) {
+        audio_output_close(silenceAudio);
+        silenceAudio = nullptr;
+    }
+}
+
+AudioEngine *AudioEngine::getInstance()
+{
+    // First call is made in obs_module_load() before any worker thread runs
+    if (!instance) {
+        instance = new AudioEngine();
+    }
+    return instance;
+}
+
+void AudioEngine::destroyInstance()
+{
+    delete instance;
+    instance = nullptr;
+}
+
+audio_t *AudioEngine::attach(AudioCapture *capture, uint32_t samplesPerSec, speaker_layout speakers, size_t *mixIndex)
+{
+    QMutexLocker locker(&mutex);
+
+    // Find pool having free slot with same audio spec
+    AudioMixerPool *pool = nullptr;
+    foreach (auto p, pools) {
+        if (p->samplesPerSec == samplesPerSec && p->speakers == speakers && p->used < MAX_AUDIO_MIXES) {
+            pool = p;
+            break;
+        }
+    }
+
+    if (!pool) {
+        pool = new AudioMixerPool();
+        pool->audio = nullptr;
+        pool->samplesPerSec = samplesPerSec;
+        pool->speakers = speakers;
+        pool->used = 0;
+        for (size_t i = 0; i < MAX_AUDIO_MIXES; i++) {
+            pool->captures[i] = nullptr;
+        }
+
+        audio_output_info aoi = {0};
+        aoi.name = "Branch Output Mixer";
+        aoi.samples_per_sec = samplesPerSec;
+        aoi.speakers = speakers;
+        aoi.format = AUDIO_FORMAT_FLOAT_PLANAR;
+        aoi.input_param = pool;
+        aoi.input_callback = mixerCallback;
+
+        // Every slot is empty yet, so callbacks are no-op until the capture is assigned below.
+        if (audio_output_open(&pool->audio, &aoi) < 0) {
+            obs_log(LOG_ERROR, "Audio engine: Mixer pool creation failed");
+            delete pool;
+            return nullptr;
+        }
+
+        pools.push_back(pool);
+        obs_log(LOG_DEBUG, "Audio engine: Mixer pool created (pools=%lld)", (long long)pools.size());
+    }
+
+    QMutexLocker poolLocker(&pool->mutex);
+    for (size_t i = 0; i < MAX_AUDIO_MIXES; i++) {
+        if (!pool->captures[i]) {
+            pool->captures[i] = capture;
+            pool->used++;
+            *mixIndex = i;
+            break;
+        }
+    }
+
+    return pool->audio;
+}
+
+void AudioEngine::detach(AudioCapture *capture)
+{
+    AudioMixerPool *emptyPool = nullptr;
+
+    QMutexLocker locker(&mutex);
+    {
+        foreach (auto pool, pools) {
+            for (size_t i = 0; i < MAX_AUDIO_MIXES; i++) {
+                if (pool->captures[i] != capture) {
+                    continue;
+                }
+
+                // Wait for the mixer thread to finish the current tick
+                pool->mutex.lock();
+                pool->captures[i] = nullptr;
+                pool->mutex.unlock();
+                pool->used--;
+
+                if (!pool->used) {
+                    pools.removeOne(pool);
+                    emptyPool = pool;
+                }
+                break;
+            }
+            if (emptyPool) {
+                break;
+            }
+        }
+    }
+    locker.unlock();
+
+    if (emptyPool) {
+        // DO NOT hold the mutex here, audio_output_close() joins the thread which may be waiting for it.
+        audio_output_close(emptyPool->audio);
+        delete emptyPool;
+        obs_log(LOG_DEBUG, "Audio engine: Mixer pool destroyed");
+    }
+}
+
+audio_t *AudioEngine::acquireSilence(uint32_t samplesPerSec, speaker_layout speakers)
+{
+    QMutexLocker locker(&mutex);
+
+    if (silenceAudio && (silenceSamplesPerSec != samplesPerSec || silenceSpeakers != speakers)) {
+        // Audio spec changed (Should not happen while outputs are running)
+        obs_log(LOG_WARNING, "Audio engine: Silence audio spec mismatch");
+        return nullptr;
+    }
+
+    if (!silenceAudio) {
+        audio_output_info aoi = {0};
+        aoi.name = "Branch Output Silence";
+        aoi.samples_per_sec = samplesPerSec;
+        aoi.speakers = speakers;
+        aoi.format = AUDIO_FORMAT_FLOAT_PLANAR;
+        aoi.input_param = this;
+        aoi.input_callback = silenceCallback;
+
+        if (audio_output_open(&silenceAudio, &aoi) < 0) {
+            obs_log(LOG_ERROR, "Audio engine: Silence audio creation failed");
+            silenceAudio = nullptr;
+            return nullptr;
+        }
+
+        silenceSamplesPerSec = samplesPerSec;
+        silenceSpeakers = speakers;
+        obs_log(LOG_DEBUG, "Audio engine: Silence audio created");
+    }
+
+    silenceRefs++;
+    return silenceAudio;
+}
+
+void AudioEngine::releaseSilence()
+{
+    audio_t *closing = nullptr;
+
+    QMutexLocker locker(&mutex);
+    {
+        if (silenceRefs > 0 && --silenceRefs == 0) {
+            closing = silenceAudio;
+            silenceAudio = nullptr;
+        }
+    }
+    locker.unlock();
+
+    if (closing) {
+        audio_output_close(closing);
+        obs_log(LOG_DEBUG, "Audio engine: Silence audio destroyed");
+    }
+}
+
+// Callback from audio_output_open (One thread per mixer pool)
+bool AudioEngine::mixerCallback(
+    void *param, uint64_t startTsIn, uint64_t, uint64_t *outTs, uint32_t mixers, audio_output_data *audioData
+)
+{
+    auto pool = static_cast<AudioMixerPool *>(param);
+
+    // Only conflicts with attach/detach on this pool, which are rare
+    QMutexLocker locker(&pool->mutex);
+    {
+        for (size_t i = 0; i < MAX_AUDIO_MIXES; i++) {
+            if (pool->captures[i]) {
+                // Always pop to drain buffer even if no encoder is connected to the mix
+                pool->captures[i]->popAudio(startTsIn, mixers & (1U << i), audioData);
+            }
+        }
+    }
+    locker.unlock();
+
+    *outTs = startTsIn;
+    return true;
+}
+
+// Callback from audio_output_open
+bool AudioEngine::silenceCallback(void *, uint64_t startTsIn, uint64_t, uint64_t *outTs, uint32_t, audio_output_data *)
+{
+    *outTs = startTsIn;
+    return true;
+}
@@ -0,0 +1,74 @@
+/*
+Branch Output Plugin
+Copyright (C) 2024 OPENSPHERE Inc. info@opensphere.co.jp
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#pragma once
+
+#include <obs-module.h>
+
+#include <QList>
+#include <QMutex>
+
+class AudioCapture;
+
+// Hosts every AudioCapture as a mix of a small number of shared audio_t instances.
+// Each audio_t has MAX_AUDIO_MIXES mixes, so one audio output thread serves up to MAX_AUDIO_MIXES captures.
+// "Silence" tracks share a single global audio_t that never produces samples.
+class AudioEngine {
+    struct AudioMixerPool {
+        audio_t *audio;
+        uint32_t samplesPerSec;
+        speaker_layout speakers;
+        QMutex mutex; // Guards captures against own mixer thread (Pools never wait for each other)
+        AudioCapture *captures[MAX_AUDIO_MIXES];
+        size_t used;
+    };
+
+    QMutex mutex; // Guards pools, used counts and silence audio (Never taken by audio threads)
+    QList<AudioMixerPool *> pools;
+
+    audio_t *silenceAudio;
+    uint32_t silenceSamplesPerSec;
+    speaker_layout silenceSpeakers;
+    size_t silenceRefs;
+
+    static AudioEngine *instance;
+
+    static bool mixerCallback(
+        void *param, uint64_t startTsIn, uint64_t, uint64_t *outTs, uint32_t mixers, audio_output_data *audioData
+    );
+    static bool silenceCallback(
+        void *param, uint64_t startTsIn, uint64_t, uint64_t *outTs, uint32_t mixers, audio_output_data *audioData
+    );
+
+    AudioEngine();
+    ~AudioEngine();
+
+public:
+    static AudioEngine *getInstance();
+    // Call from obs_module_unload()
+    static void destroyInstance();
+
+    // Assign free mix slot to capture. Return nullptr on failure.
+    audio_t *attach(AudioCapture *capture, uint32_t samplesPerSec, speaker_layout speakers, size_t *mixIndex);
+    // After return, capture will never be called back from audio thread.
+    void detach(AudioCapture *capture);
+
+    // Refcounted global silence audio (Use mix index 0)
+    audio_t *acquireSilence(uint32_t samplesPerSec, speaker_layout speakers);
+    void releaseSilence();
+};
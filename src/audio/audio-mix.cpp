@@ -0,0 +1,177 @@
+/*
+Branch Output Plugin
+Copyright (C) 2024 OPENSPHERE Inc. info@opensphere.co.jp
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#include "audio-mix.hpp"
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define MIX_X86_64
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define MIX_AARCH64
+#include <arm_neon.h>
+#endif
+
+// GCC/Clang need per-function target for AVX2 (MSVC accepts intrinsics as-is)
+#if defined(MIX_X86_64) && (defined(__GNUC__) || defined(__clang__))
+#define MIX_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define MIX_TARGET_AVX2
+#endif
+
+void mixAndClampScalar(float *out, const float *in, size_t frames)
+{
+    for (size_t i = 0; i < frames; i++) {
+        *out += *(in++);
+        if (*out != *out) {
+            // NaN becomes silence (Same as vectorized kernels)
+            *out = 0.0f;
+        } else if (*out > 1.0f) {
+            *out = 1.0f;
+        } else if (*out < -1.0f) {
+            *out = -1.0f;
+        }
+        out++;
+    }
+}
+
+#ifdef MIX_X86_64
+// SSE2 is baseline on x86_64
+static void mixAndClampSse2(float *out, const float *in, size_t frames)
+{
+    const auto hi = _mm_set1_ps(1.0f);
+    const auto lo = _mm_set1_ps(-1.0f);
+
+    size_t i = 0;
+    for (; i + 4 <= frames; i += 4) {
+        auto v = _mm_add_ps(_mm_loadu_ps(out + i), _mm_loadu_ps(in + i));
+        // Zero NaN lanes first (MINPS/MAXPS would turn NaN into whichever bound comes second)
+        v = _mm_and_ps(v, _mm_cmpord_ps(v, v));
+        _mm_storeu_ps(out + i, _mm_max_ps(_mm_min_ps(v, hi), lo));
+    }
+
+    mixAndClampScalar(out + i, in + i, frames - i);
+}
+
+MIX_TARGET_AVX2 static void mixAndClampAvx2(float *out, const float *in, size_t frames)
+{
+    const auto hi = _mm256_set1_ps(1.0f);
+    const auto lo = _mm256_set1_ps(-1.0f);
+
+    size_t i = 0;
+    for (; i + 8 <= frames; i += 8) {
+        auto v = _mm256_add_ps(_mm256_loadu_ps(out + i), _mm256_loadu_ps(in + i));
+        v = _mm256_and_ps(v, _mm256_cmp_ps(v, v, _CMP_ORD_Q));
+        _mm256_storeu_ps(out + i, _mm256_max_ps(_mm256_min_ps(v, hi), lo));
+    }
+
+    mixAndClampScalar(out + i, in + i, frames - i);
+}
+
+static bool cpuHasAvx2()
+{
+#ifdef _MSC_VER
+    int info[4] = {0};
+    __cpuid(info, 0);
+    if (info[0] < 7) {
+        return false;
+    }
+
+    // OSXSAVE and AVX, then make sure OS saves YMM registers
+    __cpuid(info, 1);
+    if ((info[2] & (1 << 27)) == 0 || (info[2] & (1 << 28)) == 0) {
+        return false;
+    }
+    if ((_xgetbv(0) & 0x6) != 0x6) {
+        return false;
+    }
+
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+#endif
+
+#ifdef MIX_AARCH64
+// NEON is baseline on aarch64
+static void mixAndClampNeon(float *out, const float *in, size_t frames)
+{
+    const auto hi = vdupq_n_f32(1.0f);
+    const auto lo = vdupq_n_f32(-1.0f);
+
+    size_t i = 0;
+    for (; i + 4 <= frames; i += 4) {
+        auto v = vaddq_f32(vld1q_f32(out + i), vld1q_f32(in + i));
+        // Zero NaN lanes first (FMIN/FMAX propagate NaN)
+        v = vreinterpretq_f32_u32(vandq_u32(vreinterpretq_u32_f32(v), vceqq_f32(v, v)));
+        vst1q_f32(out + i, vmaxq_f32(vminq_f32(v, hi), lo));
+    }
+
+    mixAndClampScalar(out + i, in + i, frames - i);
+}
+#endif
+
+size_t getMixAndClampKernels(MixAndClampKernel kernels[], size_t maxKernels)
+{
+    MixAndClampKernel available[MIX_AND_CLAMP_MAX_KERNELS];
+    size_t count = 0;
+
+#if defined(MIX_X86_64)
+    if (cpuHasAvx2()) {
+        available[count++] = {mixAndClampAvx2, "avx2"};
+    }
+    available[count++] = {mixAndClampSse2, "sse2"};
+#elif defined(MIX_AARCH64)
+    available[count++] = {mixAndClampNeon, "neon"};
+#endif
+    available[count++] = {mixAndClampScalar, "scalar"};
+
+    count = count < maxKernels ? count : maxKernels;
+    for (size_t i = 0; i < count; i++) {
+        kernels[i] = available[i];
+    }
+    return count;
+}
+
+static MixAndClampKernel selectKernel()
+{
+    MixAndClampKernel best = {mixAndClampScalar, "scalar"};
+    getMixAndClampKernels(&best, 1);
+    return best;
+}
+
+static const MixAndClampKernel &getKernel()
+{
+    // Thread-safe initialization (C++11 magic statics)
+    static const MixAndClampKernel kernel = selectKernel();
+    return kernel;
+}
+
+void mixAndClamp(float *out, const float *in, size_t frames)
+{
+    getKernel().func(out, in, frames);
+}
+
+const char *mixAndClampKernelName()
+{
+    return getKernel().name;
+}
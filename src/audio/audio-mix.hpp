@@ -0,0 +1,44 @@
+/*
+Branch Output Plugin
+Copyright (C) 2024 OPENSPHERE Inc. info@opensphere.co.jp
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#pragma once
+
+#include <stddef.h>
+
+// out[i] = clamp(out[i] + in[i], -1.0, 1.0) (NaN becomes 0.0 with any kernel)
+// The best implementation for running CPU (AVX2 / SSE2 / NEON / scalar) is chosen at first call.
+void mixAndClamp(float *out, const float *in, size_t frames);
+
+// Scalar fallback (Also used for the tail of vectorized kernels)
+void mixAndClampScalar(float *out, const float *in, size_t frames);
+
+// Name of the selected kernel (For logging)
+const char *mixAndClampKernelName();
+
+#define MIX_AND_CLAMP_MAX_KERNELS 3
+
+typedef void (*MixAndClampFunc)(float *out, const float *in, size_t frames);
+
+struct MixAndClampKernel {
+    MixAndClampFunc func;
+    const char *name;
+};
+
+// Every kernel the running CPU supports, best first and scalar at last (For tests)
+// Return number of kernels stored into kernels.
+size_t getMixAndClampKernels(MixAndClampKernel kernels[], size_t maxKernels);
@@ -0,0 +1,223 @@
+/*
+Branch Output Plugin
+Copyright (C) 2024 OPENSPHERE Inc. info@opensphere.co.jp
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#include <obs-module.h>
+
+#include <string.h>
+
+#include "audio-ring-buffer.hpp"
+
+//--- AudioRingBuffer class ---//
+
+AudioRingBuffer::AudioRingBuffer(size_t _channels, size_t minCapacity)
+    : channels(_channels < MAX_AV_PLANES ? _channels : MAX_AV_PLANES),
+      capacity(1),
+      mask(0),
+      planes{},
+      writePos(0),
+      blockSeq(0),
+      blockTimestamp(0),
+      blockPos(0),
+      maxBlockFrames(0)
+{
+    // Round up to power of two for cheap wrapping
+    while (capacity < minCapacity) {
+        capacity <<= 1;
+    }
+    mask = capacity - 1;
+
+    for (size_t ch = 0; ch < channels; ch++) {
+        planes[ch] = (float *)bzalloc(capacity * sizeof(float));
+    }
+
+    for (size_t i = 0; i < AUDIO_RING_MAX_READERS; i++) {
+        readers[i].pos = 0;
+        readers[i].claimed = false;
+        readers[i].attached = false;
+        readers[i].flushRequested = false;
+    }
+}
+
+AudioRingBuffer::~AudioRingBuffer()
+{
+    for (size_t ch = 0; ch < channels; ch++) {
+        bfree(planes[ch]);
+    }
+}
+
+int AudioRingBuffer::addReader()
+{
+    for (int i = 0; i < AUDIO_RING_MAX_READERS; i++) {
+        auto expected = false;
+        if (!readers[i].claimed.compare_exchange_strong(expected, true, std::memory_order_acq_rel)) {
+            continue;
+        }
+
+        // Publish position before producer takes this reader into account
+        readers[i].flushRequested.store(false, std::memory_order_relaxed);
+        readers[i].pos.store(writePos.load(std::memory_order_acquire), std::memory_order_relaxed);
+        readers[i].attached.store(true, std::memory_order_release);
+        return i;
+    }
+    return -1;
+}
+
+void AudioRingBuffer::removeReader(int reader)
+{
+    if (reader < 0 || reader >= AUDIO_RING_MAX_READERS) {
+        return;
+    }
+
+    readers[reader].attached.store(false, std::memory_order_release);
+    readers[reader].claimed.store(false, std::memory_order_release);
+}
+
+bool AudioRingBuffer::write(const uint8_t *const data[], size_t frames, uint64_t timestamp)
+{
+    auto wp = writePos.load(std::memory_order_relaxed);
+
+    if (frames > maxBlockFrames.load(std::memory_order_relaxed)) {
+        maxBlockFrames.store(frames, std::memory_order_relaxed);
+    }
+
+    // Space is limited by the slowest reader
+    size_t used = 0;
+    auto attached = false;
+    for (size_t i = 0; i < AUDIO_RING_MAX_READERS; i++) {
+        if (!readers[i].attached.load(std::memory_order_acquire)) {
+            continue;
+        }
+        attached = true;
+
+        auto readerUsed = (size_t)(wp - readers[i].pos.load(std::memory_order_acquire));
+        if (readerUsed > used) {
+            used = readerUsed;
+        }
+    }
+
+    if (!attached) {
+        // Nobody reads -> Skip copying
+        writePos.store(wp + frames, std::memory_order_release);
+        return true;
+    }
+
+    if (capacity - used < frames) {
+        return false;
+    }
+
+    auto offset = (size_t)(wp & mask);
+    auto first = (frames < capacity - offset) ? frames : capacity - offset;
+    auto second = frames - first;
+
+    for (size_t ch = 0; ch < channels; ch++) {
+        auto in = (const float *)data[ch];
+        if (!in) {
+            // Unused channel -> Fill silence
+            memset(planes[ch] + offset, 0, first * sizeof(float));
+            memset(planes[ch], 0, second * sizeof(float));
+            continue;
+        }
+        memcpy(planes[ch] + offset, in, first * sizeof(float));
+        memcpy(planes[ch], in + first, second * sizeof(float));
+    }
+
+    if (timestamp) {
+        // Publish block timestamp (seqlock write side)
+        auto seq = blockSeq.load(std::memory_order_relaxed);
+        blockSeq.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        blockTimestamp.store(timestamp, std::memory_order_relaxed);
+        blockPos.store(wp, std::memory_order_relaxed);
+        blockSeq.store(seq + 2, std::memory_order_release);
+    }
+
+    writePos.store(wp + frames, std::memory_order_release);
+    return true;
+}
+
+void AudioRingBuffer::requestFlush()
+{
+    for (size_t i = 0; i < AUDIO_RING_MAX_READERS; i++) {
+        readers[i].flushRequested.store(true, std::memory_order_release);
+    }
+}
+
+size_t AudioRingBuffer::size(int reader) const
+{
+    auto rp = readers[reader].pos.load(std::memory_order_acquire);
+    auto wp = writePos.load(std::memory_order_acquire);
+    return (size_t)(wp - rp);
+}
+
+size_t AudioRingBuffer::peek(int reader, size_t channel, size_t frames, AudioSpan spans[2]) const
+{
+    auto rp = readers[reader].pos.load(std::memory_order_relaxed);
+    auto offset = (size_t)(rp & mask);
+    auto first = (frames < capacity - offset) ? frames : capacity - offset;
+
+    spans[0] = {planes[channel] + offset, first};
+    if (first == frames) {
+        return 1;
+    }
+
+    spans[1] = {planes[channel], frames - first};
+    return 2;
+}
+
+void AudioRingBuffer::consume(int reader, size_t frames)
+{
+    auto rp = readers[reader].pos.load(std::memory_order_relaxed);
+    readers[reader].pos.store(rp + frames, std::memory_order_release);
+}
+
+bool AudioRingBuffer::handleFlush(int reader)
+{
+    if (!readers[reader].flushRequested.exchange(false, std::memory_order_acq_rel)) {
+        return false;
+    }
+
+    readers[reader].pos.store(writePos.load(std::memory_order_acquire), std::memory_order_release);
+    return true;
+}
+
+bool AudioRingBuffer::getReadTimestamp(int reader, uint32_t samplesPerSec, uint64_t *timestamp) const
+{
+    uint64_t ts = 0;
+    uint64_t pos = 0;
+
+    // seqlock read side (Producer only holds it for a few stores)
+    for (;;) {
+        auto seq1 = blockSeq.load(std::memory_order_acquire);
+        ts = blockTimestamp.load(std::memory_order_relaxed);
+        pos = blockPos.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        auto seq2 = blockSeq.load(std::memory_order_relaxed);
+        if (seq1 == seq2 && !(seq1 & 1)) {
+            break;
+        }
+    }
+
+    if (!ts || !samplesPerSec) {
+        return false;
+    }
+
+    auto rp = readers[reader].pos.load(std::memory_order_relaxed);
+    auto offsetNs = (int64_t)(rp - pos) * 1000000000LL / (int64_t)samplesPerSec;
+    *timestamp = (uint64_t)((int64_t)ts + offsetNs);
+    return true;
+}
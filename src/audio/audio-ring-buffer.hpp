@@ -0,0 +1,97 @@
+/*
+Branch Output Plugin
+Copyright (C) 2024 OPENSPHERE Inc. info@opensphere.co.jp
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#pragma once
+
+#include <obs-module.h>
+
+#include <atomic>
+
+#define AUDIO_RING_MAX_READERS MAX_AUDIO_MIXES
+
+// Contiguous run of frames inside a channel plane
+struct AudioSpan {
+    const float *data;
+    size_t frames;
+};
+
+// Fixed capacity single-producer/multi-consumer ring buffer of planar float audio.
+// Storage is allocated once in the constructor, so neither side blocks nor allocates.
+// Each consumer reads through its own cursor (reader id), so one written block can be fanned out to several tracks.
+// write() must be called from the producer thread only, peek()/consume()/handleFlush() from the reader's thread only.
+// The read offsets are kept outside the sample data, so consumers read planes in place without copying.
+class AudioRingBuffer {
+    struct Reader {
+        std::atomic<uint64_t> pos;
+        std::atomic<bool> claimed;
+        std::atomic<bool> attached;
+        std::atomic<bool> flushRequested;
+    };
+
+    size_t channels;
+    size_t capacity; // Frames per channel (Power of two)
+    size_t mask;
+    float *planes[MAX_AV_PLANES];
+
+    // Monotonic frame counter (Never wraps in practice)
+    std::atomic<uint64_t> writePos;
+    Reader readers[AUDIO_RING_MAX_READERS];
+
+    // Timestamp of the last written block (Guarded by seqlock)
+    std::atomic<uint32_t> blockSeq;
+    std::atomic<uint64_t> blockTimestamp;
+    std::atomic<uint64_t> blockPos;
+    std::atomic<size_t> maxBlockFrames;
+
+public:
+    explicit AudioRingBuffer(size_t _channels, size_t minCapacity);
+    ~AudioRingBuffer();
+
+    AudioRingBuffer(const AudioRingBuffer &) = delete;
+    AudioRingBuffer &operator=(const AudioRingBuffer &) = delete;
+
+    inline size_t getChannels() const { return channels; }
+    inline size_t getCapacity() const { return capacity; }
+
+    // Reader registration (Start reading from current write position)
+    // Return -1 when no more reader can be added
+    int addReader();
+    void removeReader(int reader);
+
+    // Producer side
+    // Return false when there is no space for the slowest reader (Nothing written)
+    // Without any reader, data is discarded immediately.
+    bool write(const uint8_t *const data[], size_t frames, uint64_t timestamp = 0);
+    // Ask every reader to drop all buffered frames
+    void requestFlush();
+
+    // Consumer side
+    size_t size(int reader) const;
+    // Expose frames at reader's position of the channel as one span, or two spans at the wrap point.
+    // Return number of valid spans. frames must not exceed size().
+    size_t peek(int reader, size_t channel, size_t frames, AudioSpan spans[2]) const;
+    // Release frames returned by peek()
+    void consume(int reader, size_t frames);
+    // Apply pending flush request, return true when flushed
+    bool handleFlush(int reader);
+    // Timestamp (ns) of the frame at reader's position, derived from the last written block.
+    // Return false when no block has been written yet.
+    bool getReadTimestamp(int reader, uint32_t samplesPerSec, uint64_t *timestamp) const;
+    // Largest block size written so far
+    inline size_t getMaxBlockFrames() const { return maxBlockFrames.load(std::memory_order_relaxed); }
+};
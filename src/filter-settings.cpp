@@ -0,0 +1,134 @@
+/*
+Branch Output Plugin
+Copyright (C) 2024 OPENSPHERE Inc. info@opensphere.co.jp
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#include <obs-module.h>
+
+#include "filter-settings.hpp"
+#include "indexed-prop-name.hpp"
+
+static obs_scale_type parseScaleType(const char *downscaleFilter)
+{
+    if (!strcmp(downscaleFilter, "bilinear")) {
+        return OBS_SCALE_BILINEAR;
+    } else if (!strcmp(downscaleFilter, "area")) {
+        return OBS_SCALE_AREA;
+    } else if (!strcmp(downscaleFilter, "bicubic")) {
+        return OBS_SCALE_BICUBIC;
+    } else if (!strcmp(downscaleFilter, "lanczos")) {
+        return OBS_SCALE_LANCZOS;
+    }
+    return OBS_SCALE_DISABLE;
+}
+
+//--- FilterSettings struct ---//
+
+QSharedPointer<const FilterSettings> FilterSettings::parse(obs_data_t *settings)
+{
+    QSharedPointer<FilterSettings> parsed(new FilterSettings());
+
+    auto scaleType = parseScaleType(obs_data_get_string(settings, "downscale_filter"));
+
+    auto serviceCount = (size_t)obs_data_get_int(settings, "service_count");
+    parsed->services.resize(serviceCount);
+    for (size_t i = 0; i < serviceCount; i++) {
+        auto service = &parsed->services[i];
+        auto propNameFormat = getIndexedPropNameFormat(i);
+        auto propName = [&](const char *key) {
+            return propNameFormat.arg(key).toUtf8();
+        };
+
+        service->server = obs_data_get_string(settings, propName("server"));
+        service->key = obs_data_get_string(settings, propName("key"));
+        service->useAuth = obs_data_get_bool(settings, propName("use_auth"));
+        service->username = obs_data_get_string(settings, propName("username"));
+        service->password = obs_data_get_string(settings, propName("password"));
+        service->customRendition = obs_data_get_bool(settings, propName("custom_rendition"));
+        service->renditionResolution = {
+            obs_data_get_string(settings, propName("rendition_resolution")),
+            (uint32_t)obs_data_get_int(settings, propName("rendition_custom_width")),
+            (uint32_t)obs_data_get_int(settings, propName("rendition_custom_height")),
+            scaleType,
+        };
+        service->renditionVideoEncoder = obs_data_get_string(settings, propName("rendition_video_encoder"));
+        service->renditionBitrate = obs_data_get_int(settings, propName("rendition_bitrate"));
+    }
+
+    parsed->customAudioSource = obs_data_get_bool(settings, "custom_audio_source");
+    parsed->multitrackAudio = obs_data_get_bool(settings, "multitrack_audio");
+    parsed->audioDriftCompensation = obs_data_get_bool(settings, "audio_drift_compensation");
+    for (size_t i = 0; i < MAX_AUDIO_MIXES; i++) {
+        auto track = &parsed->tracks[i];
+        auto propNameFormat = getIndexedPropNameFormat(i + 1, 1);
+        auto propName = [&](const char *key) {
+            return propNameFormat.arg(key).toUtf8();
+        };
+
+        track->audioSource = obs_data_get_string(settings, propName("audio_source"));
+        track->audioTrack = obs_data_get_int(settings, propName("audio_track"));
+        track->audioDest = obs_data_get_string(settings, propName("audio_dest"));
+        track->streaming = track->audioDest == "streaming" || track->audioDest == "both";
+        track->recording = track->audioDest == "recording" || track->audioDest == "both";
+    }
+    parsed->audioEncoder = obs_data_get_string(settings, "audio_encoder");
+    parsed->audioBitrate = obs_data_get_int(settings, "audio_bitrate");
+
+    parsed->videoEncoder = obs_data_get_string(settings, "video_encoder");
+    parsed->resolution = {
+        obs_data_get_string(settings, "resolution"),
+        (uint32_t)obs_data_get_int(settings, "custom_width"),
+        (uint32_t)obs_data_get_int(settings, "custom_height"),
+        scaleType,
+    };
+    parsed->lockResolution = obs_data_get_bool(settings, "lock_resolution");
+    parsed->mainCanvas = obs_data_get_bool(settings, "main_canvas");
+    parsed->adaptiveBitrate = obs_data_get_bool(settings, "adaptive_bitrate");
+    parsed->adaptiveBitrateMinPercent = (int)obs_data_get_int(settings, "adaptive_bitrate_min_percent");
+    parsed->adaptiveBitratePriority = obs_data_get_string(settings, "adaptive_bitrate_priority");
+
+    parsed->streamRecording = obs_data_get_bool(settings, "stream_recording");
+    parsed->path = obs_data_get_string(settings, "path");
+    parsed->recFormat = obs_data_get_string(settings, "rec_format");
+    parsed->filenameFormatting = obs_data_get_string(settings, "filename_formatting");
+    parsed->splitFile = obs_data_get_string(settings, "split_file");
+    parsed->splitFileTimeMins = obs_data_get_int(settings, "split_file_time_mins");
+    parsed->splitFileSizeMb = obs_data_get_int(settings, "split_file_size_mb");
+    parsed->recSpool = obs_data_get_bool(settings, "rec_spool");
+    parsed->recSpoolPath = obs_data_get_string(settings, "rec_spool_path");
+    parsed->recSpoolLimitMb = (int)obs_data_get_int(settings, "rec_spool_limit_mb");
+
+    parsed->replayBuffer = obs_data_get_bool(settings, "replay_buffer");
+    parsed->replayBufferMaxTimeSec = obs_data_get_int(settings, "replay_buffer_max_time_sec");
+    parsed->replayBufferMaxSizeMb = obs_data_get_int(settings, "replay_buffer_max_size_mb");
+
+    parsed->startPriority = (int)obs_data_get_int(settings, "start_priority");
+    parsed->warmStandby = obs_data_get_bool(settings, "warm_standby");
+    parsed->warmStandbyEncoders = obs_data_get_bool(settings, "warm_standby_encoders");
+
+    return parsed;
+}
+
+int FilterSettings::countEnabledServices() const
+{
+    int count = 0;
+    foreach (auto &service, services) {
+        if (service.isEnabled()) {
+            count++;
+        }
+    }
+    return count;
+}
@@ -0,0 +1,101 @@
+/*
+Branch Output Plugin
+Copyright (C) 2024 OPENSPHERE Inc. info@opensphere.co.jp
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#pragma once
+
+#include <obs-module.h>
+
+#include <QString>
+#include <QList>
+#include <QSharedPointer>
+
+// Output size rule ("resolution" property) and scaling
+struct FilterResolutionSettings {
+    QString resolution; // "" (Source), "output", "canvas", "three_quarters", "half", "quarter" or "custom"
+    uint32_t customWidth;
+    uint32_t customHeight;
+    obs_scale_type scaleType; // OBS_SCALE_DISABLE means "Use global settings"
+};
+
+struct FilterServiceSettings {
+    QString server;
+    QString key;
+    bool useAuth;
+    QString username;
+    QString password;
+    bool customRendition;
+    FilterResolutionSettings renditionResolution;
+    QString renditionVideoEncoder; // Empty means same as "video_encoder"
+    int64_t renditionBitrate;
+
+    inline bool isEnabled() const { return !server.isEmpty(); }
+};
+
+struct FilterTrackSettings {
+    QString audioSource; // "disabled", "no_audio", "master_track", "filter" or source UUID
+    int64_t audioTrack;  // Master track No. (1 origin)
+    QString audioDest;
+    bool streaming;
+    bool recording;
+};
+
+// Typed snapshot of filter settings without indexed property name lookups.
+// Parsed once per settings revision and never modified after that (Shared between UI and worker threads).
+struct FilterSettings {
+    QList<FilterServiceSettings> services; // As many as "service_count"
+
+    bool customAudioSource;
+    bool multitrackAudio;
+    bool audioDriftCompensation;
+    FilterTrackSettings tracks[MAX_AUDIO_MIXES];
+    QString audioEncoder;
+    int64_t audioBitrate;
+
+    QString videoEncoder;
+    FilterResolutionSettings resolution;
+    bool lockResolution;
+    bool mainCanvas; // Copy main canvas instead of rendering parent while it's on program
+    bool adaptiveBitrate;
+    int adaptiveBitrateMinPercent;
+    QString adaptiveBitratePriority; // "recording" or "streaming" (Which wins on the encoder shared by both)
+
+    bool streamRecording;
+    QString path;
+    QString recFormat;
+    QString filenameFormatting;
+    QString splitFile; // Empty, "by_time" or "by_size"
+    int64_t splitFileTimeMins;
+    int64_t splitFileSizeMb;
+    bool recSpool;        // Write into recSpoolPath, then move to path (See RecordingSpooler)
+    QString recSpoolPath; // Local staging directory
+    int recSpoolLimitMb;
+
+    bool replayBuffer;
+    int64_t replayBufferMaxTimeSec;
+    int64_t replayBufferMaxSizeMb;
+
+    int startPriority;
+    bool warmStandby;
+    bool warmStandbyEncoders;
+
+    static QSharedPointer<const FilterSettings> parse(obs_data_t *settings);
+
+    int countEnabledServices() const;
+    // Something to output (Otherwise the filter stays idle)
+    inline bool hasOutputs() const { return countEnabledServices() > 0 || streamRecording || replayBuffer; }
+};
@@ -0,0 +1,46 @@
+/*
+Branch Output Plugin
+Copyright (C) 2024 OPENSPHERE Inc. info@opensphere.co.jp
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#pragma once
+
+#include <QString>
+
+// Property names of repeated settings (e.g. "server", "server_1", "server_2"...)
+// Index equal to base has no suffix.
+inline QString getIndexedPropNameFormat(size_t index, size_t base = 0)
+{
+    return index == base ? QString("%1") : QString("%%1_%1").arg(index);
+}
+
+// Reverse of getIndexedPropNameFormat() (e.g. "server_3" -> 3, "server" -> base)
+inline bool parseIndexedPropName(const QString &propName, const char *name, size_t *index, size_t base = 0)
+{
+    if (propName == name) {
+        *index = base;
+        return true;
+    }
+
+    auto prefix = QString("%1_").arg(name);
+    if (!propName.startsWith(prefix)) {
+        return false;
+    }
+
+    auto ok = false;
+    *index = (size_t)propName.mid(prefix.length()).toULongLong(&ok);
+    return ok;
+}
@@ -0,0 +1,419 @@
+/*
+Branch Output Plugin
+Copyright (C) 2024 OPENSPHERE Inc. info@opensphere.co.jp
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#include <obs-module.h>
+#include <obs.hpp>
+#include <media-io/video-io.h>
+
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QTimer>
+
+#include "metrics-exporter.hpp"
+#include "plugin-main.hpp"
+#include "plugin-support.h"
+
+MetricsExporter *MetricsExporter::instance = nullptr;
+
+// Prometheus label value escaping
+static QString escapeLabel(const QString &value)
+{
+    auto escaped = value;
+    escaped.replace("\\", "\\\\").replace("\"", "\\\"").replace("\n", "\\n");
+    return escaped;
+}
+
+//--- MetricsExporter class ---//
+
+MetricsExporter::MetricsExporter(QObject *parent) : QObject(parent), server(nullptr), port(0), remoteAccess(false) {}
+
+MetricsExporter::~MetricsExporter()
+{
+    setPort(0);
+}
+
+void MetricsExporter::createInstance()
+{
+    if (!instance) {
+        instance = new MetricsExporter();
+    }
+}
+
+void MetricsExporter::destroyInstance()
+{
+    delete instance;
+    instance = nullptr;
+}
+
+void MetricsExporter::setPort(int _port)
+{
+    if (_port == port && (server || !_port)) {
+        return;
+    }
+    port = _port;
+    listen();
+}
+
+void MetricsExporter::setRemoteAccess(bool enabled)
+{
+    if (enabled == remoteAccess) {
+        return;
+    }
+    remoteAccess = enabled;
+    listen();
+}
+
+void MetricsExporter::listen()
+{
+    if (server) {
+        server->close();
+        delete server;
+        server = nullptr;
+        obs_log(LOG_INFO, "Metrics exporter stopped");
+    }
+
+    if (!port) {
+        return;
+    }
+
+    server = new QTcpServer(this);
+    connect(server, &QTcpServer::newConnection, this, &MetricsExporter::onNewConnection);
+
+    if (!server->listen(remoteAccess ? QHostAddress::Any : QHostAddress::LocalHost, (quint16)port)) {
+        obs_log(
+            LOG_ERROR, "Metrics exporter failed to listen on port %d (%s)", port,
+            qUtf8Printable(server->errorString())
+        );
+        delete server;
+        server = nullptr;
+        return;
+    }
+
+    obs_log(LOG_INFO, "Metrics exporter listening on port %d (%s)", port, remoteAccess ? "any host" : "localhost");
+}
+
+void MetricsExporter::addFilter(BranchOutputFilter *filter)
+{
+    if (!filters.contains(filter)) {
+        filters.append(filter);
+    }
+}
+
+void MetricsExporter::removeFilter(BranchOutputFilter *filter)
+{
+    filters.removeAll(filter);
+    lastMetrics.remove(filter);
+}
+
+// Same rule as status dock: Never block UI thread, outputs are untouchable while starting
+bool MetricsExporter::sampleFilter(BranchOutputFilter *filter, FilterMetrics *metrics)
+{
+    if (filter->starting || pthread_mutex_trylock(&filter->outputMutex)) {
+        return false;
+    }
+    OBSMutexAutoUnlock locked(&filter->outputMutex);
+
+    auto parent = obs_filter_get_parent(filter->filterSource);
+    metrics->name = filter->name;
+    metrics->sourceName = parent ? obs_source_get_name(parent) : "";
+    metrics->startOutputSeconds = (double)filter->startOutputDurationNs / 1000000000.0;
+    metrics->stopOutputSeconds = (double)filter->stopOutputDurationNs / 1000000000.0;
+    metrics->audioTracks.clear();
+    metrics->outputs.clear();
+
+    for (size_t i = 0; i < MAX_AUDIO_MIXES; i++) {
+        auto capture = filter->audios[i].capture;
+        if (!capture) {
+            continue;
+        }
+
+        AudioTrackMetrics track = {0};
+        track.track = i + 1;
+        track.bufferedFrames = capture->getBufferedFrames();
+        track.overflowFlushes = capture->getOverflowFlushes();
+        track.underruns = capture->getUnderruns();
+        metrics->audioTracks.append(track);
+    }
+
+    QMutexLocker metricsLocker(&filter->metricsMutex);
+
+    auto addOutput = [&](const QString &outputName, obs_output_t *output, bool alive, bool streaming) {
+        if (!output) {
+            return;
+        }
+
+        OutputMetrics om;
+        om.output = outputName;
+        om.active = alive && obs_output_active(output);
+        om.reconnecting = streaming && alive && (!obs_output_active(output) || obs_output_reconnecting(output));
+        om.congestion = streaming ? obs_output_get_congestion(output) : 0.0f;
+        om.totalBytes = obs_output_get_total_bytes(output);
+        om.totalFrames = obs_output_get_total_frames(output);
+        om.droppedFrames = obs_output_get_frames_dropped(output);
+        om.connectTimeMs = streaming ? obs_output_get_connect_time_ms(output) : 0;
+        om.reconnects = filter->reconnectCounts.value(output);
+
+        // Frames skipped by the video output mean the encoder can't take them in time
+        auto encoder = obs_output_get_video_encoder(output);
+        auto video = encoder ? obs_encoder_video(encoder) : nullptr;
+        om.videoFrames = video ? video_output_get_total_frames(video) : 0;
+        om.videoSkippedFrames = video ? video_output_get_skipped_frames(video) : 0;
+
+        metrics->outputs.append(om);
+    };
+
+    addOutput("recording", filter->recordingOutput, filter->recordingActive, false);
+    addOutput("replay_buffer", filter->replayBufferOutput, filter->replayBufferActive, false);
+    for (size_t i = 0; i < filter->streamings.size(); i++) {
+        addOutput(
+            QString("streaming_%1").arg(i + 1), filter->streamings[i].output, filter->streamings[i].active, true
+        );
+    }
+
+    return true;
+}
+
+QList<MetricsExporter::FilterMetrics> MetricsExporter::sampleAll()
+{
+    QList<FilterMetrics> metrics;
+    foreach (auto filter, filters) {
+        auto &last = lastMetrics[filter];
+        sampleFilter(filter, &last);
+        if (!last.name.isEmpty()) {
+            metrics.append(last);
+        }
+    }
+    return metrics;
+}
+
+QByteArray MetricsExporter::renderPrometheus(const QList<FilterMetrics> &metrics)
+{
+    QString text;
+
+    auto family = [&](const char *name, const char *type, const char *help) {
+        text += QString("# HELP %1 %2\n# TYPE %1 %3\n").arg(name).arg(help).arg(type);
+    };
+    auto filterLabels = [](const FilterMetrics &fm) {
+        // Single pass arg() (Names may contain "%1")
+        return QString("filter=\"%1\",source=\"%2\"").arg(escapeLabel(fm.name), escapeLabel(fm.sourceName));
+    };
+
+    auto filterSample = [&](const char *name, const char *type, const char *help, auto value) {
+        family(name, type, help);
+        foreach (auto &fm, metrics) {
+            text += QString("%1{%2} %3\n").arg(name, filterLabels(fm), QString::number(value(fm)));
+        }
+    };
+    auto trackSample = [&](const char *name, const char *type, const char *help, auto value) {
+        family(name, type, help);
+        foreach (auto &fm, metrics) {
+            foreach (auto &tm, fm.audioTracks) {
+                text += QString("%1{%2,track=\"%3\"} %4\n")
+                            .arg(name, filterLabels(fm), QString::number(tm.track), QString::number(value(tm)));
+            }
+        }
+    };
+    auto outputSample = [&](const char *name, const char *type, const char *help, auto value) {
+        family(name, type, help);
+        foreach (auto &fm, metrics) {
+            foreach (auto &om, fm.outputs) {
+                text += QString("%1{%2,output=\"%3\"} %4\n")
+                            .arg(name, filterLabels(fm), om.output, QString::number(value(om)));
+            }
+        }
+    };
+
+    filterSample(
+        "branch_output_start_output_seconds", "gauge", "Duration of the last output startup.",
+        [](const FilterMetrics &fm) { return fm.startOutputSeconds; }
+    );
+    filterSample(
+        "branch_output_stop_output_seconds", "gauge", "Duration of the last output shutdown.",
+        [](const FilterMetrics &fm) { return fm.stopOutputSeconds; }
+    );
+
+    trackSample(
+        "branch_output_audio_buffered_frames", "gauge", "Audio frames buffered for the track.",
+        [](const AudioTrackMetrics &tm) { return tm.bufferedFrames; }
+    );
+    trackSample(
+        "branch_output_audio_overflow_flushes_total", "counter", "Audio buffer flushes by overflow.",
+        [](const AudioTrackMetrics &tm) { return tm.overflowFlushes; }
+    );
+    trackSample(
+        "branch_output_audio_underruns_total", "counter", "Audio pops without enough buffered frames.",
+        [](const AudioTrackMetrics &tm) { return tm.underruns; }
+    );
+
+    outputSample(
+        "branch_output_active", "gauge", "Output is active.",
+        [](const OutputMetrics &om) { return om.active ? 1 : 0; }
+    );
+    outputSample(
+        "branch_output_reconnecting", "gauge", "Stream is reconnecting.",
+        [](const OutputMetrics &om) { return om.reconnecting ? 1 : 0; }
+    );
+    outputSample(
+        "branch_output_congestion", "gauge", "Stream congestion (0 to 1).",
+        [](const OutputMetrics &om) { return om.congestion; }
+    );
+    outputSample(
+        "branch_output_bytes_total", "counter", "Bytes written by the output.",
+        [](const OutputMetrics &om) { return om.totalBytes; }
+    );
+    outputSample(
+        "branch_output_frames_total", "counter", "Video frames output.",
+        [](const OutputMetrics &om) { return om.totalFrames; }
+    );
+    outputSample(
+        "branch_output_dropped_frames_total", "counter", "Video frames dropped by the output.",
+        [](const OutputMetrics &om) { return om.droppedFrames; }
+    );
+    outputSample(
+        "branch_output_connect_time_ms", "gauge", "Time taken to connect the stream.",
+        [](const OutputMetrics &om) { return om.connectTimeMs; }
+    );
+    outputSample(
+        "branch_output_reconnects_total", "counter", "Reconnect attempts of the stream.",
+        [](const OutputMetrics &om) { return om.reconnects; }
+    );
+    outputSample(
+        "branch_output_video_frames_total", "counter", "Raw video frames of the video output feeding the encoder.",
+        [](const OutputMetrics &om) { return om.videoFrames; }
+    );
+    outputSample(
+        "branch_output_video_skipped_frames_total", "counter", "Raw video frames skipped by the video output.",
+        [](const OutputMetrics &om) { return om.videoSkippedFrames; }
+    );
+
+    // Global to obs (Main canvas and every view are rendered in the same graphics thread)
+    family("obs_render_frames_total", "counter", "Frames rendered by obs graphics thread.");
+    text += QString("obs_render_frames_total %1\n").arg(obs_get_total_frames());
+    family("obs_render_lagged_frames_total", "counter", "Frames missed by obs graphics thread.");
+    text += QString("obs_render_lagged_frames_total %1\n").arg(obs_get_lagged_frames());
+
+    return text.toUtf8();
+}
+
+QByteArray MetricsExporter::renderJson(const QList<FilterMetrics> &metrics)
+{
+    QJsonArray filterArray;
+    foreach (auto &fm, metrics) {
+        QJsonArray trackArray;
+        foreach (auto &tm, fm.audioTracks) {
+            QJsonObject track;
+            track["track"] = (qint64)tm.track;
+            track["bufferedFrames"] = (qint64)tm.bufferedFrames;
+            track["overflowFlushes"] = (qint64)tm.overflowFlushes;
+            track["underruns"] = (qint64)tm.underruns;
+            trackArray.append(track);
+        }
+
+        QJsonArray outputArray;
+        foreach (auto &om, fm.outputs) {
+            QJsonObject output;
+            output["output"] = om.output;
+            output["active"] = om.active;
+            output["reconnecting"] = om.reconnecting;
+            output["congestion"] = om.congestion;
+            output["totalBytes"] = (qint64)om.totalBytes;
+            output["totalFrames"] = om.totalFrames;
+            output["droppedFrames"] = om.droppedFrames;
+            output["connectTimeMs"] = om.connectTimeMs;
+            output["reconnects"] = (qint64)om.reconnects;
+            output["videoFrames"] = (qint64)om.videoFrames;
+            output["videoSkippedFrames"] = (qint64)om.videoSkippedFrames;
+            outputArray.append(output);
+        }
+
+        QJsonObject filter;
+        filter["name"] = fm.name;
+        filter["source"] = fm.sourceName;
+        filter["startOutputSeconds"] = fm.startOutputSeconds;
+        filter["stopOutputSeconds"] = fm.stopOutputSeconds;
+        filter["audioTracks"] = trackArray;
+        filter["outputs"] = outputArray;
+        filterArray.append(filter);
+    }
+
+    // Global to obs, not per filter
+    QJsonObject global;
+    global["renderFrames"] = (qint64)obs_get_total_frames();
+    global["renderLaggedFrames"] = (qint64)obs_get_lagged_frames();
+
+    QJsonObject root;
+    root["filters"] = filterArray;
+    root["global"] = global;
+    return QJsonDocument(root).toJson(QJsonDocument::Compact);
+}
+
+void MetricsExporter::onNewConnection()
+{
+    while (server->hasPendingConnections()) {
+        auto socket = server->nextPendingConnection();
+        connect(socket, &QTcpSocket::disconnected, socket, &QObject::deleteLater);
+        connect(socket, &QTcpSocket::readyRead, this, [this, socket]() { handleRequest(socket); });
+        // Don't keep idle clients
+        QTimer::singleShot(METRICS_REQUEST_TIMEOUT_MS, socket, [socket]() { socket->abort(); });
+    }
+}
+
+void MetricsExporter::handleRequest(QTcpSocket *socket)
+{
+    // Wait for whole header (Closing with unread data resets the connection)
+    auto request = socket->property("request").toByteArray() + socket->readAll();
+    if (request.size() > METRICS_MAX_REQUEST_SIZE) {
+        respond(socket, "431 Request Header Fields Too Large", "text/plain", "");
+        return;
+    }
+    if (!request.contains("\r\n\r\n")) {
+        socket->setProperty("request", request);
+        return;
+    }
+
+    auto requestLine = request.left(request.indexOf("\r\n")).split(' ');
+    if (requestLine.size() < 2 || requestLine[0] != "GET") {
+        respond(socket, "405 Method Not Allowed", "text/plain", "");
+        return;
+    }
+
+    auto path = requestLine[1].split('?').first();
+    if (path == "/metrics") {
+        respond(socket, "200 OK", "text/plain; version=0.0.4; charset=utf-8", renderPrometheus(sampleAll()));
+    } else if (path == "/metrics.json") {
+        respond(socket, "200 OK", "application/json", renderJson(sampleAll()));
+    } else {
+        respond(socket, "404 Not Found", "text/plain", "");
+    }
+}
+
+void MetricsExporter::respond(QTcpSocket *socket, const char *status, const char *contentType, const QByteArray &body)
+{
+    auto header = QString("HTTP/1.1 %1\r\nContent-Type: %2\r\nContent-Length: %3\r\nConnection: close\r\n\r\n")
+                      .arg(status)
+                      .arg(contentType)
+                      .arg(body.size());
+    // One request per connection
+    QObject::disconnect(socket, &QTcpSocket::readyRead, nullptr, nullptr);
+    socket->write(header.toUtf8());
+    socket->write(body);
+    socket->disconnectFromHost();
+}
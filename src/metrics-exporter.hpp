@@ -0,0 +1,115 @@
+/*
+Branch Output Plugin
+Copyright (C) 2024 OPENSPHERE Inc. info@opensphere.co.jp
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#pragma once
+
+#include <obs-module.h>
+
+#include <QByteArray>
+#include <QHash>
+#include <QList>
+#include <QObject>
+#include <QString>
+
+#define METRICS_MAX_REQUEST_SIZE 8192
+#define METRICS_REQUEST_TIMEOUT_MS 5000
+
+class QTcpServer;
+class QTcpSocket;
+class BranchOutputFilter;
+
+// Serves metrics of every filter over HTTP for headless monitoring (Independent of status dock visibility).
+// "/metrics" is Prometheus text format and "/metrics.json" is the same values as JSON.
+// Filters are sampled on each request in UI thread, so nothing is computed when nobody scrapes.
+class MetricsExporter : public QObject {
+    Q_OBJECT
+
+public:
+    struct AudioTrackMetrics {
+        size_t track;
+        uint64_t bufferedFrames;
+        uint64_t overflowFlushes;
+        uint64_t underruns;
+    };
+
+    struct OutputMetrics {
+        QString output; // "recording", "replay_buffer" or "streaming_N"
+        bool active;
+        bool reconnecting;
+        float congestion;
+        uint64_t totalBytes;
+        int totalFrames;
+        int droppedFrames;
+        int connectTimeMs;
+        uint64_t reconnects;
+        uint32_t videoFrames;        // Raw frames of the video output feeding the encoder
+        uint32_t videoSkippedFrames; // Raw frames the encoder couldn't take in time
+    };
+
+    struct FilterMetrics {
+        QString name;
+        QString sourceName;
+        double startOutputSeconds;
+        double stopOutputSeconds;
+        QList<AudioTrackMetrics> audioTracks;
+        QList<OutputMetrics> outputs;
+    };
+
+private:
+    QTcpServer *server;
+    int port;
+    bool remoteAccess; // Listen on every interface instead of loopback only
+    QList<BranchOutputFilter *> filters;
+    // Last successful samples (Reused while filter is busy with its outputs)
+    QHash<BranchOutputFilter *, FilterMetrics> lastMetrics;
+
+    static MetricsExporter *instance;
+
+    QList<FilterMetrics> sampleAll();
+    QByteArray renderPrometheus(const QList<FilterMetrics> &metrics);
+    QByteArray renderJson(const QList<FilterMetrics> &metrics);
+    void listen();
+    void handleRequest(QTcpSocket *socket);
+    static void respond(QTcpSocket *socket, const char *status, const char *contentType, const QByteArray &body);
+
+    explicit MetricsExporter(QObject *parent = nullptr);
+    ~MetricsExporter();
+
+private slots:
+    void onNewConnection();
+
+public:
+    // Return nullptr until createInstance()
+    static inline MetricsExporter *getInstance() { return instance; }
+    // Call from obs_module_post_load() (Lives in UI thread)
+    static void createInstance();
+    // Call from obs_module_unload()
+    static void destroyInstance();
+
+    // 0 stops listening
+    void setPort(int port);
+    // Loopback only by default (Metrics contain source and filter names, and there's no authentication)
+    void setRemoteAccess(bool enabled);
+
+    // Snapshot of filter's outputs (Call from UI thread, return false while outputs are busy)
+    static bool sampleFilter(BranchOutputFilter *filter, FilterMetrics *metrics);
+
+public slots:
+    void addFilter(BranchOutputFilter *filter);
+    void removeFilter(BranchOutputFilter *filter);
+};
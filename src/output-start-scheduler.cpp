@@ -0,0 +1,159 @@
+/*
+Branch Output Plugin
+Copyright (C) 2024 OPENSPHERE Inc. info@opensphere.co.jp
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#include <obs-module.h>
+#include <util/platform.h>
+
+#include <QTimer>
+
+#include "output-start-scheduler.hpp"
+#include "plugin-support.h"
+
+#define MAX_CONCURRENT_STARTS 16
+
+OutputStartScheduler *OutputStartScheduler::instance = nullptr;
+
+//--- OutputStartScheduler class ---//
+
+OutputStartScheduler::OutputStartScheduler(QObject *parent)
+    : QObject(parent),
+      spacingTimer(new QTimer(this)),
+      maxConcurrent(DEFAULT_MAX_CONCURRENT_STARTS),
+      intervalMs(DEFAULT_START_INTERVAL_MS),
+      lastStartedAt(0)
+{
+    pool.setMaxThreadCount(MAX_CONCURRENT_STARTS);
+
+    spacingTimer->setSingleShot(true);
+    connect(spacingTimer, &QTimer::timeout, this, &OutputStartScheduler::dispatch);
+}
+
+OutputStartScheduler::~OutputStartScheduler()
+{
+    QMutexLocker locker(&mutex);
+    queue.clear();
+    locker.unlock();
+
+    pool.waitForDone();
+}
+
+OutputStartScheduler *OutputStartScheduler::getInstance()
+{
+    // First call is made in obs_module_load() (Lives in UI thread)
+    if (!instance) {
+        instance = new OutputStartScheduler();
+    }
+    return instance;
+}
+
+void OutputStartScheduler::destroyInstance()
+{
+    delete instance;
+    instance = nullptr;
+}
+
+void OutputStartScheduler::setMaxConcurrent(int value)
+{
+    QMutexLocker locker(&mutex);
+    maxConcurrent = value < 1 ? 1 : value > MAX_CONCURRENT_STARTS ? MAX_CONCURRENT_STARTS : value;
+    locker.unlock();
+
+    QMetaObject::invokeMethod(this, "dispatch", Qt::QueuedConnection);
+}
+
+void OutputStartScheduler::setIntervalMs(int value)
+{
+    QMutexLocker locker(&mutex);
+    intervalMs = value < 0 ? 0 : value;
+}
+
+void OutputStartScheduler::schedule(void *owner, int priority, std::function<void()> run)
+{
+    QMutexLocker locker(&mutex);
+    queue.push_back({owner, priority, run});
+    obs_log(LOG_DEBUG, "Start scheduler: Job queued (priority=%d, queued=%lld)", priority, (long long)queue.size());
+    locker.unlock();
+
+    QMetaObject::invokeMethod(this, "dispatch", Qt::QueuedConnection);
+}
+
+bool OutputStartScheduler::cancel(void *owner)
+{
+    QMutexLocker locker(&mutex);
+
+    auto dropped = false;
+    for (auto i = queue.size() - 1; i >= 0; i--) {
+        if (queue[i].owner == owner) {
+            queue.removeAt(i);
+            dropped = true;
+        }
+    }
+
+    while (runningOwners.contains(owner)) {
+        jobFinished.wait(&mutex);
+    }
+
+    return dropped;
+}
+
+// Always called in UI thread
+void OutputStartScheduler::dispatch()
+{
+    QMutexLocker locker(&mutex);
+
+    while (!queue.isEmpty() && runningOwners.size() < maxConcurrent) {
+        auto now = os_gettime_ns();
+        auto readyAt = lastStartedAt + (uint64_t)intervalMs * 1000000ULL;
+        if (lastStartedAt && now < readyAt) {
+            // Keep spacing between starts (Dispatches within the interval share one pending timer)
+            if (!spacingTimer->isActive()) {
+                spacingTimer->start((int)((readyAt - now) / 1000000ULL) + 1);
+            }
+            return;
+        }
+
+        // Highest priority first (The earliest one wins on the same priority)
+        qsizetype next = 0;
+        for (qsizetype i = 1; i < queue.size(); i++) {
+            if (queue[i].priority > queue[next].priority) {
+                next = i;
+            }
+        }
+
+        auto job = queue.takeAt(next);
+        runningOwners.push_back(job.owner);
+        lastStartedAt = now;
+
+        obs_log(
+            LOG_DEBUG, "Start scheduler: Job started (priority=%d, running=%lld, queued=%lld)", job.priority,
+            (long long)runningOwners.size(), (long long)queue.size()
+        );
+
+        pool.start([this, job]() {
+            job.run();
+
+            QMutexLocker _locker(&mutex);
+            runningOwners.removeOne(job.owner);
+            jobFinished.wakeAll();
+            _locker.unlock();
+
+            // Next job
+            QMetaObject::invokeMethod(this, "dispatch", Qt::QueuedConnection);
+        });
+    }
+}
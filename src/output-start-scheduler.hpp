@@ -0,0 +1,78 @@
+/*
+Branch Output Plugin
+Copyright (C) 2024 OPENSPHERE Inc. info@opensphere.co.jp
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#pragma once
+
+#include <QObject>
+#include <QList>
+#include <QMutex>
+#include <QThreadPool>
+#include <QWaitCondition>
+
+#include <functional>
+
+class QTimer;
+
+#define DEFAULT_MAX_CONCURRENT_STARTS 2
+#define DEFAULT_START_INTERVAL_MS 500
+
+// Global queue of output startups, so that an interlock firing for many filters at once
+// doesn't initialize every encoder and connect to every ingest in the same moment.
+// Jobs run in worker threads, highest priority first, limited in concurrency and spaced by an interval.
+class OutputStartScheduler : public QObject {
+    Q_OBJECT
+
+    struct StartJob {
+        void *owner;
+        int priority;
+        std::function<void()> run;
+    };
+
+    QMutex mutex;
+    QWaitCondition jobFinished;
+    QList<StartJob> queue;       // FIFO within the same priority
+    QList<void *> runningOwners; // One entry per running job
+    QThreadPool pool;
+    QTimer *spacingTimer; // Single pending dispatch while waiting for the interval
+    int maxConcurrent;
+    int intervalMs;
+    uint64_t lastStartedAt;
+
+    static OutputStartScheduler *instance;
+
+    explicit OutputStartScheduler(QObject *parent = nullptr);
+    ~OutputStartScheduler();
+
+private slots:
+    void dispatch();
+
+public:
+    static OutputStartScheduler *getInstance();
+    // Call from obs_module_unload()
+    static void destroyInstance();
+
+    void setMaxConcurrent(int value);
+    void setIntervalMs(int value);
+
+    // Higher priority starts earlier
+    void schedule(void *owner, int priority, std::function<void()> run);
+    // Drop queued jobs of the owner and wait for its running job. Return true when a queued job was dropped.
+    // Blocks the caller while the owner's job is running (Owner's resources must outlive it), so call it only
+    // from threads the jobs never wait for: UI thread or the owner's destroy callback.
+    bool cancel(void *owner);
+};
@@ -24,24 +24,82 @@ with this program. If not, see <https://www.gnu.org/licenses/>
 #include <util/platform.h>
 #include <obs.hpp>
 
+#include <QSet>
+
 #include "audio/audio-capture.hpp"
+#include "audio/audio-engine.hpp"
+#include "audio/audio-mix.hpp"
+#include "video/main-canvas-mirror.hpp"
+#include "video/video-engine.hpp"
 #include "plugin-support.h"
 #include "plugin-main.hpp"
+#include "metrics-exporter.hpp"
+#include "output-start-scheduler.hpp"
+#include "reconnect-coordinator.hpp"
+#include "recording-spooler.hpp"
+#include "settings-file-writer.hpp"
+#include "source-membership.hpp"
+#include "streaming-supervisor.hpp"
+#include "trace.hpp"
 #include "utils.hpp"
 
 #define SETTINGS_JSON_NAME "recently.json"
 #define FILTER_ID "osi_branch_output"
 #define OUTPUT_MAX_RETRIES 7
 #define OUTPUT_RETRY_DELAY_SECS 1
-#define CONNECT_ATTEMPTING_TIMEOUT_NS 15000000000ULL
 #define AVAILAVILITY_CHECK_INTERVAL_NS 1000000000ULL
-#define TASK_INTERVAL_MS 1000
+#define RESIZE_SETTLE_MS 2000 // Source size must be stable for this duration before outputs follow it
+#define TASK_INTERVAL_MS 5000 // Fallback polling (Output/source signals trigger supervision immediately)
 
 OBS_DECLARE_MODULE()
 OBS_MODULE_USE_DEFAULT_LOCALE(PLUGIN_NAME, "en-US")
 
 BranchOutputStatusDock *statusDock = nullptr;
 
+// Settings which only affect one streaming (Indexed by getIndexedPropNameFormat())
+static const char *streamingSettingNames[] = {
+    "server",
+    "key",
+    "use_auth",
+    "username",
+    "password",
+    "custom_rendition",
+    "rendition_resolution",
+    "rendition_custom_width",
+    "rendition_custom_height",
+    "rendition_video_encoder",
+    "rendition_bitrate",
+};
+
+// Settings which only affect recording
+static const char *recordingSettingNames[] = {
+    "stream_recording",
+    "path",
+    "rec_format",
+    "filename_formatting",
+    "split_file",
+    "split_file_time_mins",
+    "split_file_size_mb",
+    "rec_spool",
+    "rec_spool_path",
+    "rec_spool_limit_mb",
+};
+
+// Settings which only affect replay buffer
+static const char *replayBufferSettingNames[] = {
+    "replay_buffer",
+    "replay_buffer_max_time_sec",
+    "replay_buffer_max_size_mb",
+};
+
+// Settings which don't affect running outputs by themselves
+static const char *passiveSettingNames[] = {
+    "service_count",
+    "start_priority",
+    "warm_standby",
+    "warm_standby_encoders",
+};
+
 //--- BranchOutputFilter class ---//
 
 BranchOutputFilter::BranchOutputFilter(obs_data_t *settings, obs_source_t *source, QObject *parent)
@@ -50,26 +108,37 @@ BranchOutputFilter::BranchOutputFilter(obs_data_t *settings, obs_source_t *sourc
       filterSource(source),
       initialized(false),
       recordingActive(false),
+      replayBufferActive(false),
       storedSettingsRev(0),
       activeSettingsRev(0),
+      parsedSettingsRev(0),
       intervalTimer(nullptr),
+      bitrateTimer(nullptr),
+      supervisePending(false),
+      reconnectWakeAt(0),
+      starting(false),
+      standby(false),
+      standbyEncodersIdle(false),
+      standbyAttemptedAt(0),
       recordingOutput(nullptr),
       videoEncoder(nullptr),
-      videoOutput(nullptr),
-      view(nullptr),
+      videoEncoderFallback(false),
       width(0),
       height(0),
-      hotkeyPairId(OBS_INVALID_HOTKEY_PAIR_ID)
+      letterbox(false),
+      mainCanvas(false),
+      resizedWidth(0),
+      resizedHeight(0),
+      resizedAt(0),
+      startOutputDurationNs(0),
+      stopOutputDurationNs(0),
+      hotkeyPairId(OBS_INVALID_HOTKEY_PAIR_ID),
+      saveReplayHotkeyId(OBS_INVALID_HOTKEY_ID)
 {
     // DO NOT use obs_filter_get_parent() in this function (It'll return nullptr)
     obs_log(LOG_DEBUG, "%s: BranchOutputFilter creating", qUtf8Printable(name));
     obs_log(LOG_DEBUG, "filter_settings_json=%s", obs_data_get_json(settings));
 
-    // Do not use memset
-    for (size_t i = 0; i < MAX_SERVICES; i++) {
-        streamings[i] = {0};
-    }
-
     // Do not use memset
     for (size_t i = 0; i < MAX_AUDIO_MIXES; i++) {
         audios[i] = {0};
@@ -77,6 +146,13 @@ BranchOutputFilter::BranchOutputFilter(obs_data_t *settings, obs_source_t *sourc
 
     pthread_mutex_init(&outputMutex, nullptr);
 
+    // Allocate filter audio fan-out buffer before audio filter callback starts
+    obs_audio_info ai = {0};
+    if (!obs_get_audio_info(&ai)) {
+        obs_log(LOG_WARNING, "%s: Failed to get audio info", qUtf8Printable(name));
+    }
+    filterAudioBuffer = AudioCapture::createSharedBuffer(ai.speakers);
+
     if (!strcmp(obs_data_get_last_json(settings), "{}")) {
         // Maybe initial creation
         loadRecently(settings);
@@ -93,8 +169,11 @@ BranchOutputFilter::BranchOutputFilter(obs_data_t *settings, obs_source_t *sourc
         obs_data_set_int(settings, "audio_track", trackNo);
     }
 
+    setServiceDefaults(settings, (size_t)obs_data_get_int(settings, "service_count"));
+
     // Fiter activate immediately when "server" or "stream_recording" is exists.
-    initialized = countEnabledStreamings(settings) > 0 || obs_data_get_bool(settings, "stream_recording");
+    auto config = getParsedSettings(settings);
+    initialized = config->hasOutputs();
 
     obs_log(LOG_INFO, "%s: BranchOutputFilter created", qUtf8Printable(name));
 }
@@ -123,11 +202,21 @@ void BranchOutputFilter::addCallback(obs_source_t *source)
     intervalTimer->start();
     connect(intervalTimer, SIGNAL(timeout()), this, SLOT(onIntervalTimerTimeout()));
 
+    bitrateTimer = new QTimer(this);
+    bitrateTimer->setInterval(ADAPTIVE_BITRATE_INTERVAL_MS);
+    bitrateTimer->start();
+    connect(bitrateTimer, SIGNAL(timeout()), this, SLOT(onBitrateTimerTimeout()));
+
     // Register to status dock
     if (statusDock) {
         // Show in status dock (Thread-safe way)
         QMetaObject::invokeMethod(statusDock, "addFilter", Qt::QueuedConnection, Q_ARG(BranchOutputFilter *, this));
     }
+    if (MetricsExporter::getInstance()) {
+        QMetaObject::invokeMethod(
+            MetricsExporter::getInstance(), "addFilter", Qt::QueuedConnection, Q_ARG(BranchOutputFilter *, this)
+        );
+    }
 
     // Register hotkeys
     registerHotkey();
@@ -142,6 +231,10 @@ void BranchOutputFilter::addCallback(obs_source_t *source)
         this
     );
 
+    // Supervise immediately on "Eye" icon and parent source changes (e.g. resolution)
+    filterEnabledSignal.Connect(obs_source_get_signal_handler(filterSource), "enable", onSuperviseSignal, this);
+    parentUpdatedSignal.Connect(obs_source_get_signal_handler(source), "update", onSuperviseSignal, this);
+
     obs_log(LOG_INFO, "%s: Filter added to '%s'", qUtf8Printable(name), obs_source_get_name(source));
 }
 
@@ -159,16 +252,15 @@ void BranchOutputFilter::updateCallback(obs_data_t *settings)
 
     obs_log(LOG_DEBUG, "%s: Filter updating", qUtf8Printable(name));
 
+    setServiceDefaults(settings, (size_t)obs_data_get_int(settings, "service_count"));
+
     // It's unwelcome to do stopping output during attempting connect to service.
     // So we just count up revision (Settings will be applied on videoTick())
     storedSettingsRev++;
 
-    // Save settings as default
-    OBSString config_dir_path = obs_module_get_config_path(obs_current_module(), "");
-    os_mkdirs(config_dir_path);
-
+    // Save settings as default (Written in background, coalesced with following updates)
     OBSString path = obs_module_get_config_path(obs_current_module(), SETTINGS_JSON_NAME);
-    obs_data_save_json_safe(settings, path, "tmp", "bak");
+    SettingsFileWriter::getInstance()->save(QString::fromUtf8(path), settings);
 
     // Update status dock
     if (statusDock) {
@@ -193,6 +285,9 @@ void BranchOutputFilter::removeCallback()
         // Stop interval timer (In proper thread)
         QMetaObject::invokeMethod(intervalTimer, "stop", Qt::QueuedConnection);
     }
+    if (bitrateTimer) {
+        QMetaObject::invokeMethod(bitrateTimer, "stop", Qt::QueuedConnection);
+    }
 
     // Do not call stopOutput() here as this will cause a crash.
 
@@ -200,11 +295,22 @@ void BranchOutputFilter::removeCallback()
         // Unregister from output status dock (In proper thread)
         QMetaObject::invokeMethod(statusDock, "removeFilter", Qt::QueuedConnection, Q_ARG(BranchOutputFilter *, this));
     }
+    if (MetricsExporter::getInstance()) {
+        QMetaObject::invokeMethod(
+            MetricsExporter::getInstance(), "removeFilter", Qt::QueuedConnection, Q_ARG(BranchOutputFilter *, this)
+        );
+    }
 
     if (hotkeyPairId != OBS_INVALID_HOTKEY_PAIR_ID) {
         // Unregsiter hotkeys
         obs_hotkey_pair_unregister(hotkeyPairId);
     }
+    if (saveReplayHotkeyId != OBS_INVALID_HOTKEY_ID) {
+        obs_hotkey_unregister(saveReplayHotkeyId);
+    }
+
+    filterEnabledSignal.Disconnect();
+    parentUpdatedSignal.Disconnect();
 
     obs_log(LOG_INFO, "%s: Filter removed", qUtf8Printable(name));
 }
@@ -213,6 +319,16 @@ void BranchOutputFilter::destroyCallback()
 {
     obs_log(LOG_DEBUG, "%s: BranchOutputFilter destroying", qUtf8Printable(name));
 
+    // Pending supervision must not touch outputs anymore
+    initialized = false;
+    filterEnabledSignal.Disconnect();
+    parentUpdatedSignal.Disconnect();
+
+    // Drop queued startup and wait for running one
+    if (OutputStartScheduler::getInstance()->cancel(this)) {
+        starting = false;
+    }
+
     // Release all handles
     stopOutput();
 
@@ -224,31 +340,24 @@ void BranchOutputFilter::destroyCallback()
 
 void BranchOutputFilter::stopOutput()
 {
+    TRACE_SCOPE(TRACE_SITE_STOP_OUTPUT);
+
+    auto stopStartedAt = os_gettime_ns();
+
     pthread_mutex_lock(&outputMutex);
     {
         OBSMutexAutoUnlock locked(&outputMutex);
 
-        obs_source_t *parent = obs_filter_get_parent(filterSource);
+        // Before encoders are released
+        setStandbyEncodersIdle(false);
 
-        if (recordingOutput) {
-            if (recordingActive) {
-                obs_source_dec_showing(parent);
-                obs_output_stop(recordingOutput);
-            }
-        }
-        recordingOutput = nullptr;
+        stopRecordingOutput();
+        stopReplayBufferOutput();
 
-        for (size_t i = 0; i < MAX_SERVICES; i++) {
-            if (streamings[i].output && streamings[i].active) {
-                obs_source_dec_showing(parent);
-                obs_output_stop(streamings[i].output);
-                obs_log(LOG_INFO, "%s: Stopping streaming %zu output succeeded", qUtf8Printable(name), i);
-            }
-            streamings[i].output = nullptr;
-            streamings[i].service = nullptr;
-            streamings[i].connectAttemptingAt = 0;
-            streamings[i].active = false;
+        for (size_t i = 0; i < streamings.size(); i++) {
+            stopStreamingOutput(i);
         }
+        streamings.clear();
 
         for (size_t i = 0; i < MAX_AUDIO_MIXES; i++) {
             auto audioContext = &audios[i];
@@ -260,29 +369,106 @@ void BranchOutputFilter::stopOutput()
             }
         }
 
+        bitrateController = nullptr;
+        if (videoEncoder) {
+            // View will be removed when no other filter shares it
+            VideoEngine::getInstance()->releaseEncoder(videoEncoder);
+        }
         videoEncoder = nullptr;
+        videoEncoderFallback = false;
 
-        if (view) {
-            obs_view_set_source(view, 0, nullptr);
-            obs_view_remove(view);
-        }
+        activeSettingsValues.clear();
+        standby = false;
+    }
 
-        view = nullptr;
+    stopOutputDurationNs = os_gettime_ns() - stopStartedAt;
+}
+
+// Must be called with outputMutex locked
+void BranchOutputFilter::stopRecordingOutput()
+{
+    // Our own stop does not need supervision
+    for (size_t i = 0; i < SUPERVISED_OUTPUT_SIGNALS; i++) {
+        recordingSignals[i].Disconnect();
+    }
 
+    if (recordingOutput) {
         if (recordingActive) {
-            recordingActive = false;
-            obs_log(LOG_INFO, "%s: Stopping recording output succeeded", qUtf8Printable(name));
+            obs_source_dec_showing(obs_filter_get_parent(filterSource));
+            obs_output_stop(recordingOutput);
         }
+        // The last segment is still moved after stopped
+        RecordingSpooler::getInstance()->unwatch(recordingOutput);
+    }
+    recordingOutput = nullptr;
+
+    if (recordingActive) {
+        recordingActive = false;
+        obs_log(LOG_INFO, "%s: Stopping recording output succeeded", qUtf8Printable(name));
     }
 }
 
-obs_data_t *BranchOutputFilter::createRecordingSettings(obs_data_t *settings)
+// Must be called with outputMutex locked
+void BranchOutputFilter::stopReplayBufferOutput()
 {
-    auto recordingSettings = obs_data_create();
-    auto config = obs_frontend_get_profile_config();
-    QString filenameFormat = obs_data_get_string(settings, "filename_formatting");
+    for (size_t i = 0; i < SUPERVISED_OUTPUT_SIGNALS; i++) {
+        replayBufferSignals[i].Disconnect();
+    }
+
+    if (replayBufferOutput && replayBufferActive) {
+        obs_source_dec_showing(obs_filter_get_parent(filterSource));
+        // Buffered packets are discarded (Not saved)
+        obs_output_stop(replayBufferOutput);
+    }
+    replayBufferOutput = nullptr;
+
+    if (replayBufferActive) {
+        replayBufferActive = false;
+        obs_log(LOG_INFO, "%s: Stopping replay buffer output succeeded", qUtf8Printable(name));
+    }
+}
+
+// Must be called with outputMutex locked
+void BranchOutputFilter::stopStreamingOutput(size_t index)
+{
+    // Our own stop does not need supervision
+    for (size_t i = 0; i < SUPERVISED_OUTPUT_SIGNALS; i++) {
+        streamings[index].outputSignals[i].Disconnect();
+    }
+
+    StreamingSupervisor::release(streamings[index]);
+
+    if (streamings[index].output) {
+        QMutexLocker locker(&metricsMutex);
+        reconnectCounts.remove(streamings[index].output);
+    }
+
+    if (streamings[index].output && streamings[index].active) {
+        obs_source_dec_showing(obs_filter_get_parent(filterSource));
+        obs_output_stop(streamings[index].output);
+        obs_log(LOG_INFO, "%s: Stopping streaming %zu output succeeded", qUtf8Printable(name), index);
+    }
+    streamings[index].output = nullptr;
+    streamings[index].service = nullptr;
+    streamings[index].bitrateController = nullptr;
+    if (streamings[index].videoEncoder) {
+        VideoEngine::getInstance()->releaseEncoder(streamings[index].videoEncoder);
+    }
+    streamings[index].videoEncoder = nullptr;
+    streamings[index].videoEncoderFallback = false;
+    streamings[index].connectAttemptingAt = 0;
+    streamings[index].active = false;
+    streamings[index].ingestHost.clear();
+    streamings[index].reconnectPending = false;
+}
+
+// Filename format with source and filter names embedded (Shared by recording and replay buffer)
+QString BranchOutputFilter::createFilenameFormat(const FilterSettings &config)
+{
+    // Frontend API isn't called here, this runs in worker thread as well (See startOutputAsync())
+    auto filenameFormat = config.filenameFormatting;
     if (filenameFormat.isEmpty()) {
-        filenameFormat = QString("%1_%2_") + QString(config_get_string(config, "Output", "FilenameFormatting"));
+        filenameFormat = QString("%1_%2_") + profileFilenameFormatting;
     }
 
     // Sanitize filename
@@ -294,94 +480,129 @@ obs_data_t *BranchOutputFilter::createRecordingSettings(obs_data_t *settings)
     // TODO: Add filtering for other platforms
 #endif
 
-    auto path = obs_data_get_string(settings, "path");
-    auto recFormat = obs_data_get_string(settings, "rec_format");
-
     // Add filter name to filename format
     QString sourceName = obs_source_get_name(obs_filter_get_parent(filterSource));
     QString filterName = qUtf8Printable(name);
     filenameFormat = filenameFormat.arg(sourceName.replace(QRegularExpression("[\\s/\\\\.:;*?\"<>|&$,]"), "-"))
                          .arg(filterName.replace(QRegularExpression("[\\s/\\\\.:;*?\"<>|&$,]"), "-"));
-    auto compositePath = getOutputFilename(path, recFormat, true, false, qUtf8Printable(filenameFormat));
+    return filenameFormat;
+}
+
+obs_data_t *BranchOutputFilter::createRecordingSettings(const FilterSettings &config)
+{
+    auto recordingSettings = obs_data_create();
+    auto filenameFormat = createFilenameFormat(config);
+
+    // Spooled recording is written into local staging directory first
+    auto directory = config.recSpool ? config.recSpoolPath : config.path;
+    if (config.recSpool) {
+        os_mkdirs(qUtf8Printable(directory));
+    }
+
+    auto compositePath = getOutputFilename(
+        qUtf8Printable(directory), qUtf8Printable(config.recFormat), true, false, qUtf8Printable(filenameFormat)
+    );
 
     obs_data_set_string(recordingSettings, "path", qUtf8Printable(compositePath));
 
-    auto splitFile = obs_data_get_string(settings, "split_file");
-    if (strlen(splitFile) > 0) {
-        obs_data_set_string(recordingSettings, "directory", path);
+    if (!config.splitFile.isEmpty()) {
+        obs_data_set_string(recordingSettings, "directory", qUtf8Printable(directory));
         obs_data_set_string(recordingSettings, "format", qUtf8Printable(filenameFormat));
-        obs_data_set_string(recordingSettings, "extension", qUtf8Printable(getFormatExt(recFormat)));
+        auto ext = getFormatExt(qUtf8Printable(config.recFormat));
+        obs_data_set_string(recordingSettings, "extension", qUtf8Printable(ext));
         obs_data_set_bool(recordingSettings, "allow_spaces", false);
         obs_data_set_bool(recordingSettings, "allow_overwrite", false);
         obs_data_set_bool(recordingSettings, "split_file", true);
 
-        auto maxTimeSec = !strcmp(splitFile, "by_time") ? obs_data_get_int(settings, "split_file_time_mins") * 60 : 0;
+        auto maxTimeSec = config.splitFile == "by_time" ? config.splitFileTimeMins * 60 : 0;
         obs_data_set_int(recordingSettings, "max_time_sec", maxTimeSec);
 
-        auto maxSizeMb = !strcmp(splitFile, "by_size") ? obs_data_get_int(settings, "split_file_size_mb") : 0;
+        auto maxSizeMb = config.splitFile == "by_size" ? config.splitFileSizeMb : 0;
         obs_data_set_int(recordingSettings, "max_size_mb", maxSizeMb);
     }
 
     return recordingSettings;
 }
 
-obs_data_t *BranchOutputFilter::createStreamingSettings(obs_data_t *settings, size_t index)
+obs_data_t *BranchOutputFilter::createReplayBufferSettings(const FilterSettings &config)
+{
+    auto replayBufferSettings = obs_data_create();
+    // Follow frontend's "Replay " prefix (Saved next to recordings)
+    auto filenameFormat = QString("Replay_") + createFilenameFormat(config);
+    auto ext = getFormatExt(qUtf8Printable(config.recFormat));
+
+    obs_data_set_string(replayBufferSettings, "directory", qUtf8Printable(config.path));
+    obs_data_set_string(replayBufferSettings, "format", qUtf8Printable(filenameFormat));
+    obs_data_set_string(replayBufferSettings, "extension", qUtf8Printable(ext));
+    obs_data_set_bool(replayBufferSettings, "allow_spaces", false);
+    // Packets are dropped from the front by whichever limit is reached first
+    obs_data_set_int(replayBufferSettings, "max_time_sec", config.replayBufferMaxTimeSec);
+    obs_data_set_int(replayBufferSettings, "max_size_mb", config.replayBufferMaxSizeMb);
+
+    return replayBufferSettings;
+}
+
+// Only keys read by "rtmp_custom" service (Copying whole filter settings is not necessary)
+obs_data_t *BranchOutputFilter::createStreamingSettings(const FilterSettings &config, size_t index)
 {
     auto streamingSettings = obs_data_create();
-    auto propNameFormat = getIndexedPropNameFormat(index);
+    auto &service = config.services[index];
 
-    // Copy all settings
-    obs_data_apply(streamingSettings, settings);
+    obs_data_set_string(streamingSettings, "server", qUtf8Printable(service.server));
+    obs_data_set_string(streamingSettings, "key", qUtf8Printable(service.key));
+    obs_data_set_bool(streamingSettings, "use_auth", service.useAuth);
+    obs_data_set_string(streamingSettings, "username", qUtf8Printable(service.username));
+    obs_data_set_string(streamingSettings, "password", qUtf8Printable(service.password));
 
-    if (index > 0) {
-        // Apply indexed properties (Only on index >= 1 )
-        obs_data_set_string(
-            streamingSettings, "server", obs_data_get_string(settings, qUtf8Printable(propNameFormat.arg("server")))
-        );
-        obs_data_set_string(
-            streamingSettings, "key", obs_data_get_string(settings, qUtf8Printable(propNameFormat.arg("key")))
-        );
-        obs_data_set_bool(
-            streamingSettings, "use_auth", obs_data_get_bool(settings, qUtf8Printable(propNameFormat.arg("use_auth")))
-        );
-        obs_data_set_string(
-            streamingSettings, "username", obs_data_get_string(settings, qUtf8Printable(propNameFormat.arg("username")))
-        );
-        obs_data_set_string(
-            streamingSettings, "password", obs_data_get_string(settings, qUtf8Printable(propNameFormat.arg("password")))
-        );
+    return streamingSettings;
+}
+
+obs_data_t *
+BranchOutputFilter::createRenditionSettings(obs_data_t *settings, const FilterSettings &config, size_t index)
+{
+    auto renditionSettings = obs_data_create();
+    auto &service = config.services[index];
+
+    auto encoderId = service.renditionVideoEncoder;
+    if (encoderId.isEmpty() || encoderId == config.videoEncoder) {
+        // Same encoder -> Inherit encoder settings
+        encoderId = config.videoEncoder;
+        obs_data_apply(renditionSettings, settings);
     }
 
-    return streamingSettings;
+    obs_data_set_string(renditionSettings, "video_encoder", qUtf8Printable(encoderId));
+    obs_data_set_int(renditionSettings, "bitrate", service.renditionBitrate);
+    obs_data_set_int(renditionSettings, "frame_rate_divisor", obs_data_get_int(settings, "frame_rate_divisor"));
+
+    return renditionSettings;
 }
 
-void BranchOutputFilter::determineOutputResolution(obs_data_t *settings, obs_video_info *ovi)
+void BranchOutputFilter::determineOutputResolution(const FilterResolutionSettings &resolution, obs_video_info *ovi)
 {
-    auto resolution = obs_data_get_string(settings, "resolution");
-    if (!strcmp(resolution, "custom")) {
+    if (resolution.resolution == "custom") {
         // Custom resolution
-        ovi->output_width = (uint32_t)obs_data_get_int(settings, "custom_width");
-        ovi->output_height = (uint32_t)obs_data_get_int(settings, "custom_height");
+        ovi->output_width = resolution.customWidth;
+        ovi->output_height = resolution.customHeight;
 
-    } else if (!strcmp(resolution, "output")) {
+    } else if (resolution.resolution == "output") {
         // Nothing to do
 
-    } else if (!strcmp(resolution, "canvas")) {
+    } else if (resolution.resolution == "canvas") {
         // Copy canvas resolution
         ovi->output_width = ovi->base_width;
         ovi->output_height = ovi->base_height;
 
-    } else if (!strcmp(resolution, "three_quarters")) {
+    } else if (resolution.resolution == "three_quarters") {
         // Rescale source resolution
         ovi->output_width = width * 3 / 4;
         ovi->output_height = height * 3 / 4;
 
-    } else if (!strcmp(resolution, "half")) {
+    } else if (resolution.resolution == "half") {
         // Rescale source resolution
         ovi->output_width = width / 2;
         ovi->output_height = height / 2;
 
-    } else if (!strcmp(resolution, "quarter")) {
+    } else if (resolution.resolution == "quarter") {
         // Rescale source resolution
         ovi->output_width = width / 4;
         ovi->output_height = height / 4;
@@ -396,33 +617,43 @@ void BranchOutputFilter::determineOutputResolution(obs_data_t *settings, obs_vid
     ovi->output_width += (ovi->output_width & 1);
     ovi->output_height += (ovi->output_height & 1);
 
-    auto downscaleFilter = obs_data_get_string(settings, "downscale_filter");
-    if (!strcmp(downscaleFilter, "bilinear")) {
-        ovi->scale_type = OBS_SCALE_BILINEAR;
-    } else if (!strcmp(downscaleFilter, "area")) {
-        ovi->scale_type = OBS_SCALE_AREA;
-    } else if (!strcmp(downscaleFilter, "bicubic")) {
-        ovi->scale_type = OBS_SCALE_BICUBIC;
-    } else if (!strcmp(downscaleFilter, "lanczos")) {
-        ovi->scale_type = OBS_SCALE_LANCZOS;
+    if (resolution.scaleType != OBS_SCALE_DISABLE) {
+        ovi->scale_type = resolution.scaleType;
     }
 }
 
+// View (ovi) and encoder base (encvi) video info for current source size
+bool BranchOutputFilter::getSourceVideoInfo(obs_video_info *ovi, obs_video_info *encvi)
+{
+    if (!obs_get_video_info(ovi)) {
+        return false;
+    }
+
+    *encvi = *ovi;
+
+    ovi->base_width = width;
+    ovi->base_height = height;
+    ovi->output_width = encvi->base_width = width;
+    ovi->output_height = encvi->base_height = height;
+    return true;
+}
+
 #define FTL_PROTOCOL "ftl"
 #define RTMP_PROTOCOL "rtmp"
 
-BranchOutputFilter::BranchOutputStreamingContext BranchOutputFilter::createSreaming(obs_data_t *settings, size_t index)
+BranchOutputFilter::BranchOutputStreamingContext BranchOutputFilter::createSreaming(
+    const FilterSettings &config, size_t index
+)
 {
-    auto count = (size_t)obs_data_get_int(settings, "service_count");
-    if (index >= count || index >= MAX_SERVICES) {
+    if (index >= (size_t)config.services.size()) {
         return {0};
     }
 
-    if (!isStreamingEnabled(settings, index)) {
+    if (!config.services[index].isEnabled()) {
         return {0};
     }
 
-    OBSDataAutoRelease streamingSettings = createStreamingSettings(settings, index);
+    OBSDataAutoRelease streamingSettings = createStreamingSettings(config, index);
     BranchOutputStreamingContext context = {0};
 
     // Create service - We always use "rtmp_custom" as service
@@ -451,18 +682,16 @@ BranchOutputFilter::BranchOutputStreamingContext BranchOutputFilter::createSream
         obs_log(LOG_ERROR, "%s: Streaming %zu output creation failed", qUtf8Printable(name), index);
         return {0};
     }
+    // libobs reconnects by itself first, then ReconnectCoordinator takes over after it gave up
     obs_output_set_reconnect_settings(context.output, OUTPUT_MAX_RETRIES, OUTPUT_RETRY_DELAY_SECS);
     obs_output_set_service(context.output, context.service);
+    context.ingestHost = ReconnectCoordinator::getIngestHost(config.services[index].server);
 
     return context;
 }
 
-void BranchOutputFilter::startStreamingOutput(size_t index)
+bool BranchOutputFilter::attachStreamingEncoders(size_t index)
 {
-    if (!streamings[index].output) {
-        return;
-    }
-
     size_t encIndex = 0;
     for (size_t i = 0; i < MAX_AUDIO_MIXES; i++) {
         auto audioContext = &audios[i];
@@ -488,11 +717,24 @@ void BranchOutputFilter::startStreamingOutput(size_t index)
         }
         if (!encIndex) {
             obs_log(LOG_ERROR, "%s: No audio encoder for streaming %zu", qUtf8Printable(name), index);
-            return;
+            return false;
         }
     }
 
-    obs_output_set_video_encoder(streamings[index].output, videoEncoder);
+    if (streamings[index].videoEncoder) {
+        obs_output_set_video_encoder(streamings[index].output, streamings[index].videoEncoder);
+    } else {
+        obs_output_set_video_encoder(streamings[index].output, videoEncoder);
+    }
+
+    return true;
+}
+
+void BranchOutputFilter::startStreamingOutput(size_t index)
+{
+    if (!streamings[index].output || !attachStreamingEncoders(index)) {
+        return;
+    }
 
     // Start streaming output
     if (obs_output_start(streamings[index].output)) {
@@ -504,17 +746,183 @@ void BranchOutputFilter::startStreamingOutput(size_t index)
     }
 }
 
-void BranchOutputFilter::startOutput(obs_data_t *settings)
+// Must be called with outputMutex locked, after audio and video encoders have been set up
+bool BranchOutputFilter::createRecordingOutput(const FilterSettings &config)
+{
+    const char *outputId = config.recFormat == "hybrid_mp4" ? "mp4_output" : "ffmpeg_muxer";
+
+    // Ensure base path exists
+    os_mkdirs(qUtf8Printable(config.path));
+
+    OBSDataAutoRelease recordingSettings = createRecordingSettings(config);
+    recordingOutput = obs_output_create(outputId, qUtf8Printable(name), recordingSettings, nullptr);
+    if (!recordingOutput) {
+        obs_log(LOG_ERROR, "%s: Recording output creation failed", qUtf8Printable(name));
+        return false;
+    }
+
+    return attachRecordingEncoders(recordingOutput);
+}
+
+// Recording tracks and filter's videoEncoder (Replay buffer uses them too)
+bool BranchOutputFilter::attachRecordingEncoders(obs_output_t *output)
+{
+    size_t encIndex = 0;
+    for (size_t i = 0; i < MAX_AUDIO_MIXES; i++) {
+        auto audioContext = &audios[i];
+        if (!audioContext->encoder || !audioContext->recording) {
+            continue;
+        }
+
+        obs_output_set_audio_encoder(output, audioContext->encoder, encIndex++);
+    }
+
+    if (!encIndex) {
+        // No audio encoder -> fallback first available encoder
+        for (size_t i = 0; i < MAX_AUDIO_MIXES; i++) {
+            auto audioContext = &audios[i];
+            if (audioContext->encoder) {
+                obs_log(
+                    LOG_WARNING, "%s: No audio encoder selected for recording, using track %d",
+                    qUtf8Printable(name), i + 1
+                );
+                obs_output_set_audio_encoder(output, audioContext->encoder, encIndex++);
+                break;
+            }
+        }
+        if (!encIndex) {
+            obs_log(LOG_ERROR, "%s: No audio encoder for recording", qUtf8Printable(name));
+            return false;
+        }
+    }
+
+    obs_output_set_video_encoder(output, videoEncoder);
+    return true;
+}
+
+// Must be called with outputMutex locked, after audio and video encoders have been set up
+bool BranchOutputFilter::startRecordingOutput(const FilterSettings &config)
+{
+    if (!recordingOutput) {
+        if (!createRecordingOutput(config)) {
+            return false;
+        }
+    } else {
+        // Created in warm standby -> Filename must reflect actual start time
+        OBSDataAutoRelease recordingSettings = createRecordingSettings(config);
+        obs_output_update(recordingOutput, recordingSettings);
+    }
+
+    connectOutputSignals(recordingOutput, recordingSignals);
+
+    if (config.recSpool) {
+        // Finished segments are moved to the actual path in background
+        RecordingSpooler::getInstance()->watch(name, recordingOutput, config.path, config.recSpoolLimitMb);
+    }
+
+    // Start recording output
+    if (obs_output_start(recordingOutput)) {
+        recordingActive = true;
+        obs_source_inc_showing(obs_filter_get_parent(filterSource));
+        obs_log(LOG_INFO, "%s: Starting recording output succeeded", qUtf8Printable(name));
+    } else {
+        obs_log(LOG_ERROR, "%s: Starting recording output failed", qUtf8Printable(name));
+    }
+
+    return true;
+}
+
+// Must be called with outputMutex locked, after audio and video encoders have been set up
+// No second encode, packets of recording encoders are only kept in memory until saved
+bool BranchOutputFilter::startReplayBufferOutput(const FilterSettings &config)
+{
+    OBSDataAutoRelease replayBufferSettings = createReplayBufferSettings(config);
+    if (!replayBufferOutput) {
+        replayBufferOutput = obs_output_create(
+            "replay_buffer", qUtf8Printable(QString("%1 (Replay)").arg(name)), replayBufferSettings, nullptr
+        );
+        if (!replayBufferOutput) {
+            obs_log(LOG_ERROR, "%s: Replay buffer output creation failed", qUtf8Printable(name));
+            return false;
+        }
+
+        if (!attachRecordingEncoders(replayBufferOutput)) {
+            replayBufferOutput = nullptr;
+            return false;
+        }
+    } else {
+        obs_output_update(replayBufferOutput, replayBufferSettings);
+    }
+
+    connectOutputSignals(replayBufferOutput, replayBufferSignals);
+
+    if (obs_output_start(replayBufferOutput)) {
+        replayBufferActive = true;
+        obs_source_inc_showing(obs_filter_get_parent(filterSource));
+        obs_log(LOG_INFO, "%s: Starting replay buffer output succeeded", qUtf8Printable(name));
+    } else {
+        obs_log(LOG_ERROR, "%s: Starting replay buffer output failed", qUtf8Printable(name));
+    }
+
+    return true;
+}
+
+// Must be called with outputMutex locked, after streaming has been created
+void BranchOutputFilter::setupRenditionEncoder(
+    obs_data_t *settings, const FilterSettings &config, size_t index, const obs_video_info *ovi,
+    const obs_video_info *encvi
+)
+{
+    if (!streamings[index].output || !config.services[index].customRendition) {
+        return;
+    }
+
+    OBSDataAutoRelease renditionSettings = createRenditionSettings(settings, config, index);
+    obs_video_info renditionvi = *encvi;
+    determineOutputResolution(config.services[index].renditionResolution, &renditionvi);
+
+    obs_log(
+        LOG_INFO, "%s: Use custom rendition %dx%d for streaming %zu", qUtf8Printable(name), renditionvi.output_width,
+        renditionvi.output_height, index
+    );
+
+    auto parent = obs_filter_get_parent(filterSource);
+    streamings[index].videoEncoder = VideoEngine::getInstance()->acquireEncoder(
+        name, parent, renditionSettings, ovi, &renditionvi, letterbox, &streamings[index].videoEncoderFallback,
+        config.adaptiveBitrate, mainCanvas
+    );
+    if (!streamings[index].videoEncoder) {
+        // Non-stopping error (Other services keep going)
+        obs_log(LOG_ERROR, "%s: Rendition encoder creation failed for streaming %zu", qUtf8Printable(name), index);
+        streamings[index] = {0};
+        return;
+    }
+
+    if (config.adaptiveBitrate) {
+        streamings[index].bitrateController.reset(new AdaptiveBitrateController(
+            QString("%1 (Streaming %2)").arg(name).arg(index), streamings[index].videoEncoder,
+            config.adaptiveBitrateMinPercent
+        ));
+    }
+}
+
+// With standbyOnly, everything is prepared except for starting outputs (Warm standby)
+void BranchOutputFilter::startOutput(obs_data_t *settings, bool standbyOnly)
 {
+    TRACE_SCOPE(TRACE_SITE_START_OUTPUT);
+
     // Force release references
     stopOutput();
 
+    auto config = getParsedSettings(settings);
+
     pthread_mutex_lock(&outputMutex);
     {
         OBSMutexAutoUnlock locked(&outputMutex);
 
         // Abort when obs initializing or filter disabled.
-        if (!obs_initialized() || !obs_source_enabled(filterSource) || countActiveStreamings() > 0 || recordingActive) {
+        if (!obs_initialized() || !obs_source_enabled(filterSource) || countActiveStreamings() > 0 || recordingActive ||
+            replayBufferActive) {
             obs_log(LOG_ERROR, "%s: Ignore unavailable filter", qUtf8Printable(name));
             return;
         }
@@ -533,20 +941,11 @@ void BranchOutputFilter::startOutput(obs_data_t *settings)
         }
 
         // Mandatory paramters
-        if (countEnabledStreamings(settings) == 0 && !obs_data_get_string(settings, "stream_recording")) {
+        if (!config->hasOutputs()) {
             obs_log(LOG_ERROR, "%s: Nothing to do", qUtf8Printable(name));
             return;
         }
 
-        obs_video_info ovi = {0};
-        if (!obs_get_video_info(&ovi)) {
-            // Abort when no video situation
-            obs_log(LOG_ERROR, "%s: No video", qUtf8Printable(name));
-            return;
-        }
-
-        obs_video_info encvi = ovi;
-
         // Round up to a multiple of 2
         width = obs_source_get_width(parent);
         width += (width & 1);
@@ -554,10 +953,17 @@ void BranchOutputFilter::startOutput(obs_data_t *settings)
         height = obs_source_get_height(parent);
         height += (height & 1);
 
-        ovi.base_width = width;
-        ovi.base_height = height;
-        ovi.output_width = encvi.base_width = width;
-        ovi.output_height = encvi.base_height = height;
+        // Size is locked with letterbox, or outputs follow source size
+        letterbox = config->lockResolution;
+        resizedAt = 0;
+
+        obs_video_info ovi = {0};
+        obs_video_info encvi = {0};
+        if (!getSourceVideoInfo(&ovi, &encvi)) {
+            // Abort when no video situation
+            obs_log(LOG_ERROR, "%s: No video", qUtf8Printable(name));
+            return;
+        }
 
         if (width == 0 || height == 0 || ovi.fps_den == 0 || ovi.fps_num == 0) {
             // Abort when invalid video parameters situation
@@ -565,30 +971,27 @@ void BranchOutputFilter::startOutput(obs_data_t *settings)
             return;
         }
 
+        // Main canvas texture has canvas base size, so only parent as large as the canvas can be copied from it
+        obs_video_info canvasvi = {0};
+        mainCanvas = config->mainCanvas && !letterbox && obs_get_video_info(&canvasvi) &&
+                     canvasvi.base_width == width && canvasvi.base_height == height;
+
         // Update active revision with stored settings.
         activeSettingsRev = storedSettingsRev;
+        activeSettingsValues = getSettingsValues(settings);
 
         //--- Create service and open stream output ---//
-        auto serviceCount = (size_t)obs_data_get_int(settings, "service_count");
-        for (size_t i = 0; i < MAX_SERVICES && i < serviceCount; i++) {
-            streamings[i] = createSreaming(settings, i);
+        streamings.resize(config->services.size());
+        for (size_t i = 0; i < streamings.size(); i++) {
+            streamings[i] = createSreaming(*config, i);
             if (streamings[i].output) {
-                streamings[i].connectAttemptingAt = os_gettime_ns();
+                connectOutputSignals(streamings[i].output, streamings[i].outputSignals);
             }
         }
 
-        //--- Open video output ---//
-        // Create view and associate it with filter source
-        view = obs_view_create();
-
-        obs_view_set_source(view, 0, parent);
-        videoOutput = obs_view_add2(view, &ovi);
-        if (!videoOutput) {
-            obs_log(LOG_ERROR, "%s: Video output association failed", qUtf8Printable(name));
-            return;
-        }
-
         //--- Open audio output(s) ---//
+        // Captures have no QObject parent and no thread affinity because they are created in worker thread
+        // (Deleted in stopOutput() from either thread)
         // Do not use memset
         for (size_t i = 0; i < MAX_AUDIO_MIXES; i++) {
             audios[i] = {0};
@@ -600,44 +1003,42 @@ void BranchOutputFilter::startOutput(obs_data_t *settings)
             return;
         }
 
-        if (obs_data_get_bool(settings, "custom_audio_source")) {
+        if (config->customAudioSource) {
             // Apply custom audio source
-            bool multitrack = obs_data_get_bool(settings, "multitrack_audio");
-
             for (size_t i = 0; i < MAX_AUDIO_MIXES; i++) {
                 auto audioContext = &audios[i];
-                if (!multitrack && i > 0) {
+                if (!config->multitrackAudio && i > 0) {
                     // Signle track mode
                     break;
                 }
 
                 size_t track = i + 1;
-                auto propNameFormat = getIndexedPropNameFormat(track, 1);
-
-                auto audioDest = obs_data_get_string(settings, qUtf8Printable(propNameFormat.arg("audio_dest")));
-                audioContext->streaming = !strcmp(audioDest, "streaming") || !strcmp(audioDest, "both");
-                audioContext->recording = !strcmp(audioDest, "recording") || !strcmp(audioDest, "both");
+                auto &trackSettings = config->tracks[i];
+                auto &audioDest = trackSettings.audioDest;
+                audioContext->streaming = trackSettings.streaming;
+                audioContext->recording = trackSettings.recording;
 
-                auto audioSourceUuid =
-                    obs_data_get_string(settings, qUtf8Printable(propNameFormat.arg("audio_source")));
-                if (!strcmp(audioSourceUuid, "disabled")) {
+                auto &audioSourceUuid = trackSettings.audioSource;
+                if (audioSourceUuid == "disabled") {
                     // Disabled track
                     obs_log(LOG_INFO, "%s: Track %d is disabled", qUtf8Printable(name), track);
                     continue;
 
-                } else if (!strcmp(audioSourceUuid, "no_audio")) {
+                } else if (audioSourceUuid == "no_audio") {
                     // Silence audio
-                    obs_log(LOG_INFO, "%s: Use silence for track %d (%s)", qUtf8Printable(name), track, audioDest);
-
-                    audioContext->capture = new AudioCapture(
-                        "Silence", ai.samples_per_sec, ai.speakers, AudioCapture::silenceCapture, this
+                    obs_log(
+                        LOG_INFO, "%s: Use silence for track %d (%s)", qUtf8Printable(name), track,
+                        qUtf8Printable(audioDest)
                     );
+
+                    audioContext->capture = new AudioCapture("Silence", ai.samples_per_sec, ai.speakers, true);
                     audioContext->audio = audioContext->capture->getAudio();
+                    audioContext->mixIndex = audioContext->capture->getMixIndex();
                     audioContext->name = audioContext->capture->getName();
 
-                } else if (!strcmp(audioSourceUuid, "master_track")) {
+                } else if (audioSourceUuid == "master_track") {
                     // Master audio
-                    auto masterTrack = obs_data_get_int(settings, qUtf8Printable(propNameFormat.arg("audio_track")));
+                    auto masterTrack = trackSettings.audioTrack;
                     if (masterTrack < 1 || masterTrack > MAX_AUDIO_MIXES) {
                         obs_log(
                             LOG_ERROR, "%s: Invalid master audio track No.%d for track %d", qUtf8Printable(name),
@@ -647,30 +1048,35 @@ void BranchOutputFilter::startOutput(obs_data_t *settings)
                     }
                     obs_log(
                         LOG_INFO, "%s: Use master audio track No.%d for track %d (%s)", qUtf8Printable(name),
-                        masterTrack, track, audioDest
+                        masterTrack, track, qUtf8Printable(audioDest)
                     );
 
                     audioContext->mixIndex = masterTrack - 1;
                     audioContext->audio = obs_get_audio();
                     audioContext->name = QTStr("MasterTrack%1").arg(masterTrack);
 
-                } else if (!strcmp(audioSourceUuid, "filter")) {
+                } else if (audioSourceUuid == "filter") {
                     // Filter pipline's audio
-                    obs_log(LOG_INFO, "%s: Use filter audio for track %d (%s)", qUtf8Printable(name), track, audioDest);
+                    obs_log(
+                        LOG_INFO, "%s: Use filter audio for track %d (%s)", qUtf8Printable(name), track,
+                        qUtf8Printable(audioDest)
+                    );
 
-                    audioContext->capture =
-                        new FilterAudioCapture(qUtf8Printable(name), ai.samples_per_sec, ai.speakers, this);
+                    audioContext->capture = new FilterAudioCapture(
+                        qUtf8Printable(name), ai.samples_per_sec, ai.speakers, filterAudioBuffer
+                    );
                     audioContext->audio = audioContext->capture->getAudio();
+                    audioContext->mixIndex = audioContext->capture->getMixIndex();
                     audioContext->name = audioContext->capture->getName();
 
                 } else {
                     // Specific source's audio
-                    OBSSourceAutoRelease source = obs_get_source_by_uuid(audioSourceUuid);
+                    OBSSourceAutoRelease source = obs_get_source_by_uuid(qUtf8Printable(audioSourceUuid));
                     if (!source) {
                         // Non-stopping error
                         obs_log(
                             LOG_WARNING, "%s: Ignore audio source for track %d (%s)", qUtf8Printable(name), track,
-                            audioDest
+                            qUtf8Printable(audioDest)
                         );
                         continue;
                     }
@@ -681,14 +1087,16 @@ void BranchOutputFilter::startOutput(obs_data_t *settings)
                         track
                     );
 
-                    audioContext->capture = new SourceAudioCapture(source, ai.samples_per_sec, ai.speakers, this);
+                    audioContext->capture = new SourceAudioCapture(source, ai.samples_per_sec, ai.speakers);
                     audioContext->audio = audioContext->capture->getAudio();
+                    audioContext->mixIndex = audioContext->capture->getMixIndex();
                     audioContext->name = audioContext->capture->getName();
                 }
 
                 if (!audioContext->audio) {
                     obs_log(
-                        LOG_ERROR, "%s: Audio creation failed for track %d (%s)", qUtf8Printable(name), track, audioDest
+                        LOG_ERROR, "%s: Audio creation failed for track %d (%s)", qUtf8Printable(name), track,
+                        qUtf8Printable(audioDest)
                     );
                     if (audioContext->capture) {
                         delete audioContext->capture;
@@ -696,13 +1104,19 @@ void BranchOutputFilter::startOutput(obs_data_t *settings)
                     }
                     return;
                 }
+
+                if (audioContext->capture && config->audioDriftCompensation) {
+                    audioContext->capture->setDriftCompensation(true);
+                }
             }
         } else {
             // Filter pipeline's audio
             obs_log(LOG_INFO, "%s: Use filter audio for track 1", qUtf8Printable(name));
             auto audioContext = &audios[0];
-            audioContext->capture = new FilterAudioCapture(qUtf8Printable(name), ai.samples_per_sec, ai.speakers, this);
+            audioContext->capture =
+                new FilterAudioCapture(qUtf8Printable(name), ai.samples_per_sec, ai.speakers, filterAudioBuffer);
             audioContext->audio = audioContext->capture->getAudio();
+            audioContext->mixIndex = audioContext->capture->getMixIndex();
             audioContext->streaming = true;
             audioContext->recording = true;
             audioContext->name = audioContext->capture->getName();
@@ -716,33 +1130,33 @@ void BranchOutputFilter::startOutput(obs_data_t *settings)
         }
 
         //--- Setup video encoder ---//
-        auto video_encoder_id = obs_data_get_string(settings, "video_encoder");
-        videoEncoder = obs_video_encoder_create(video_encoder_id, qUtf8Printable(name), settings, nullptr);
+        // Identical setups on the same source share one view and encoder
+        obs_video_info mainvi = encvi;
+        determineOutputResolution(config->resolution, &mainvi);
+        // Adaptive encoder is used by this filter only, and it's shared with recording unless recording has priority
+        auto adaptive = config->adaptiveBitrate &&
+                        (!config->streamRecording || config->adaptiveBitratePriority == "streaming");
+        videoEncoder = VideoEngine::getInstance()->acquireEncoder(
+            name, parent, settings, &ovi, &mainvi, letterbox, &videoEncoderFallback, adaptive, mainCanvas
+        );
         if (!videoEncoder) {
-            obs_log(LOG_ERROR, "%s: Video encoder creation failed", qUtf8Printable(name));
             return;
         }
-
-        determineOutputResolution(settings, &encvi);
-
-        if (encvi.base_width == encvi.output_width && encvi.base_height == encvi.output_height) {
-            // No scaling
-            obs_encoder_set_scaled_size(videoEncoder, 0, 0);
-        } else {
-            obs_log(
-                LOG_DEBUG, "%s: Output resolution is %dx%d (scaling=%d)", qUtf8Printable(name), encvi.output_width,
-                encvi.output_height, encvi.scale_type
+        if (adaptive) {
+            bitrateController.reset(
+                new AdaptiveBitrateController(name, videoEncoder, config->adaptiveBitrateMinPercent)
             );
-            obs_encoder_set_scaled_size(videoEncoder, encvi.output_width, encvi.output_height);
-            obs_encoder_set_gpu_scale_type(videoEncoder, encvi.scale_type);
         }
-        obs_encoder_set_video(videoEncoder, videoOutput);
+
+        //--- Setup rendition video encoder(s) ---//
+        // Every rendition is scaled from the same view
+        for (size_t i = 0; i < streamings.size(); i++) {
+            setupRenditionEncoder(settings, *config, i, &ovi, &encvi);
+        }
 
         //--- Setup audio encoder ---//
-        auto audio_encoder_id = obs_data_get_string(settings, "audio_encoder");
-        auto audio_bitrate = obs_data_get_int(settings, "audio_bitrate");
-        OBSDataAutoRelease audio_encoder_settings = obs_encoder_defaults(audio_encoder_id);
-        obs_data_set_int(audio_encoder_settings, "bitrate", audio_bitrate);
+        OBSDataAutoRelease audio_encoder_settings = obs_encoder_defaults(qUtf8Printable(config->audioEncoder));
+        obs_data_set_int(audio_encoder_settings, "bitrate", config->audioBitrate);
 
         for (size_t i = 0; i < MAX_AUDIO_MIXES; i++) {
             auto audioContext = &audios[i];
@@ -751,8 +1165,8 @@ void BranchOutputFilter::startOutput(obs_data_t *settings)
             }
 
             audioContext->encoder = obs_audio_encoder_create(
-                audio_encoder_id, qUtf8Printable(audioContext->name), audio_encoder_settings, audioContext->mixIndex,
-                nullptr
+                qUtf8Printable(config->audioEncoder), qUtf8Printable(audioContext->name), audio_encoder_settings,
+                audioContext->mixIndex, nullptr
             );
             if (!audioContext->encoder) {
                 obs_log(LOG_ERROR, "%s: Audio encoder creation failed for track %d", qUtf8Printable(name), i + 1);
@@ -761,88 +1175,166 @@ void BranchOutputFilter::startOutput(obs_data_t *settings)
             obs_encoder_set_audio(audioContext->encoder, audioContext->audio);
         }
 
-        //--- Start recording output (if requested) ---//
-        if (obs_data_get_bool(settings, "stream_recording")) {
-            auto recFormat = obs_data_get_string(settings, "rec_format");
-            const char *outputId = !strcmp(recFormat, "hybrid_mp4") ? "mp4_output" : "ffmpeg_muxer";
-
-            // Ensure base path exists
-            auto path = obs_data_get_string(settings, "path");
-            os_mkdirs(path);
-
-            OBSDataAutoRelease recordingSettings = createRecordingSettings(settings);
-            recordingOutput = obs_output_create(outputId, qUtf8Printable(name), recordingSettings, nullptr);
-            if (!recordingOutput) {
-                obs_log(LOG_ERROR, "%s: Recording output creation failed", qUtf8Printable(name));
+        if (standbyOnly) {
+            //--- Stand by ---//
+            if (config->streamRecording && !createRecordingOutput(*config)) {
                 return;
             }
 
-            size_t encIndex = 0;
-            for (size_t i = 0; i < MAX_AUDIO_MIXES; i++) {
-                auto audioContext = &audios[i];
-                if (!audioContext->encoder || !audioContext->recording) {
-                    continue;
-                }
-
-                obs_output_set_audio_encoder(recordingOutput, audioContext->encoder, encIndex++);
-            }
-
-            if (!encIndex) {
-                // No audio encoder -> fallback first available encoder
-                for (size_t i = 0; i < MAX_AUDIO_MIXES; i++) {
-                    auto audioContext = &audios[i];
-                    if (audioContext->encoder) {
+            if (config->warmStandbyEncoders) {
+                // Initialize encoders now (Hardware encoders hold their sessions until outputs stop)
+                for (size_t i = 0; i < streamings.size(); i++) {
+                    if (streamings[i].output && attachStreamingEncoders(i) &&
+                        !obs_output_initialize_encoders(streamings[i].output, 0)) {
                         obs_log(
-                            LOG_WARNING, "%s: No audio encoder selected for recording, using track %d",
-                            qUtf8Printable(name), i + 1
+                            LOG_WARNING, "%s: Encoder initialization failed for streaming %zu", qUtf8Printable(name), i
                         );
-                        obs_output_set_audio_encoder(recordingOutput, audioContext->encoder, encIndex++);
-                        break;
                     }
                 }
-                if (!encIndex) {
-                    obs_log(LOG_ERROR, "%s: No audio encoder for recording", qUtf8Printable(name));
-                    return;
+                if (recordingOutput && !obs_output_initialize_encoders(recordingOutput, 0)) {
+                    obs_log(LOG_WARNING, "%s: Encoder initialization failed for recording", qUtf8Printable(name));
                 }
+            } else {
+                // Uninitialized encoders hold no hardware session until outputs start
+                setStandbyEncodersIdle(true);
             }
 
-            obs_output_set_video_encoder(recordingOutput, videoEncoder);
+            standby = true;
+            obs_log(LOG_INFO, "%s: Standing by", qUtf8Printable(name));
+            return;
+        }
 
-            // Start recording output
-            if (obs_output_start(recordingOutput)) {
-                recordingActive = true;
-                obs_source_inc_showing(obs_filter_get_parent(filterSource));
-                obs_log(LOG_INFO, "%s: Starting recording output succeeded", qUtf8Printable(name));
-            } else {
-                obs_log(LOG_ERROR, "%s: Starting recording output failed", qUtf8Printable(name));
-            }
+        //--- Start recording output (if requested) ---//
+        if (config->streamRecording && !startRecordingOutput(*config)) {
+            return;
+        }
+
+        //--- Start replay buffer output (if requested) ---//
+        if (config->replayBuffer && !startReplayBufferOutput(*config)) {
+            return;
         }
 
         //--- Start streaming output (if requested) ---//
-        for (size_t i = 0; i < MAX_SERVICES; i++) {
+        startStreamingOutputs();
+    }
+}
+
+// Must be called with outputMutex locked
+void BranchOutputFilter::startStreamingOutputs()
+{
+    // obs_output_start() returns immediately and connects in output's own thread, so services connect in parallel
+    for (size_t i = 0; i < streamings.size(); i++) {
+        if (streamings[i].output) {
+            StreamingSupervisor::beginConnectAttempt(streamings[i]);
             startStreamingOutput(i);
         }
     }
 }
 
-void BranchOutputFilter::reconnectStreamingOutput(size_t index)
+// Start outputs prepared in warm standby (Only obs_output_start() is left)
+// Called in UI thread (Same as supervision)
+void BranchOutputFilter::activateStandby()
 {
+    OBSDataAutoRelease settings = obs_source_get_settings(filterSource);
+    auto config = getParsedSettings(settings);
+
     pthread_mutex_lock(&outputMutex);
     {
         OBSMutexAutoUnlock locked(&outputMutex);
 
-        if (streamings[index].active) {
-            obs_output_force_stop(streamings[index].output);
+        if (!standby) {
+            return;
+        }
+        standby = false;
+
+        obs_log(LOG_INFO, "%s: Activating warm standby", qUtf8Printable(name));
+
+        if (recordingOutput) {
+            startRecordingOutput(*config);
+        }
+        if (config->replayBuffer) {
+            startReplayBufferOutput(*config);
+        }
+        startStreamingOutputs();
 
-            streamings[index].connectAttemptingAt = os_gettime_ns();
+        // Starting encoders hold their sessions from now on
+        setStandbyEncodersIdle(false);
+    }
+}
+
+// Must be called with outputMutex locked
+void BranchOutputFilter::setStandbyEncodersIdle(bool idle)
+{
+    if (standbyEncodersIdle == idle) {
+        return;
+    }
+    standbyEncodersIdle = idle;
+
+    auto engine = VideoEngine::getInstance();
+    if (videoEncoder) {
+        engine->setStandbyIdle(videoEncoder, idle);
+    }
+    for (size_t i = 0; i < streamings.size(); i++) {
+        if (streamings[i].videoEncoder) {
+            engine->setStandbyIdle(streamings[i].videoEncoder, idle);
+        }
+    }
+}
+
+// Run startOutput() in worker thread not to freeze UI thread
+// The scheduler staggers startups of all filters by priority
+void BranchOutputFilter::startOutputAsync(obs_data_t *settings, bool standbyOnly)
+{
+    if (starting.exchange(true)) {
+        // Already starting (or queued)
+        return;
+    }
+
+    auto priority = getParsedSettings(settings)->startPriority;
+    // Frontend is asked here in UI thread
+    profileFilenameFormatting = config_get_string(obs_frontend_get_profile_config(), "Output", "FilenameFormatting");
+    OBSData data = settings;
+    OutputStartScheduler::getInstance()->schedule(this, priority, [this, data, standbyOnly]() {
+        auto startedAt = os_gettime_ns();
+        startOutput(data, standbyOnly);
+        startOutputDurationNs = os_gettime_ns() - startedAt;
+        starting = false;
+
+        // Conditions may have changed during startup
+        requestSupervise();
+    });
+}
+
+void BranchOutputFilter::reconnectStreamingOutput(size_t index)
+{
+    pthread_mutex_lock(&outputMutex);
+    {
+        OBSMutexAutoUnlock locked(&outputMutex);
 
-            if (!obs_output_start(streamings[index].output)) {
+        if (streamings[index].active) {
+            countReconnect(streamings[index].output);
+            if (!StreamingSupervisor::reconnect(streamings[index])) {
                 obs_log(LOG_ERROR, "%s: Reconnect streaming %zu output failed", qUtf8Printable(name), index);
             }
         }
     }
 }
 
+void BranchOutputFilter::scheduleReconnectWake(uint64_t waitMs)
+{
+    // Keep only the earliest one (Interval timer covers long waits anyway)
+    auto wakeAt = os_gettime_ns() + waitMs * 1000000ULL;
+    if (waitMs >= TASK_INTERVAL_MS || (reconnectWakeAt && reconnectWakeAt <= wakeAt)) {
+        return;
+    }
+
+    reconnectWakeAt = wakeAt;
+    QTimer::singleShot((int)waitMs, this, [this]() {
+        reconnectWakeAt = 0;
+        requestSupervise();
+    });
+}
+
 void BranchOutputFilter::restartRecordingOutput()
 {
     pthread_mutex_lock(&outputMutex);
@@ -859,20 +1351,69 @@ void BranchOutputFilter::restartRecordingOutput()
     }
 }
 
+void BranchOutputFilter::restartReplayBufferOutput()
+{
+    pthread_mutex_lock(&outputMutex);
+    {
+        OBSMutexAutoUnlock locked(&outputMutex);
+
+        if (replayBufferActive) {
+            obs_output_force_stop(replayBufferOutput);
+
+            if (!obs_output_start(replayBufferOutput)) {
+                obs_log(LOG_ERROR, "%s: Restart replay buffer output failed", qUtf8Printable(name));
+            }
+        }
+    }
+}
+
+// Write buffered packets to a file (Hotkey thread or UI thread)
+void BranchOutputFilter::saveReplayBuffer()
+{
+    if (starting) {
+        return;
+    }
+
+    pthread_mutex_lock(&outputMutex);
+    {
+        OBSMutexAutoUnlock locked(&outputMutex);
+
+        if (!replayBufferOutput || !obs_output_active(replayBufferOutput)) {
+            obs_log(LOG_WARNING, "%s: Replay buffer is not active", qUtf8Printable(name));
+            return;
+        }
+
+        // Writing is done in replay buffer's own thread
+        calldata_t cd = {0};
+        auto ph = obs_output_get_proc_handler(replayBufferOutput);
+        proc_handler_call(ph, "save", &cd);
+        calldata_free(&cd);
+        obs_log(LOG_INFO, "%s: Saving replay buffer", qUtf8Printable(name));
+    }
+}
+
 void BranchOutputFilter::loadRecently(obs_data_t *settings)
 {
     obs_log(LOG_DEBUG, "Recently settings loading");
     OBSString path = obs_module_get_config_path(obs_current_module(), SETTINGS_JSON_NAME);
-    OBSDataAutoRelease recently_settings = obs_data_create_from_json_file(path);
+    OBSDataAutoRelease recently_settings = SettingsFileWriter::getInstance()->load(QString::fromUtf8(path));
 
     if (recently_settings) {
-        for (size_t i = 0; i < MAX_SERVICES; i++) {
-            auto propNameFormat = getIndexedPropNameFormat(i);
-            obs_data_erase(recently_settings, qUtf8Printable(propNameFormat.arg("server")));
-            obs_data_erase(recently_settings, qUtf8Printable(propNameFormat.arg("key")));
-            obs_data_erase(recently_settings, qUtf8Printable(propNameFormat.arg("use_auth")));
-            obs_data_erase(recently_settings, qUtf8Printable(propNameFormat.arg("username")));
-            obs_data_erase(recently_settings, qUtf8Printable(propNameFormat.arg("password")));
+        // Services may be saved as many as "service_count" (Collect first, erasing breaks iteration)
+        const char *serviceNames[] = {"server", "key", "use_auth", "username", "password", "custom_rendition"};
+        QStringList serviceItemNames;
+        for (auto item = obs_data_first(recently_settings); item; obs_data_item_next(&item)) {
+            QString itemName = obs_data_item_get_name(item);
+            size_t index = 0;
+            for (auto serviceName : serviceNames) {
+                if (parseIndexedPropName(itemName, serviceName, &index)) {
+                    serviceItemNames.push_back(itemName);
+                    break;
+                }
+            }
+        }
+        foreach (auto &itemName, serviceItemNames) {
+            obs_data_erase(recently_settings, qUtf8Printable(itemName));
         }
 
         obs_data_erase(recently_settings, "stream_recording");
@@ -896,77 +1437,229 @@ void BranchOutputFilter::loadRecently(obs_data_t *settings)
     obs_log(LOG_INFO, "Recently settings loaded");
 }
 
-void BranchOutputFilter::restartOutput()
+// Apply changed settings only to affected outputs, others keep running
+// Called in UI thread (Same as supervision)
+void BranchOutputFilter::applySettings(obs_data_t *settings)
 {
-    if (countActiveStreamings() > 0 || recordingActive) {
-        stopOutput();
+    auto config = getParsedSettings(settings);
+    auto values = getSettingsValues(settings);
+    auto restartRequired = false;
+
+    pthread_mutex_lock(&outputMutex);
+    {
+        OBSMutexAutoUnlock locked(&outputMutex);
+
+        // Classify changed keys (Everything else like encoders, audio, resolution... is shared by all outputs)
+        auto oldCount = (size_t)activeSettingsValues.value("service_count").toULongLong();
+        auto newCount = (size_t)config->services.size();
+        auto sharedChanged = false;
+        auto recordingChanged = false;
+        auto replayBufferChanged = false;
+        QSet<size_t> changedStreamings;
+
+        auto keys = QSet<QString>(activeSettingsValues.keyBegin(), activeSettingsValues.keyEnd());
+        keys.unite(QSet<QString>(values.keyBegin(), values.keyEnd()));
+
+        foreach (auto &key, keys) {
+            if (activeSettingsValues.value(key) == values.value(key)) {
+                continue;
+            }
+
+            auto classified = false;
+            for (auto name : recordingSettingNames) {
+                if (key == name) {
+                    recordingChanged = classified = true;
+                    break;
+                }
+            }
+            for (auto name : replayBufferSettingNames) {
+                if (!classified && key == name) {
+                    replayBufferChanged = classified = true;
+                }
+            }
+            for (auto name : streamingSettingNames) {
+                size_t index = 0;
+                if (!classified && parseIndexedPropName(key, name, &index)) {
+                    changedStreamings.insert(index);
+                    classified = true;
+                }
+            }
+            for (auto name : passiveSettingNames) {
+                classified = classified || key == name;
+            }
+
+            sharedChanged = sharedChanged || !classified;
+        }
+
+        // Adaptive encoder is exclusive only while recording doesn't use it, so toggling recording recreates it
+        if (config->adaptiveBitrate && config->adaptiveBitratePriority != "streaming" &&
+            activeSettingsValues.value("stream_recording") != values.value("stream_recording")) {
+            sharedChanged = true;
+        }
+
+        // Added or removed streamings
+        for (auto i = qMin(oldCount, newCount); i < qMax(oldCount, newCount); i++) {
+            changedStreamings.insert(i);
+        }
+
+        obs_video_info ovi = {0};
+        obs_video_info encvi = {0};
+        restartRequired = activeSettingsValues.isEmpty() || sharedChanged || !getSourceVideoInfo(&ovi, &encvi);
+
+        if (!restartRequired) {
+            activeSettingsRev = storedSettingsRev;
+
+            //--- Recreate recording output (if changed) ---//
+            if (recordingChanged) {
+                obs_log(LOG_INFO, "%s: Recording settings changed", qUtf8Printable(name));
+                stopRecordingOutput();
+                if (config->streamRecording) {
+                    startRecordingOutput(*config);
+                }
+            }
+
+            //--- Recreate replay buffer output (if changed) ---//
+            // Saved files follow recording path and format as well
+            if (replayBufferChanged || recordingChanged) {
+                obs_log(LOG_INFO, "%s: Replay buffer settings changed", qUtf8Printable(name));
+                stopReplayBufferOutput();
+                if (config->replayBuffer) {
+                    startReplayBufferOutput(*config);
+                }
+            }
+
+            //--- Recreate streaming output(s) (if changed) ---//
+            // Removed ones are released before the table shrinks
+            for (auto i = newCount; i < streamings.size(); i++) {
+                obs_log(LOG_INFO, "%s: Streaming %zu removed", qUtf8Printable(name), i);
+                stopStreamingOutput(i);
+            }
+            streamings.resize(newCount);
+
+            for (size_t i = 0; i < newCount; i++) {
+                if (!changedStreamings.contains(i)) {
+                    continue;
+                }
+
+                obs_log(LOG_INFO, "%s: Streaming %zu settings changed", qUtf8Printable(name), i);
+                stopStreamingOutput(i);
+
+                streamings[i] = createSreaming(*config, i);
+                if (!streamings[i].output) {
+                    continue;
+                }
+                StreamingSupervisor::beginConnectAttempt(streamings[i]);
+                connectOutputSignals(streamings[i].output, streamings[i].outputSignals);
+
+                setupRenditionEncoder(settings, *config, i, &ovi, &encvi);
+                startStreamingOutput(i);
+            }
+
+            activeSettingsValues = values;
+        }
     }
 
-    OBSDataAutoRelease settings = obs_source_get_settings(filterSource);
-    if (countEnabledStreamings(settings) > 0 || isRecordingEnabled(settings)) {
-        startOutput(settings);
+    if (restartRequired) {
+        obs_log(LOG_INFO, "%s: Shared settings changed, Attempting restart", qUtf8Printable(name));
+        restartOutput();
+        return;
     }
-}
 
-bool BranchOutputFilter::connectAttemptingTimedOut(size_t index)
-{
-    return streamings[index].connectAttemptingAt &&
-           os_gettime_ns() - streamings[index].connectAttemptingAt > CONNECT_ATTEMPTING_TIMEOUT_NS;
+    if (countActiveStreamings() == 0 && !recordingActive && !replayBufferActive) {
+        // Nothing left -> Release encoders and audio captures
+        stopOutput();
+    }
 }
 
-bool BranchOutputFilter::everyConnectAttemptingsTimedOut()
+// Settings are parsed once per revision (Indexed property lookups are slow for hot paths)
+// Thread-safe (Startup in worker thread reads it too)
+QSharedPointer<const FilterSettings> BranchOutputFilter::getParsedSettings(obs_data_t *settings)
 {
-    for (size_t i = 0; i < MAX_SERVICES; i++) {
-        if (streamings[i].output && !connectAttemptingTimedOut(i)) {
-            return false;
-        }
+    QMutexLocker locker(&parsedSettingsMutex);
+
+    if (!parsedSettings || parsedSettingsRev != storedSettingsRev || parsedSettingsData != settings) {
+        parsedSettings = FilterSettings::parse(settings);
+        parsedSettingsData = settings;
+        parsedSettingsRev = storedSettingsRev;
     }
-    return true;
+
+    return parsedSettings;
 }
 
-int BranchOutputFilter::countEnabledStreamings(obs_data_t *settings)
+void BranchOutputFilter::restartOutput()
 {
-    int count = 0;
-    auto serviceCount = (size_t)obs_data_get_int(settings, "service_count");
-    for (size_t i = 0; i < MAX_SERVICES && i < serviceCount; i++) {
-        if (isStreamingEnabled(settings, i)) {
-            count++;
-        }
+    if (countActiveStreamings() > 0 || recordingActive || replayBufferActive) {
+        stopOutput();
+    }
+
+    OBSDataAutoRelease settings = obs_source_get_settings(filterSource);
+    auto config = getParsedSettings(settings);
+    if (config->hasOutputs()) {
+        startOutputAsync(settings);
     }
-    return count;
 }
 
 int BranchOutputFilter::countAliveStreamings()
 {
-    int count = 0;
-    for (size_t i = 0; i < MAX_SERVICES; i++) {
-        if (streamings[i].output && obs_output_active(streamings[i].output)) {
-            count++;
-        }
-    }
-    return count;
+    return StreamingSupervisor::countAlive(streamings);
 }
 
 int BranchOutputFilter::countActiveStreamings()
 {
-    int count = 0;
-    for (size_t i = 0; i < MAX_SERVICES; i++) {
-        if (streamings[i].active) {
-            count++;
-        }
+    return StreamingSupervisor::countActive(streamings);
+}
+
+bool BranchOutputFilter::isVideoEncoderFallback(size_t streamingIndex, bool recording)
+{
+    if (!recording && streamingIndex < streamings.size() && streamings[streamingIndex].videoEncoder) {
+        // Custom rendition
+        return streamings[streamingIndex].videoEncoderFallback;
     }
-    return count;
+    return videoEncoderFallback;
 }
 
-bool BranchOutputFilter::isStreamingEnabled(obs_data_t *settings, size_t index)
+bool BranchOutputFilter::isInterlockSatisfied(int interlockType)
 {
-    auto propNameFormat = getIndexedPropNameFormat(index);
-    return !!strlen(obs_data_get_string(settings, qUtf8Printable(propNameFormat.arg("server"))));
+    switch (interlockType) {
+    case INTERLOCK_TYPE_STREAMING:
+        return obs_frontend_streaming_active();
+    case INTERLOCK_TYPE_RECORDING:
+        return obs_frontend_recording_active();
+    case INTERLOCK_TYPE_STREAMING_RECORDING:
+        return obs_frontend_streaming_active() || obs_frontend_recording_active();
+    case INTERLOCK_TYPE_VIRTUAL_CAM:
+        return obs_frontend_virtualcam_active();
+    default:
+        return true;
+    }
 }
 
-bool BranchOutputFilter::isRecordingEnabled(obs_data_t *settings)
+// Adjust bitrate of adaptive encoders following congestion of the streams (Thread-safe)
+void BranchOutputFilter::onBitrateTimerTimeout()
 {
-    return obs_data_get_bool(settings, "stream_recording");
+    // Never block UI thread while outputs are being replaced by worker thread
+    if (starting || pthread_mutex_trylock(&outputMutex)) {
+        return;
+    }
+    OBSMutexAutoUnlock locked(&outputMutex);
+
+    QList<obs_output_t *> sharedEncoderOutputs;
+    for (size_t i = 0; i < streamings.size(); i++) {
+        auto output = streamings[i].output.Get();
+        if (!streamings[i].active || !output || !obs_output_active(output) || obs_output_reconnecting(output)) {
+            continue;
+        }
+
+        if (streamings[i].bitrateController) {
+            streamings[i].bitrateController->evaluate({output});
+        } else if (!streamings[i].videoEncoder) {
+            sharedEncoderOutputs.append(output);
+        }
+    }
+
+    if (bitrateController && !sharedEncoderOutputs.isEmpty()) {
+        bitrateController->evaluate(sharedEncoderOutputs);
+    }
 }
 
 // Controlling output status here.
@@ -974,96 +1667,109 @@ bool BranchOutputFilter::isRecordingEnabled(obs_data_t *settings)
 // NOTE: Becareful this function is called so offen.
 void BranchOutputFilter::onIntervalTimerTimeout()
 {
+    TRACE_SCOPE(TRACE_SITE_INTERVAL_TIMER);
+
     // Block output initiation until filter is active.
     if (!initialized) {
         return;
     }
 
+    // Outputs are being replaced by worker thread (Supervised again after that)
+    if (starting) {
+        return;
+    }
+
+    // Reconnecting outputs stop their encoders without "deactivate" signal
+    VideoEngine::getInstance()->updateViewActivity();
+
     auto interlockType = statusDock ? statusDock->getInterlockType() : INTERLOCK_TYPE_ALWAYS_ON;
     auto sourceEnabled = obs_source_enabled(filterSource);
 
-    if (countActiveStreamings() == 0 && !recordingActive) {
+    if (countActiveStreamings() == 0 && !recordingActive && !replayBufferActive) {
         // Evaluate start condition
         auto parent = obs_filter_get_parent(filterSource);
         if (!parent || !sourceInFrontend(parent)) {
             // Ignore when source in no longer exists in frontend
+            if (standby) {
+                stopOutput();
+            }
             return;
         }
 
         if (sourceEnabled) {
             // Clicked filter's "Eye" icon (Show)
             // Check interlock condition
-            if (interlockType == INTERLOCK_TYPE_STREAMING) {
-                if (obs_frontend_streaming_active()) {
-                    restartOutput();
-                    return;
-                }
-            } else if (interlockType == INTERLOCK_TYPE_RECORDING) {
-                if (obs_frontend_recording_active()) {
-                    restartOutput();
-                    return;
-                }
-            } else if (interlockType == INTERLOCK_TYPE_STREAMING_RECORDING) {
-                if (obs_frontend_streaming_active() || obs_frontend_recording_active()) {
-                    restartOutput();
-                    return;
-                }
-            } else if (interlockType == INTERLOCK_TYPE_VIRTUAL_CAM) {
-                if (obs_frontend_virtualcam_active()) {
+            if (isInterlockSatisfied(interlockType)) {
+                if (standby && activeSettingsRev == storedSettingsRev) {
+                    activateStandby();
+                } else {
                     restartOutput();
-                    return;
                 }
-            } else {
-                restartOutput();
                 return;
             }
+
+            // Prepare outputs while waiting for interlock (Warm standby)
+            OBSDataAutoRelease settings = obs_source_get_settings(filterSource);
+            auto config = getParsedSettings(settings);
+            auto warmStandby = config->warmStandby;
+
+            if (standby) {
+                auto sourceWidth = obs_source_get_width(parent);
+                sourceWidth += (sourceWidth & 1);
+                auto sourceHeight = obs_source_get_height(parent);
+                sourceHeight += (sourceHeight & 1);
+                auto resized = !letterbox && (width != sourceWidth || height != sourceHeight);
+
+                if (!warmStandby || activeSettingsRev < storedSettingsRev || resized) {
+                    // Prepared outputs are stale
+                    stopOutput();
+                }
+            }
+
+            auto now = os_gettime_ns();
+            if (warmStandby && !standby && now - standbyAttemptedAt > (uint64_t)TASK_INTERVAL_MS * 1000000ULL &&
+                config->hasOutputs()) {
+                // Attempt once per polling interval at most (Preparing may fail)
+                standbyAttemptedAt = now;
+                obs_log(LOG_INFO, "%s: Preparing warm standby", qUtf8Printable(name));
+                startOutputAsync(settings, true);
+            }
+
+        } else if (standby) {
+            // Clicked filter's "Eye" icon (Hide)
+            stopOutput();
         }
 
     } else {
         // Evaluate stop or restart condition
         auto streamingAlive = countAliveStreamings() > 0;
         auto recordingAlive = recordingOutput && obs_output_active(recordingOutput);
+        auto replayBufferAlive = replayBufferOutput && obs_output_active(replayBufferOutput);
 
         if (sourceEnabled) {
-            if (countActiveStreamings() > 0 && !everyConnectAttemptingsTimedOut()) {
+            // Wait for results of connect attempts
+            if (!StreamingSupervisor::settle(streamings)) {
                 return;
             }
 
             // Check interlock condition
-            if (interlockType == INTERLOCK_TYPE_STREAMING) {
-                if (!obs_frontend_streaming_active()) {
-                    // Stop output when streaming is not active
-                    stopOutput();
-                    return;
-                }
-            } else if (interlockType == INTERLOCK_TYPE_RECORDING) {
-                if (!obs_frontend_recording_active()) {
-                    // Stop output when recording is not active
-                    stopOutput();
-                    return;
-                }
-            } else if (interlockType == INTERLOCK_TYPE_STREAMING_RECORDING) {
-                if (!obs_frontend_streaming_active() && !obs_frontend_recording_active()) {
-                    // Stop output when streaming and recording are not active
-                    stopOutput();
-                    return;
-                }
-            } else if (interlockType == INTERLOCK_TYPE_VIRTUAL_CAM) {
-                if (!obs_frontend_virtualcam_active()) {
-                    // Stop output when virtual cam is not active
-                    stopOutput();
-                    return;
-                }
+            if (!isInterlockSatisfied(interlockType)) {
+                // Stop output when interlocked frontend output is not active
+                stopOutput();
+                // Evaluate again for warm standby
+                requestSupervise();
+                return;
             }
 
             if (activeSettingsRev < storedSettingsRev) {
                 // Settings has been changed
-                obs_log(LOG_INFO, "%s: Settings change detected, Attempting restart", qUtf8Printable(name));
-                restartOutput();
+                obs_log(LOG_INFO, "%s: Settings change detected, Applying changes", qUtf8Printable(name));
+                OBSDataAutoRelease settings = obs_source_get_settings(filterSource);
+                applySettings(settings);
                 return;
             }
 
-            if (streamingAlive || recordingAlive) {
+            if (streamingAlive || recordingAlive || replayBufferAlive) {
                 // Monitoring source
                 auto parent = obs_filter_get_parent(filterSource);
                 auto sourceWidth = obs_source_get_width(parent);
@@ -1071,18 +1777,45 @@ void BranchOutputFilter::onIntervalTimerTimeout()
                 uint32_t sourceHeight = obs_source_get_height(parent);
                 sourceHeight += (sourceHeight & 1);
 
-                if (!sourceWidth || !sourceHeight || !sourceInFrontend(parent)) {
-                    // Stop output when source resolution is zero or source had been removed
+                if (!sourceInFrontend(parent)) {
+                    // Stop output when source had been removed
                     stopOutput();
                     return;
                 }
 
                 if (width != sourceWidth || height != sourceHeight) {
-                    // Restart output when source resolution was changed.
-                    obs_log(LOG_INFO, "%s: Attempting restart the stream output", qUtf8Printable(name));
-                    OBSDataAutoRelease settings = obs_source_get_settings(filterSource);
-                    startOutput(settings);
-                    return;
+                    // Transitions and device renegotiation resize source briefly, so wait until it settles
+                    auto now = os_gettime_ns();
+                    if (!resizedAt || resizedWidth != sourceWidth || resizedHeight != sourceHeight) {
+                        obs_log(
+                            LOG_DEBUG, "%s: Source resized to %ux%u", qUtf8Printable(name), sourceWidth, sourceHeight
+                        );
+                        resizedWidth = sourceWidth;
+                        resizedHeight = sourceHeight;
+                        resizedAt = now;
+                        QTimer::singleShot(RESIZE_SETTLE_MS, Qt::PreciseTimer, this, [this]() {
+                            requestSupervise();
+                        });
+
+                    } else if (now - resizedAt >= (uint64_t)RESIZE_SETTLE_MS * 1000000ULL) {
+                        if (!sourceWidth || !sourceHeight) {
+                            // Stop output when source resolution is zero
+                            stopOutput();
+                            return;
+                        }
+
+                        if (!letterbox) {
+                            // Restart output when source resolution was changed.
+                            obs_log(LOG_INFO, "%s: Attempting restart the stream output", qUtf8Printable(name));
+                            OBSDataAutoRelease settings = obs_source_get_settings(filterSource);
+                            startOutputAsync(settings);
+                            return;
+                        }
+
+                        // Keep going (Source is fitted into locked size by view)
+                    }
+                } else {
+                    resizedAt = 0;
                 }
             }
 
@@ -1092,16 +1825,19 @@ void BranchOutputFilter::onIntervalTimerTimeout()
                 restartRecordingOutput();
             }
 
-            for (size_t i = 0; i < MAX_SERVICES; i++) {
-                if (streamings[i].active && streamings[i].output && !obs_output_active(streamings[i].output)) {
-                    // Restart streaming
-                    obs_log(LOG_INFO, "%s: Attempting reactivate the stream output %zu", qUtf8Printable(name), i);
-                    reconnectStreamingOutput(i);
-                }
+            if (replayBufferActive && !replayBufferAlive) {
+                obs_log(LOG_INFO, "%s: Attempting reactivate the replay buffer output", qUtf8Printable(name));
+                restartReplayBufferOutput();
             }
 
+            // libobs gave up, so restart streaming with backoff shared by the same ingest host
+            StreamingSupervisor::reconnectGaveUp(
+                name, streamings, [this](size_t i) { reconnectStreamingOutput(i); },
+                [this](uint64_t waitMs) { scheduleReconnectWake(waitMs); }
+            );
+
         } else {
-            if (streamingAlive || recordingAlive) {
+            if (streamingAlive || recordingAlive || replayBufferAlive) {
                 // Clicked filter's "Eye" icon (Hide)
                 stopOutput();
                 return;
@@ -1140,6 +1876,16 @@ bool BranchOutputFilter::onDisableFilterHotkeyPressed(void *data, obs_hotkey_pai
     return true;
 }
 
+void BranchOutputFilter::onSaveReplayHotkeyPressed(void *data, obs_hotkey_id, obs_hotkey *, bool pressed)
+{
+    if (!pressed) {
+        return;
+    }
+
+    auto filter = static_cast<BranchOutputFilter *>(data);
+    filter->saveReplayBuffer();
+}
+
 void BranchOutputFilter::registerHotkey()
 {
     if (hotkeyPairId != OBS_INVALID_HOTKEY_PAIR_ID) {
@@ -1156,19 +1902,90 @@ void BranchOutputFilter::registerHotkey()
         obs_filter_get_parent(filterSource), qUtf8Printable(name0), qUtf8Printable(description0), qUtf8Printable(name1),
         qUtf8Printable(description1), onEnableFilterHotkeyPressed, onDisableFilterHotkeyPressed, this, this
     );
+
+    if (saveReplayHotkeyId != OBS_INVALID_HOTKEY_ID) {
+        obs_hotkey_unregister(saveReplayHotkeyId);
+    }
+
+    auto name2 = QString("SaveReplay.%1").arg(obs_source_get_uuid(filterSource));
+    auto description2 = QString(obs_module_text("SaveReplayHotkey")).arg(name);
+
+    saveReplayHotkeyId = obs_hotkey_register_source(
+        obs_filter_get_parent(filterSource), qUtf8Printable(name2), qUtf8Printable(description2),
+        onSaveReplayHotkeyPressed, this
+    );
+}
+
+void BranchOutputFilter::connectOutputSignals(obs_output_t *output, OBSSignal outputSignals[])
+{
+    static const char *signalNames[SUPERVISED_OUTPUT_SIGNALS] = {
+        "start", "stop", "reconnect", "reconnect_success", "activate", "deactivate"
+    };
+    static const signal_callback_t callbacks[SUPERVISED_OUTPUT_SIGNALS] = {
+        onSuperviseSignal, onSuperviseSignal, onReconnectSignal, onSuperviseSignal, onActivitySignal, onActivitySignal
+    };
+
+    auto handler = obs_output_get_signal_handler(output);
+    for (size_t i = 0; i < SUPERVISED_OUTPUT_SIGNALS; i++) {
+        outputSignals[i].Connect(handler, signalNames[i], callbacks[i], this);
+    }
+}
+
+// This method possibly called in different thread from UI thread
+void BranchOutputFilter::requestSupervise()
+{
+    // Coalesce bursts of signals into single supervision
+    if (!supervisePending.exchange(true)) {
+        QMetaObject::invokeMethod(this, "onSuperviseRequested", Qt::QueuedConnection);
+    }
+}
+
+// This method possibly called in different thread from UI thread
+void BranchOutputFilter::countReconnect(obs_output_t *output)
+{
+    QMutexLocker locker(&metricsMutex);
+    reconnectCounts[output]++;
+}
+
+void BranchOutputFilter::onSuperviseRequested()
+{
+    supervisePending = false;
+    onIntervalTimerTimeout();
+}
+
+// Callback from output/source signals (Any thread)
+void BranchOutputFilter::onSuperviseSignal(void *data, calldata_t *)
+{
+    auto filter = static_cast<BranchOutputFilter *>(data);
+    filter->requestSupervise();
+}
+
+// Callback from output "reconnect" signal (Output's reconnect thread)
+void BranchOutputFilter::onReconnectSignal(void *data, calldata_t *cd)
+{
+    auto filter = static_cast<BranchOutputFilter *>(data);
+    filter->countReconnect(static_cast<obs_output_t *>(calldata_ptr(cd, "output")));
+    filter->requestSupervise();
+}
+
+// Callback from output "activate"/"deactivate" signals (Output's thread, encoders have just started/stopped)
+void BranchOutputFilter::onActivitySignal(void *data, calldata_t *)
+{
+    auto filter = static_cast<BranchOutputFilter *>(data);
+    // Resume the view right away, encoders take frames from now on
+    VideoEngine::getInstance()->updateViewActivity();
+    filter->requestSupervise();
 }
 
 // Callback from filter audio
 obs_audio_data *BranchOutputFilter::audioFilterCallback(void *param, obs_audio_data *audioData)
 {
+    TRACE_SCOPE(TRACE_SITE_AUDIO_FILTER_CALLBACK);
+
     auto filter = static_cast<BranchOutputFilter *>(param);
 
-    for (size_t i = 0; i < MAX_AUDIO_MIXES; i++) {
-        auto audioContext = &filter->audios[i];
-        if (audioContext->capture && !audioContext->capture->hasSource()) {
-            audioContext->capture->pushAudio(audioData);
-        }
-    }
+    // Push once, every "filter" track reads it through own cursor (Discarded immediately when nobody reads)
+    AudioCapture::pushAudio(filter->filterAudioBuffer.data(), filter->name, audioData);
 
     return audioData;
 }
@@ -1223,12 +2040,24 @@ obs_source_info BranchOutputFilter::createFilterInfo()
 //--- OBS Plugin Callbacks ---//
 
 obs_source_info filterInfo;
+obs_source_info mirrorInfo;
 
 bool obs_module_load()
 {
+    // Create engines before any worker thread uses them
+    AudioEngine::getInstance();
+    VideoEngine::getInstance();
+    OutputStartScheduler::getInstance();
+    SettingsFileWriter::getInstance();
+    ReconnectCoordinator::getInstance();
+    RecordingSpooler::getInstance();
+
     filterInfo = BranchOutputFilter::createFilterInfo();
     obs_register_source(&filterInfo);
+    mirrorInfo = MainCanvasMirror::createSourceInfo();
+    obs_register_source(&mirrorInfo);
 
+    obs_log(LOG_DEBUG, "Audio mix kernel: %s", mixAndClampKernelName());
     obs_log(LOG_INFO, "Plugin loaded successfully (version %s)", PLUGIN_VERSION);
     return true;
 }
@@ -1237,10 +2066,25 @@ void obs_module_post_load()
 {
     qRegisterMetaType<BranchOutputFilter *>();
 
+    SourceMembershipIndex::createInstance();
+    MetricsExporter::createInstance();
     statusDock = BranchOutputFilter::createOutputStatusDock();
 }
 
 void obs_module_unload()
 {
+    OutputStartScheduler::destroyInstance();
+    SettingsFileWriter::destroyInstance();
+    ReconnectCoordinator::destroyInstance();
+    RecordingSpooler::destroyInstance();
+    AudioEngine::destroyInstance();
+    VideoEngine::destroyInstance();
+    SourceMembershipIndex::destroyInstance();
+    MetricsExporter::destroyInstance();
+
+#ifdef ENABLE_TRACING
+    Tracer::logHistograms();
+#endif
+
     obs_log(LOG_INFO, "Plugin unloaded");
 }
@@ -26,17 +26,29 @@ with this program. If not, see <https://www.gnu.org/licenses/>
 #include <util/threading.h>
 
 #include <QObject>
+#include <QHash>
+#include <QMap>
+#include <QMutex>
+#include <QSharedPointer>
+
+#include <atomic>
+#include <vector>
 
 #include "UI/output-status-dock.hpp"
+#include "adaptive-bitrate.hpp"
 #include "audio/audio-capture.hpp"
+#include "filter-settings.hpp"
+#include "streaming-supervisor.hpp"
 
-#define MAX_SERVICES 8
+#define MAX_FRAME_RATE_DIVISOR 6
+#define SUPERVISED_OUTPUT_SIGNALS 6
 
 class BranchOutputFilter : public QObject {
     Q_OBJECT
 
     friend class BranchOutputStatusDock;
-    friend class OutputTableRow;
+    friend class OutputTableModel;
+    friend class MetricsExporter;
 
     enum InterlockType {
         INTERLOCK_TYPE_ALWAYS_ON,
@@ -56,65 +68,133 @@ class BranchOutputFilter : public QObject {
         QString name;
     };
 
-    struct BranchOutputStreamingContext {
-        OBSOutputAutoRelease output;
+    struct BranchOutputStreamingContext : SupervisedStreaming {
         OBSServiceAutoRelease service;
-        uint64_t connectAttemptingAt;
-        bool active;
+        OBSEncoderAutoRelease videoEncoder; // Custom rendition only (Otherwise use filter's videoEncoder)
+        bool videoEncoderFallback;          // Software encoder is used instead of hardware one
+        // Custom rendition only (Streams on filter's videoEncoder are handled by filter's bitrateController)
+        QSharedPointer<AdaptiveBitrateController> bitrateController;
+        OBSSignal outputSignals[SUPERVISED_OUTPUT_SIGNALS];
     };
 
     QString name;
+    QString profileFilenameFormatting; // Frontend's default, read in UI thread before outputs are (re)started
     bool initialized; // Activate after first "Apply" click
     uint32_t storedSettingsRev;
     uint32_t activeSettingsRev;
-    QTimer *intervalTimer;
+    // Typed snapshot of settings at parsedSettingsRev (Reparsed lazily when revision goes up)
+    QMutex parsedSettingsMutex;
+    QSharedPointer<const FilterSettings> parsedSettings;
+    OBSData parsedSettingsData;
+    uint32_t parsedSettingsRev;
+    QMap<QString, QString> activeSettingsValues; // Settings which running outputs have been created with
+    QTimer *intervalTimer; // Slow fallback, supervision is mainly driven by signals
+    QTimer *bitrateTimer;  // Adaptive bitrate evaluation
+    std::atomic<bool> supervisePending;
+    uint64_t reconnectWakeAt; // Supervision is scheduled for reconnect backoff (0 means none)
+
+    // Output startup runs in scheduler's worker thread (Outputs must not be touched from UI thread while starting)
+    std::atomic<bool> starting;
+    // Outputs are prepared but not started yet (Waiting for interlock)
+    std::atomic<bool> standby;
+    bool standbyEncodersIdle; // Encoders are idle in warm standby without initialization (No hardware sessions)
+    uint64_t standbyAttemptedAt;
 
     // Filter source (Do not use OBSSourceAutoRelease)
     obs_source_t *filterSource;
 
-    // User choosed encoder
+    // User choosed encoder (Shared through VideoEngine, view is owned by VideoEngine too)
     OBSEncoderAutoRelease videoEncoder;
+    bool videoEncoderFallback; // Software encoder is used instead of hardware one
+    // Absent when adaptive bitrate is off or recording has priority over streams on the shared videoEncoder
+    QSharedPointer<AdaptiveBitrateController> bitrateController;
 
     // Video context
-    OBSView view;
-    video_t *videoOutput;
     uint32_t width;
     uint32_t height;
+    bool letterbox;  // Output size is locked and source resizes are letterboxed in view
+    bool mainCanvas; // View copies main canvas while parent is on program
+    uint32_t resizedWidth;
+    uint32_t resizedHeight;
+    uint64_t resizedAt; // Source size has been different from output since (0 means same)
 
     // Audio context
     BranchOutputAudioContext audios[MAX_AUDIO_MIXES];
+    // Filter audio is pushed once and read by every "filter" track (Lives as long as filter)
+    QSharedPointer<AudioRingBuffer> filterAudioBuffer;
 
     // Recording context
     bool recordingActive;
     OBSOutputAutoRelease recordingOutput;
+    OBSSignal recordingSignals[SUPERVISED_OUTPUT_SIGNALS];
+
+    // Replay buffer context (Keeps the last packets of recording encoders in memory, written only on save)
+    bool replayBufferActive;
+    OBSOutputAutoRelease replayBufferOutput;
+    OBSSignal replayBufferSignals[SUPERVISED_OUTPUT_SIGNALS];
 
     // Streaming context
     pthread_mutex_t outputMutex;
-    BranchOutputStreamingContext streamings[MAX_SERVICES];
+    // Sized to "service_count" when outputs start (Contexts are move-only, so std::vector instead of QList)
+    std::vector<BranchOutputStreamingContext> streamings;
+
+    // Metrics context (Read by MetricsExporter)
+    QMutex metricsMutex;
+    QHash<obs_output_t *, uint64_t> reconnectCounts; // libobs and plugin level attempts (Forgotten on release)
+    std::atomic<uint64_t> startOutputDurationNs;     // Last call (Including stopOutput() in it)
+    std::atomic<uint64_t> stopOutputDurationNs;
 
     // Hotkey context
     obs_hotkey_pair_id hotkeyPairId;
+    obs_hotkey_id saveReplayHotkeyId;
     OBSSignal filterRenamedSignal;
+    OBSSignal filterEnabledSignal;
+    OBSSignal parentUpdatedSignal;
 
-    void startOutput(obs_data_t *settings);
+    void startOutput(obs_data_t *settings, bool standbyOnly = false);
+    void startOutputAsync(obs_data_t *settings, bool standbyOnly = false);
+    void activateStandby();
+    void setStandbyEncodersIdle(bool idle);
     void stopOutput();
-    obs_data_t *createRecordingSettings(obs_data_t *settings);
-    obs_data_t *createStreamingSettings(obs_data_t *settings, size_t index = 0);
-    void determineOutputResolution(obs_data_t *settings, obs_video_info *ovi);
-    BranchOutputStreamingContext createSreaming(obs_data_t *settings, size_t index = 0);
+    void stopRecordingOutput();
+    void stopStreamingOutput(size_t index = 0);
+    bool createRecordingOutput(const FilterSettings &config);
+    bool startRecordingOutput(const FilterSettings &config);
+    bool attachRecordingEncoders(obs_output_t *output);
+    void stopReplayBufferOutput();
+    bool startReplayBufferOutput(const FilterSettings &config);
+    void restartReplayBufferOutput();
+    void saveReplayBuffer();
+    void setupRenditionEncoder(
+        obs_data_t *settings, const FilterSettings &config, size_t index, const obs_video_info *ovi,
+        const obs_video_info *encvi
+    );
+    void applySettings(obs_data_t *settings);
+    QSharedPointer<const FilterSettings> getParsedSettings(obs_data_t *settings);
+    QString createFilenameFormat(const FilterSettings &config);
+    obs_data_t *createRecordingSettings(const FilterSettings &config);
+    obs_data_t *createReplayBufferSettings(const FilterSettings &config);
+    obs_data_t *createStreamingSettings(const FilterSettings &config, size_t index = 0);
+    obs_data_t *createRenditionSettings(obs_data_t *settings, const FilterSettings &config, size_t index = 0);
+    void determineOutputResolution(const FilterResolutionSettings &resolution, obs_video_info *ovi);
+    bool getSourceVideoInfo(obs_video_info *ovi, obs_video_info *encvi);
+    BranchOutputStreamingContext createSreaming(const FilterSettings &config, size_t index = 0);
+    bool attachStreamingEncoders(size_t index = 0);
     void startStreamingOutput(size_t index = 0);
+    void startStreamingOutputs();
     void reconnectStreamingOutput(size_t index = 0);
+    void scheduleReconnectWake(uint64_t waitMs);
     void restartRecordingOutput();
     void loadRecently(obs_data_t *settings);
     void restartOutput();
-    bool connectAttemptingTimedOut(size_t index = 0);
-    bool everyConnectAttemptingsTimedOut();
-    int countEnabledStreamings(obs_data_t *settings);
     int countAliveStreamings();
     int countActiveStreamings();
-    bool isStreamingEnabled(obs_data_t *settings, size_t index = 0);
-    bool isRecordingEnabled(obs_data_t *settings);
+    bool isInterlockSatisfied(int interlockType);
+    bool isVideoEncoderFallback(size_t streamingIndex, bool recording);
     void registerHotkey();
+    void connectOutputSignals(obs_output_t *output, OBSSignal outputSignals[]);
+    void requestSupervise();
+    void countReconnect(obs_output_t *output);
 
     // Implemented in plugin-ui.cpp
     void addApplyButton(obs_properties_t *props, const char *propName = "apply");
@@ -130,6 +210,7 @@ class BranchOutputFilter : public QObject {
     // Callbacks from obs core
     static bool onEnableFilterHotkeyPressed(void *data, obs_hotkey_pair_id id, obs_hotkey *hotkey, bool pressed);
     static bool onDisableFilterHotkeyPressed(void *data, obs_hotkey_pair_id id, obs_hotkey *hotkey, bool pressed);
+    static void onSaveReplayHotkeyPressed(void *data, obs_hotkey_id id, obs_hotkey *hotkey, bool pressed);
 
     void addCallback(obs_source_t *source);
     void updateCallback(obs_data_t *settings);
@@ -138,10 +219,16 @@ class BranchOutputFilter : public QObject {
     obs_properties_t *getProperties();
 
     static obs_audio_data *audioFilterCallback(void *param, obs_audio_data *audioData);
+    static void onSuperviseSignal(void *data, calldata_t *cd);
+    static void onReconnectSignal(void *data, calldata_t *cd);
+    static void onActivitySignal(void *data, calldata_t *cd);
     static void getDefaults(obs_data_t *settings);
+    static void setServiceDefaults(obs_data_t *settings, size_t count); // Implemented in plugin-ui.cpp
 
 private slots:
     void onIntervalTimerTimeout();
+    void onBitrateTimerTimeout();
+    void onSuperviseRequested();
     void removeCallback();
 
 public:
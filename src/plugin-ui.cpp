@@ -23,11 +23,16 @@ with this program. If not, see <https://www.gnu.org/licenses/>
 #include <util/platform.h>
 #include <obs.hpp>
 
+#include <QDir>
 #include <QMainWindow>
+#include <QStandardPaths>
 
 #include "plugin-support.h"
 #include "plugin-main.hpp"
 
+// Upper bound of "service_count" input only (Streamings are allocated as many as configured)
+#define SERVICE_COUNT_INPUT_LIMIT 100
+
 inline bool encoderAvailable(const char *encoder)
 {
     const char *val;
@@ -80,6 +85,67 @@ inline void applyDefaults(obs_data_t *dest, obs_data_t *src)
     }
 }
 
+inline void addVideoEncoderItems(obs_property_t *list)
+{
+    const char *encoderId = nullptr;
+    size_t i = 0;
+    while (obs_enum_encoder_types(i++, &encoderId)) {
+        auto caps = obs_get_encoder_caps(encoderId);
+        if (caps & (OBS_ENCODER_CAP_DEPRECATED | OBS_ENCODER_CAP_INTERNAL)) {
+            // Ignore deprecated and internal
+            continue;
+        }
+
+        if (obs_get_encoder_type(encoderId) == OBS_ENCODER_VIDEO) {
+            obs_property_list_add_string(list, obs_encoder_get_display_name(encoderId), encoderId);
+        }
+    }
+}
+
+inline void addResolutionItems(obs_property_t *list)
+{
+    obs_property_list_add_string(list, obs_module_text("Resolution.Source"), "");
+    obs_property_list_add_string(list, obs_module_text("Resolution.Output"), "output");
+    obs_property_list_add_string(list, obs_module_text("Resolution.Canvas"), "canvas");
+    obs_property_list_add_string(list, obs_module_text("Resolution.ThreeQuarters"), "three_quarters");
+    obs_property_list_add_string(list, obs_module_text("Resolution.Half"), "half");
+    obs_property_list_add_string(list, obs_module_text("Resolution.Quarter"), "quarter");
+    obs_property_list_add_string(list, obs_module_text("Resolution.Custom"), "custom");
+}
+
+// Show rendition props of the service only when enabled
+inline void updateRenditionVisibility(obs_properties_t *props, obs_data_t *settings, size_t index)
+{
+    QString propNameFormat = getIndexedPropNameFormat(index);
+    auto count = (size_t)obs_data_get_int(settings, "service_count");
+    auto visible = index < count;
+    auto customRendition = obs_data_get_bool(settings, qUtf8Printable(propNameFormat.arg("custom_rendition")));
+    auto resolution = obs_data_get_string(settings, qUtf8Printable(propNameFormat.arg("rendition_resolution")));
+
+    obs_property_set_visible(
+        obs_properties_get(props, qUtf8Printable(propNameFormat.arg("custom_rendition"))), visible
+    );
+    obs_property_set_visible(
+        obs_properties_get(props, qUtf8Printable(propNameFormat.arg("rendition_resolution"))),
+        visible && customRendition
+    );
+    obs_property_set_visible(
+        obs_properties_get(props, qUtf8Printable(propNameFormat.arg("rendition_custom_width"))),
+        visible && customRendition && !strcmp(resolution, "custom")
+    );
+    obs_property_set_visible(
+        obs_properties_get(props, qUtf8Printable(propNameFormat.arg("rendition_custom_height"))),
+        visible && customRendition && !strcmp(resolution, "custom")
+    );
+    obs_property_set_visible(
+        obs_properties_get(props, qUtf8Printable(propNameFormat.arg("rendition_video_encoder"))),
+        visible && customRendition
+    );
+    obs_property_set_visible(
+        obs_properties_get(props, qUtf8Printable(propNameFormat.arg("rendition_bitrate"))), visible && customRendition
+    );
+}
+
 // Hardcoded in obs-studio/UI/window-basic-main-outputs.cpp
 inline const char *getSimpleAudioEncoder(const char *encoder)
 {
@@ -239,6 +305,15 @@ void BranchOutputFilter::getDefaults(obs_data_t *defaults)
 
     obs_data_set_default_int(defaults, "split_file_time_mins", recSplitFileTimeMins);
     obs_data_set_default_int(defaults, "split_file_size_mb", recSplitFileSizeMb);
+    // Local cache, never the (possibly roaming) profile directory
+    auto spoolPath = QDir(QStandardPaths::writableLocation(QStandardPaths::CacheLocation))
+                         .filePath("branch-output-spool");
+    obs_data_set_default_bool(defaults, "rec_spool", false);
+    obs_data_set_default_string(defaults, "rec_spool_path", qUtf8Printable(spoolPath));
+    obs_data_set_default_int(defaults, "rec_spool_limit_mb", 8192);
+    obs_data_set_default_bool(defaults, "replay_buffer", false);
+    obs_data_set_default_int(defaults, "replay_buffer_max_time_sec", 20);
+    obs_data_set_default_int(defaults, "replay_buffer_max_size_mb", 512);
     obs_data_set_default_string(defaults, "audio_source", "master_track");
     obs_data_set_default_int(defaults, "audio_track", 1);
     obs_data_set_default_string(defaults, "audio_dest", "both");
@@ -257,12 +332,47 @@ void BranchOutputFilter::getDefaults(obs_data_t *defaults)
     obs_data_set_default_string(defaults, "audio_source_6", "disabled");
     obs_data_set_default_int(defaults, "audio_track_6", 1);
     obs_data_set_default_string(defaults, "audio_dest_6", "both");
+    obs_data_set_default_bool(defaults, "audio_drift_compensation", false);
     obs_data_set_default_int(defaults, "custom_width", config_get_int(config, "Video", "OutputCX"));
     obs_data_set_default_int(defaults, "custom_height", config_get_int(config, "Video", "OutputCY"));
+    obs_data_set_default_int(defaults, "frame_rate_divisor", 1);
+    obs_data_set_default_bool(defaults, "lock_resolution", false);
+    obs_data_set_default_bool(defaults, "main_canvas", false);
+    obs_data_set_default_bool(defaults, "adaptive_bitrate", false);
+    obs_data_set_default_int(defaults, "adaptive_bitrate_min_percent", 50);
+    obs_data_set_default_string(defaults, "adaptive_bitrate_priority", "recording");
+    obs_data_set_default_int(defaults, "start_priority", 50);
+    obs_data_set_default_bool(defaults, "warm_standby", false);
+    obs_data_set_default_bool(defaults, "warm_standby_encoders", false);
+
+    obs_data_set_default_int(defaults, "service_count", 1);
+    setServiceDefaults(defaults, 1);
 
     obs_log(LOG_INFO, "Default settings applied.");
 }
 
+// Indexed service properties have defaults only as many as "service_count" (Keep settings small)
+void BranchOutputFilter::setServiceDefaults(obs_data_t *settings, size_t count)
+{
+    auto config = obs_frontend_get_profile_config();
+
+    for (size_t i = 0; i < count; i++) {
+        auto propNameFormat = getIndexedPropNameFormat(i);
+        obs_data_set_default_bool(settings, qUtf8Printable(propNameFormat.arg("custom_rendition")), false);
+        obs_data_set_default_string(settings, qUtf8Printable(propNameFormat.arg("rendition_resolution")), "half");
+        obs_data_set_default_int(
+            settings, qUtf8Printable(propNameFormat.arg("rendition_custom_width")),
+            config_get_int(config, "Video", "OutputCX")
+        );
+        obs_data_set_default_int(
+            settings, qUtf8Printable(propNameFormat.arg("rendition_custom_height")),
+            config_get_int(config, "Video", "OutputCY")
+        );
+        obs_data_set_default_string(settings, qUtf8Printable(propNameFormat.arg("rendition_video_encoder")), "");
+        obs_data_set_default_int(settings, qUtf8Printable(propNameFormat.arg("rendition_bitrate")), 2500);
+    }
+}
+
 void BranchOutputFilter::addApplyButton(obs_properties_t *props, const char *propName)
 {
     obs_properties_add_button2(
@@ -332,6 +442,58 @@ void BranchOutputFilter::createServiceProperties(obs_properties_t *props, size_t
     );
     obs_property_set_visible(password, false);
 
+    //--- Custom rendition (Scaled from the same view as other outputs) ---//
+    auto customRendition = obs_properties_add_bool(
+        props, qUtf8Printable(propNameFormat.arg("custom_rendition")), obs_module_text("CustomRendition")
+    );
+    obs_property_set_long_description(customRendition, obs_module_text("CustomRendition.Description"));
+    obs_property_set_visible(customRendition, visible);
+
+    auto renditionResolution = obs_properties_add_list(
+        props, qUtf8Printable(propNameFormat.arg("rendition_resolution")), obs_module_text("Resolution"),
+        OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_STRING
+    );
+    addResolutionItems(renditionResolution);
+    obs_property_set_visible(renditionResolution, false);
+
+    auto renditionWidth = obs_properties_add_int(
+        props, qUtf8Printable(propNameFormat.arg("rendition_custom_width")), obs_module_text("Width"), 2, 8192, 2
+    );
+    obs_property_set_visible(renditionWidth, false);
+
+    auto renditionHeight = obs_properties_add_int(
+        props, qUtf8Printable(propNameFormat.arg("rendition_custom_height")), obs_module_text("Height"), 2, 8192, 2
+    );
+    obs_property_set_visible(renditionHeight, false);
+
+    auto renditionEncoder = obs_properties_add_list(
+        props, qUtf8Printable(propNameFormat.arg("rendition_video_encoder")), obs_module_text("VideoEncoder"),
+        OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_STRING
+    );
+    obs_property_list_add_string(renditionEncoder, obs_module_text("Rendition.SameEncoder"), "");
+    addVideoEncoderItems(renditionEncoder);
+    obs_property_set_visible(renditionEncoder, false);
+
+    auto renditionBitrate = obs_properties_add_int(
+        props, qUtf8Printable(propNameFormat.arg("rendition_bitrate")), obs_module_text("Rendition.Bitrate"), 50,
+        1000000, 50
+    );
+    obs_property_int_set_suffix(renditionBitrate, " Kbps");
+    obs_property_set_visible(renditionBitrate, false);
+
+    auto renditionChangeHandler = [](void *, obs_properties_t *_props, obs_property_t *_prop, obs_data_t *settings) {
+        size_t _index = 0;
+        auto _propName = obs_property_name(_prop);
+        if (sscanf(_propName, "custom_rendition_%zu", &_index) != 1) {
+            sscanf(_propName, "rendition_resolution_%zu", &_index);
+        }
+
+        updateRenditionVisibility(_props, settings, _index);
+        return true;
+    };
+    obs_property_set_modified_callback2(customRendition, renditionChangeHandler, nullptr);
+    obs_property_set_modified_callback2(renditionResolution, renditionChangeHandler, nullptr);
+
     obs_property_set_modified_callback2(
         useAuth,
         [](void *, obs_properties_t *_props, obs_property_t *_prop, obs_data_t *settings) {
@@ -355,28 +517,44 @@ void BranchOutputFilter::createServiceProperties(obs_properties_t *props, size_t
     );
 }
 
+// Service properties are created on demand as "service_count" grows (Number of services isn't limited)
 void BranchOutputFilter::addServices(obs_properties_t *props)
 {
-    auto serviceCountList = obs_properties_add_list(
-        props, "service_count", obs_module_text("ServiceCount"), OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_INT
+    auto serviceCount = obs_properties_add_int(
+        props, "service_count", obs_module_text("ServiceCount"), 1, SERVICE_COUNT_INPUT_LIMIT, 1
     );
 
-    for (int n = 1; n <= MAX_SERVICES; n++) {
-        obs_property_list_add_int(serviceCountList, qUtf8Printable(QString("%1").arg(n)), n);
-    }
+    // Own group to keep service properties in place when appended later
+    auto servicesGroup = obs_properties_create();
+
+    OBSDataAutoRelease settings = obs_source_get_settings(filterSource);
+    auto count = (size_t)obs_data_get_int(settings, "service_count");
 
-    createServiceProperties(props, 0);
-    for (size_t i = 1; i < MAX_SERVICES; i++) {
-        createServiceProperties(props, i, false);
+    createServiceProperties(servicesGroup, 0);
+    for (size_t i = 1; i < count; i++) {
+        createServiceProperties(servicesGroup, i, false);
     }
 
+    obs_properties_add_group(props, "services_group", "", OBS_GROUP_NORMAL, servicesGroup);
+
     obs_property_set_modified_callback2(
-        serviceCountList,
-        [](void *, obs_properties_t *_props, obs_property_t *, obs_data_t *settings) {
-            auto count = obs_data_get_int(settings, "service_count");
+        serviceCount,
+        [](void *param, obs_properties_t *_props, obs_property_t *, obs_data_t *settings) {
+            auto filter = static_cast<BranchOutputFilter *>(param);
+            auto _servicesGroup = obs_property_group_content(obs_properties_get(_props, "services_group"));
+            auto count = (size_t)obs_data_get_int(settings, "service_count");
+            setServiceDefaults(settings, count);
 
-            for (int i = 0; i < MAX_SERVICES; i++) {
+            for (size_t i = 0;; i++) {
                 QString propNameFormat = getIndexedPropNameFormat(i);
+                if (!obs_properties_get(_servicesGroup, qUtf8Printable(propNameFormat.arg("server")))) {
+                    if (i >= count) {
+                        break;
+                    }
+                    // Newly added service
+                    filter->createServiceProperties(_servicesGroup, i, false);
+                }
+
                 auto useAuth = obs_data_get_bool(settings, qUtf8Printable(propNameFormat.arg("use_auth")));
 
                 obs_property_set_visible(
@@ -397,11 +575,12 @@ void BranchOutputFilter::addServices(obs_properties_t *props)
                 obs_property_set_visible(
                     obs_properties_get(_props, qUtf8Printable(propNameFormat.arg("password"))), useAuth && i < count
                 );
+                updateRenditionVisibility(_props, settings, i);
             }
 
             return true;
         },
-        nullptr
+        this
     );
 }
 
@@ -412,6 +591,28 @@ void BranchOutputFilter::addStreamGroup(obs_properties_t *props)
     // Add multi services properties
     addServices(streamGroup);
 
+    auto startPriority =
+        obs_properties_add_int_slider(streamGroup, "start_priority", obs_module_text("StartPriority"), 0, 100, 1);
+    obs_property_set_long_description(startPriority, obs_module_text("StartPriority.Description"));
+
+    auto warmStandby = obs_properties_add_bool(streamGroup, "warm_standby", obs_module_text("WarmStandby"));
+    obs_property_set_long_description(warmStandby, obs_module_text("WarmStandby.Description"));
+
+    auto warmStandbyEncoders =
+        obs_properties_add_bool(streamGroup, "warm_standby_encoders", obs_module_text("WarmStandbyEncoders"));
+    obs_property_set_long_description(warmStandbyEncoders, obs_module_text("WarmStandbyEncoders.Description"));
+
+    obs_property_set_modified_callback2(
+        warmStandby,
+        [](void *, obs_properties_t *_props, obs_property_t *, obs_data_t *settings) {
+            obs_property_set_visible(
+                obs_properties_get(_props, "warm_standby_encoders"), obs_data_get_bool(settings, "warm_standby")
+            );
+            return true;
+        },
+        nullptr
+    );
+
     // Add gap line
     obs_properties_add_text(streamGroup, "stream_recording_group", "", OBS_TEXT_INFO);
 
@@ -419,9 +620,13 @@ void BranchOutputFilter::addStreamGroup(obs_properties_t *props)
 
     auto streamRecordingChangeHandler = [](void *, obs_properties_t *_props, obs_property_t *, obs_data_t *settings) {
         auto _streamRecording = obs_data_get_bool(settings, "stream_recording");
-        obs_property_set_visible(obs_properties_get(_props, "path"), _streamRecording);
-        obs_property_set_visible(obs_properties_get(_props, "filename_formatting"), _streamRecording);
-        obs_property_set_visible(obs_properties_get(_props, "rec_format"), _streamRecording);
+        auto _replayBuffer = obs_data_get_bool(settings, "replay_buffer");
+        // Replay buffer saves files with recording path and format
+        obs_property_set_visible(obs_properties_get(_props, "path"), _streamRecording || _replayBuffer);
+        obs_property_set_visible(obs_properties_get(_props, "filename_formatting"), _streamRecording || _replayBuffer);
+        obs_property_set_visible(obs_properties_get(_props, "rec_format"), _streamRecording || _replayBuffer);
+        obs_property_set_visible(obs_properties_get(_props, "replay_buffer_max_time_sec"), _replayBuffer);
+        obs_property_set_visible(obs_properties_get(_props, "replay_buffer_max_size_mb"), _replayBuffer);
         obs_property_set_visible(obs_properties_get(_props, "split_file"), _streamRecording);
 
         auto splitFile = obs_data_get_string(settings, "split_file");
@@ -431,11 +636,30 @@ void BranchOutputFilter::addStreamGroup(obs_properties_t *props)
         obs_property_set_visible(
             obs_properties_get(_props, "split_file_size_mb"), _streamRecording && !strcmp(splitFile, "by_size")
         );
+
+        auto recSpool = obs_data_get_bool(settings, "rec_spool");
+        obs_property_set_visible(obs_properties_get(_props, "rec_spool"), _streamRecording);
+        obs_property_set_visible(obs_properties_get(_props, "rec_spool_path"), _streamRecording && recSpool);
+        obs_property_set_visible(obs_properties_get(_props, "rec_spool_limit_mb"), _streamRecording && recSpool);
         return true;
     };
 
     obs_property_set_modified_callback2(streamRecording, streamRecordingChangeHandler, nullptr);
 
+    // Replay buffer (Save the last N seconds on hotkey or dock button)
+    auto replayBuffer = obs_properties_add_bool(streamGroup, "replay_buffer", obs_module_text("ReplayBuffer"));
+    obs_property_set_long_description(replayBuffer, obs_module_text("ReplayBuffer.Description"));
+    obs_property_set_modified_callback2(replayBuffer, streamRecordingChangeHandler, nullptr);
+
+    auto replayBufferMaxTime = obs_properties_add_int(
+        streamGroup, "replay_buffer_max_time_sec", obs_module_text("ReplayBuffer.MaxTime"), 1, 21600, 1
+    );
+    obs_property_int_set_suffix(replayBufferMaxTime, " s");
+    auto replayBufferMaxSize = obs_properties_add_int(
+        streamGroup, "replay_buffer_max_size_mb", obs_module_text("ReplayBuffer.MaxSize"), 16, 65536, 16
+    );
+    obs_property_int_set_suffix(replayBufferMaxSize, " MB");
+
     //--- Recording options (initially hidden) ---//
     obs_properties_add_path(streamGroup, "path", obs_module_text("Path"), OBS_PATH_DIRECTORY, nullptr, nullptr);
     auto filenameFormatting = obs_properties_add_text(
@@ -465,6 +689,20 @@ void BranchOutputFilter::addStreamGroup(obs_properties_t *props)
     obs_properties_add_int(streamGroup, "split_file_time_mins", obs_module_text("SplitFile.Time"), 1, 525600, 1);
     obs_properties_add_int(streamGroup, "split_file_size_mb", obs_module_text("SplitFile.Size"), 1, 1073741824, 1);
 
+    // Write-behind for slow storage (e.g. Network shares)
+    auto recSpool = obs_properties_add_bool(streamGroup, "rec_spool", obs_module_text("RecordingSpool"));
+    obs_property_set_long_description(recSpool, obs_module_text("RecordingSpool.Description"));
+    obs_property_set_modified_callback2(recSpool, streamRecordingChangeHandler, nullptr);
+
+    obs_properties_add_path(
+        streamGroup, "rec_spool_path", obs_module_text("RecordingSpool.Path"), OBS_PATH_DIRECTORY, nullptr, nullptr
+    );
+    auto recSpoolLimit = obs_properties_add_int(
+        streamGroup, "rec_spool_limit_mb", obs_module_text("RecordingSpool.Limit"), 256, 1048576, 256
+    );
+    obs_property_int_set_suffix(recSpoolLimit, " MB");
+    obs_property_set_long_description(recSpoolLimit, obs_module_text("RecordingSpool.Limit.Description"));
+
     obs_properties_add_group(props, "stream", obs_module_text("Stream"), OBS_GROUP_NORMAL, streamGroup);
 }
 
@@ -561,6 +799,14 @@ void BranchOutputFilter::addAudioGroup(obs_properties_t *props)
         createAudioTrackProperties(audioGroup, track, false);
     }
 
+    // Add gap line
+    obs_properties_add_text(audioGroup, "audio_drift_compensation_group", "", OBS_TEXT_INFO);
+
+    auto driftCompensation = obs_properties_add_bool(
+        audioGroup, "audio_drift_compensation", obs_module_text("AudioDriftCompensation")
+    );
+    obs_property_set_long_description(driftCompensation, obs_module_text("AudioDriftCompensation.Description"));
+
     obs_property_set_modified_callback2(
         multitrackAudio,
         [](void *, obs_properties_t *_props, obs_property_t *, obs_data_t *settings) {
@@ -705,13 +951,7 @@ void BranchOutputFilter::addVideoEncoderGroup(obs_properties_t *props)
     auto resolutionList = obs_properties_add_list(
         videoEncoderGroup, "resolution", obs_module_text("Resolution"), OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_STRING
     );
-    obs_property_list_add_string(resolutionList, obs_module_text("Resolution.Source"), "");
-    obs_property_list_add_string(resolutionList, obs_module_text("Resolution.Output"), "output");
-    obs_property_list_add_string(resolutionList, obs_module_text("Resolution.Canvas"), "canvas");
-    obs_property_list_add_string(resolutionList, obs_module_text("Resolution.ThreeQuarters"), "three_quarters");
-    obs_property_list_add_string(resolutionList, obs_module_text("Resolution.Half"), "half");
-    obs_property_list_add_string(resolutionList, obs_module_text("Resolution.Quarter"), "quarter");
-    obs_property_list_add_string(resolutionList, obs_module_text("Resolution.Custom"), "custom");
+    addResolutionItems(resolutionList);
 
     obs_property_set_modified_callback2(
         resolutionList,
@@ -749,6 +989,64 @@ void BranchOutputFilter::addVideoEncoderGroup(obs_properties_t *props)
     obs_property_list_add_string(downscaleFilterList, obs_module_text("DownscaleFilter.Bicubic"), "bicubic");
     obs_property_list_add_string(downscaleFilterList, obs_module_text("DownscaleFilter.Lanczos"), "lanczos");
 
+    // "Lock Resolution" prop (Letterbox source resizes instead of restarting outputs)
+    auto lockResolution =
+        obs_properties_add_bool(videoEncoderGroup, "lock_resolution", obs_module_text("LockResolution"));
+    obs_property_set_long_description(lockResolution, obs_module_text("LockResolution.Description"));
+
+    // "Main Canvas" prop (Scene on program is copied from main output without rendering it again)
+    auto mainCanvas = obs_properties_add_bool(videoEncoderGroup, "main_canvas", obs_module_text("MainCanvas"));
+    obs_property_set_long_description(mainCanvas, obs_module_text("MainCanvas.Description"));
+
+    // "Frame Rate" prop (Divide canvas frame rate)
+    auto frameRateDivisorList = obs_properties_add_list(
+        videoEncoderGroup, "frame_rate_divisor", obs_module_text("FrameRate"), OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_INT
+    );
+    obs_property_set_long_description(frameRateDivisorList, obs_module_text("FrameRate.Description"));
+
+    obs_video_info ovi = {0};
+    auto fps = obs_get_video_info(&ovi) && ovi.fps_den ? (double)ovi.fps_num / ovi.fps_den : 0.0;
+    for (int divisor = 1; divisor <= MAX_FRAME_RATE_DIVISOR; divisor++) {
+        auto label = divisor == 1 ? QTStr("FrameRate.Full").arg(fps, 0, 'f', 2)
+                                  : QTStr("FrameRate.Divided").arg(divisor).arg(fps / divisor, 0, 'f', 2);
+        obs_property_list_add_int(frameRateDivisorList, qUtf8Printable(label), divisor);
+    }
+
+    // "Adaptive Bitrate" props (Follow congestion of streams)
+    auto adaptiveBitrate =
+        obs_properties_add_bool(videoEncoderGroup, "adaptive_bitrate", obs_module_text("AdaptiveBitrate"));
+    obs_property_set_long_description(adaptiveBitrate, obs_module_text("AdaptiveBitrate.Description"));
+
+    auto adaptiveBitrateMin = obs_properties_add_int_slider(
+        videoEncoderGroup, "adaptive_bitrate_min_percent", obs_module_text("AdaptiveBitrate.Min"), 10, 100, 5
+    );
+    obs_property_int_set_suffix(adaptiveBitrateMin, "%");
+
+    auto adaptiveBitratePriorityList = obs_properties_add_list(
+        videoEncoderGroup, "adaptive_bitrate_priority", obs_module_text("AdaptiveBitrate.Priority"),
+        OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_STRING
+    );
+    obs_property_set_long_description(
+        adaptiveBitratePriorityList, obs_module_text("AdaptiveBitrate.Priority.Description")
+    );
+    obs_property_list_add_string(
+        adaptiveBitratePriorityList, obs_module_text("AdaptiveBitrate.Priority.Recording"), "recording"
+    );
+    obs_property_list_add_string(
+        adaptiveBitratePriorityList, obs_module_text("AdaptiveBitrate.Priority.Streaming"), "streaming"
+    );
+
+    obs_property_set_modified_callback2(
+        adaptiveBitrate,
+        [](void *, obs_properties_t *_props, obs_property_t *, obs_data_t *settings) {
+            auto enabled = obs_data_get_bool(settings, "adaptive_bitrate");
+            obs_property_set_visible(obs_properties_get(_props, "adaptive_bitrate_min_percent"), enabled);
+            obs_property_set_visible(obs_properties_get(_props, "adaptive_bitrate_priority"), enabled);
+            return true;
+        },
+        nullptr
+    );
+
     // "Video Encoder" prop
     auto videoEncoderList = obs_properties_add_list(
         videoEncoderGroup, "video_encoder", obs_module_text("VideoEncoder"), OBS_COMBO_TYPE_LIST,
@@ -756,21 +1054,7 @@ void BranchOutputFilter::addVideoEncoderGroup(obs_properties_t *props)
     );
 
     // Enum video encoders
-    const char *encoderId = nullptr;
-    size_t i = 0;
-    while (obs_enum_encoder_types(i++, &encoderId)) {
-        auto caps = obs_get_encoder_caps(encoderId);
-        if (caps & (OBS_ENCODER_CAP_DEPRECATED | OBS_ENCODER_CAP_INTERNAL)) {
-            // Ignore deprecated and internal
-            continue;
-        }
-
-        auto encoderName = obs_encoder_get_display_name(encoderId);
-
-        if (obs_get_encoder_type(encoderId) == OBS_ENCODER_VIDEO) {
-            obs_property_list_add_string(videoEncoderList, encoderName, encoderId);
-        }
-    }
+    addVideoEncoderItems(videoEncoderList);
 
     obs_property_set_modified_callback2(
         videoEncoderList,
@@ -0,0 +1,162 @@
+/*
+Branch Output Plugin
+Copyright (C) 2024 OPENSPHERE Inc. info@opensphere.co.jp
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#include <obs-module.h>
+#include <util/platform.h>
+
+#include <QUrl>
+#include <QRandomGenerator>
+
+#include "reconnect-coordinator.hpp"
+#include "plugin-support.h"
+
+ReconnectCoordinator *ReconnectCoordinator::instance = nullptr;
+
+//--- ReconnectCoordinator class ---//
+
+ReconnectCoordinator::ReconnectCoordinator() {}
+
+ReconnectCoordinator::~ReconnectCoordinator() {}
+
+ReconnectCoordinator *ReconnectCoordinator::getInstance()
+{
+    // First call is made in obs_module_load()
+    if (!instance) {
+        instance = new ReconnectCoordinator();
+    }
+    return instance;
+}
+
+void ReconnectCoordinator::destroyInstance()
+{
+    delete instance;
+    instance = nullptr;
+}
+
+QString ReconnectCoordinator::getIngestHost(const QString &server)
+{
+    auto host = QUrl(server).host();
+    return host.isEmpty() ? server : host.toLower();
+}
+
+uint64_t ReconnectCoordinator::getBackoffMs(int failures)
+{
+    uint64_t delayMs = RECONNECT_CIRCUIT_COOLDOWN_MS;
+    if (failures < RECONNECT_CIRCUIT_FAILURES) {
+        // 2^(failures - 1) times base, capped
+        delayMs = RECONNECT_BACKOFF_BASE_MS;
+        for (int i = 1; i < failures && delayMs < RECONNECT_BACKOFF_MAX_MS; i++) {
+            delayMs *= 2;
+        }
+        delayMs = qMin(delayMs, (uint64_t)RECONNECT_BACKOFF_MAX_MS);
+    }
+
+    // Randomize +/- jitter so that outputs and plugin instances don't retry in lockstep
+    auto jitterMs = delayMs * RECONNECT_JITTER_PERCENT / 100;
+    return delayMs - jitterMs + QRandomGenerator::global()->bounded((quint64)jitterMs * 2 + 1);
+}
+
+bool ReconnectCoordinator::tryAcquire(const QString &host, void *owner, uint64_t *waitMs)
+{
+    QMutexLocker locker(&mutex);
+
+    auto now = os_gettime_ns();
+    auto &state = hosts[host]; // Added as zero when missing
+
+    if (state.attemptOwner && state.attemptOwner != owner) {
+        auto attemptEndsAt = state.attemptStartedAt + (uint64_t)RECONNECT_ATTEMPT_TIMEOUT_MS * 1000000ULL;
+        if (now < attemptEndsAt) {
+            // Another output is probing this host
+            *waitMs = (attemptEndsAt - now) / 1000000ULL;
+            return false;
+        }
+        // The attempt seems to be abandoned
+        obs_log(LOG_DEBUG, "Reconnect attempt to %s timed out", qUtf8Printable(host));
+    }
+
+    if (now < state.nextAttemptAt) {
+        *waitMs = (state.nextAttemptAt - now) / 1000000ULL;
+        return false;
+    }
+
+    state.attemptOwner = owner;
+    state.attemptStartedAt = now;
+    *waitMs = 0;
+    return true;
+}
+
+void ReconnectCoordinator::reportSuccess(const QString &host, void *owner)
+{
+    QMutexLocker locker(&mutex);
+
+    auto it = hosts.find(host);
+    if (it == hosts.end() || it->attemptOwner != owner) {
+        return;
+    }
+
+    if (it->failures >= RECONNECT_CIRCUIT_FAILURES) {
+        obs_log(LOG_INFO, "Reconnected to %s, closing circuit", qUtf8Printable(host));
+    }
+    // Waiting outputs can go immediately
+    hosts.erase(it);
+}
+
+void ReconnectCoordinator::reportFailure(const QString &host, void *owner)
+{
+    QMutexLocker locker(&mutex);
+
+    auto it = hosts.find(host);
+    if (it == hosts.end() || it->attemptOwner != owner) {
+        return;
+    }
+
+    it->failures++;
+    it->attemptOwner = nullptr;
+    it->attemptStartedAt = 0;
+
+    auto delayMs = getBackoffMs(it->failures);
+    it->nextAttemptAt = os_gettime_ns() + delayMs * 1000000ULL;
+
+    if (it->failures == RECONNECT_CIRCUIT_FAILURES) {
+        obs_log(
+            LOG_WARNING, "Reconnect to %s failed %d times, opening circuit for %llu secs", qUtf8Printable(host),
+            it->failures, (unsigned long long)delayMs / 1000
+        );
+    } else {
+        obs_log(
+            LOG_INFO, "Reconnect to %s failed, next attempt in %llu ms", qUtf8Printable(host),
+            (unsigned long long)delayMs
+        );
+    }
+}
+
+void ReconnectCoordinator::release(const QString &host, void *owner)
+{
+    QMutexLocker locker(&mutex);
+
+    auto it = hosts.find(host);
+    if (it == hosts.end() || it->attemptOwner != owner) {
+        return;
+    }
+
+    it->attemptOwner = nullptr;
+    it->attemptStartedAt = 0;
+    if (!it->failures) {
+        hosts.erase(it);
+    }
+}
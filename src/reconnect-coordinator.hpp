@@ -0,0 +1,67 @@
+/*
+Branch Output Plugin
+Copyright (C) 2024 OPENSPHERE Inc. info@opensphere.co.jp
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#pragma once
+
+#include <QHash>
+#include <QMutex>
+#include <QString>
+
+#define RECONNECT_BACKOFF_BASE_MS 2000
+#define RECONNECT_BACKOFF_MAX_MS 60000
+#define RECONNECT_JITTER_PERCENT 25
+#define RECONNECT_CIRCUIT_FAILURES 5        // Consecutive failures to open the circuit
+#define RECONNECT_CIRCUIT_COOLDOWN_MS 300000 // Circuit stays open for this duration, then one probe is allowed
+#define RECONNECT_ATTEMPT_TIMEOUT_MS 60000  // Attempt without result is forgotten after this duration
+
+// Plugin level reconnection shared by all filters, used only after libobs has given up its own reconnect.
+// Outputs to the same ingest host back off together: Only one attempt per host is in flight at a time,
+// delays grow exponentially with random jitter, and repeated failures open the circuit for a cooldown.
+class ReconnectCoordinator {
+    struct HostState {
+        int failures;           // Consecutive
+        uint64_t nextAttemptAt; // os_gettime_ns() base
+        void *attemptOwner;     // Output attempting now (nullptr when none)
+        uint64_t attemptStartedAt;
+    };
+
+    QMutex mutex;
+    QHash<QString, HostState> hosts;
+
+    static ReconnectCoordinator *instance;
+
+    ReconnectCoordinator();
+    ~ReconnectCoordinator();
+
+    static uint64_t getBackoffMs(int failures);
+
+public:
+    static ReconnectCoordinator *getInstance();
+    // Call from obs_module_unload()
+    static void destroyInstance();
+
+    // Host part of server URL (Whole string when it isn't URL)
+    static QString getIngestHost(const QString &server);
+
+    // Return true when the owner may attempt now, otherwise set milliseconds until the next chance to waitMs
+    bool tryAcquire(const QString &host, void *owner, uint64_t *waitMs);
+    void reportSuccess(const QString &host, void *owner);
+    void reportFailure(const QString &host, void *owner);
+    // Give up the attempt without result (e.g. Output has been stopped)
+    void release(const QString &host, void *owner);
+};
@@ -0,0 +1,272 @@
+/*
+Branch Output Plugin
+Copyright (C) 2024 OPENSPHERE Inc. info@opensphere.co.jp
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#include <obs-module.h>
+#include <util/platform.h>
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+
+#include "recording-spooler.hpp"
+#include "plugin-support.h"
+
+RecordingSpooler *RecordingSpooler::instance = nullptr;
+
+//--- RecordingSpooler class ---//
+
+RecordingSpooler::RecordingSpooler()
+{
+    // Keep segments in order (And don't compete for the share's bandwidth)
+    pool.setMaxThreadCount(1);
+}
+
+RecordingSpooler::~RecordingSpooler()
+{
+    QMutexLocker locker(&mutex);
+    auto remains = watches.values();
+    watches.clear();
+    locker.unlock();
+
+    // Disconnect outside the lock (Signal handlers take it)
+    foreach (auto watch, remains) {
+        delete watch;
+    }
+
+    pool.waitForDone();
+}
+
+RecordingSpooler *RecordingSpooler::getInstance()
+{
+    // First call is made in obs_module_load()
+    if (!instance) {
+        instance = new RecordingSpooler();
+    }
+    return instance;
+}
+
+void RecordingSpooler::destroyInstance()
+{
+    delete instance;
+    instance = nullptr;
+}
+
+void RecordingSpooler::watch(const QString &name, obs_output_t *output, const QString &destination, int limitMb)
+{
+    QMutexLocker locker(&mutex);
+
+    auto watch = watches.value(output);
+    if (watch) {
+        // Restarted or updated
+        watch->name = name;
+        watch->destination = destination;
+        watch->limitBytes = (qint64)limitMb * 1024 * 1024;
+        watch->released = false;
+        return;
+    }
+    locker.unlock();
+
+    watch = new Watch();
+    watch->name = name;
+    watch->output = obs_output_get_ref(output);
+    watch->destination = destination;
+    watch->limitBytes = (qint64)limitMb * 1024 * 1024;
+    watch->backlog.reset(new Backlog{0, false});
+    watch->inProcessMuxer = !strcmp(obs_output_get_id(output), "mp4_output");
+    watch->recording = false;
+    watch->released = false;
+
+    // Connect outside the lock (Signal handlers take it)
+    auto handler = obs_output_get_signal_handler(output);
+    watch->startSignal.Connect(handler, "start", onRecordingStart, watch);
+    watch->fileChangedSignal.Connect(handler, "file_changed", onRecordingFileChanged, watch);
+    watch->stopSignal.Connect(handler, "stop", onRecordingStop, watch);
+
+    locker.relock();
+    watches.insert(output, watch);
+}
+
+void RecordingSpooler::unwatch(obs_output_t *output)
+{
+    QMutexLocker locker(&mutex);
+
+    auto watch = watches.value(output);
+    if (!watch) {
+        return;
+    }
+
+    if (watch->recording) {
+        // Muxer is finalizing the last segment, onRecordingStop() takes over
+        watch->released = true;
+        return;
+    }
+
+    watches.remove(output);
+    locker.unlock();
+
+    delete watch;
+}
+
+// Must be called with mutex locked
+void RecordingSpooler::enqueue(Watch *watch, const QString &file)
+{
+    if (file.isEmpty()) {
+        return;
+    }
+
+    auto size = QFileInfo(file).size();
+    auto backlog = watch->backlog;
+    backlog->pendingBytes += size;
+
+    if (backlog->pendingBytes > watch->limitBytes && !backlog->overflowed) {
+        // Staging keeps growing when the destination is slower than recording
+        backlog->overflowed = true;
+        obs_log(
+            LOG_WARNING, "%s: Recording spool overflowed (%lld MB waiting for %s)", qUtf8Printable(watch->name),
+            (long long)(backlog->pendingBytes / 1024 / 1024), qUtf8Printable(watch->destination)
+        );
+    }
+
+    auto name = watch->name;
+    auto destination = watch->destination;
+    pool.start([this, name, file, destination, size, backlog]() {
+        moveFile(name, file, destination);
+
+        QMutexLocker _locker(&mutex);
+        backlog->pendingBytes -= size;
+        if (backlog->overflowed && !backlog->pendingBytes) {
+            backlog->overflowed = false;
+            obs_log(LOG_INFO, "%s: Recording spool drained", qUtf8Printable(name));
+        }
+    });
+}
+
+bool RecordingSpooler::moveFile(const QString &name, const QString &file, const QString &destination)
+{
+    QFileInfo info(file);
+    os_mkdirs(qUtf8Printable(destination));
+
+    // Never overwrite
+    auto destFile = QDir(destination).filePath(info.fileName());
+    for (int i = 1; QFile::exists(destFile); i++) {
+        destFile = QDir(destination).filePath(
+            QString("%1 (%2).%3").arg(info.completeBaseName()).arg(i).arg(info.suffix())
+        );
+    }
+
+    // Same volume needs no copy
+    if (QFile::rename(file, destFile)) {
+        obs_log(LOG_INFO, "%s: Recording moved to %s", qUtf8Printable(name), qUtf8Printable(destFile));
+        return true;
+    }
+
+    QFile source(file);
+    QFile dest(destFile);
+    if (!source.open(QIODevice::ReadOnly) || !dest.open(QIODevice::WriteOnly)) {
+        obs_log(
+            LOG_ERROR, "%s: Recording move failed, kept at %s (%s)", qUtf8Printable(name), qUtf8Printable(file),
+            qUtf8Printable(dest.errorString())
+        );
+        return false;
+    }
+
+    auto size = source.size();
+    auto failed = false;
+
+    QByteArray chunk;
+    while (!failed && !source.atEnd()) {
+        chunk = source.read(RECORDING_SPOOL_CHUNK_SIZE);
+        failed = chunk.isEmpty() || dest.write(chunk) != chunk.size();
+    }
+    failed = failed || !dest.flush();
+    dest.close();
+    source.close();
+
+    if (failed) {
+        obs_log(
+            LOG_ERROR, "%s: Recording move failed, kept at %s (%s)", qUtf8Printable(name), qUtf8Printable(file),
+            qUtf8Printable(dest.errorString())
+        );
+        dest.remove();
+        return false;
+    }
+
+    QFile::remove(file);
+    obs_log(
+        LOG_INFO, "%s: Recording moved to %s (%lld MB)", qUtf8Printable(name), qUtf8Printable(destFile),
+        (long long)(size / 1024 / 1024)
+    );
+    return true;
+}
+
+QString RecordingSpooler::getLastFile(obs_output_t *output)
+{
+    calldata_t cd = {0};
+    auto ph = obs_output_get_proc_handler(output);
+    proc_handler_call(ph, "get_last_file", &cd);
+    QString path = calldata_string(&cd, "path");
+    calldata_free(&cd);
+    return path;
+}
+
+void RecordingSpooler::onRecordingStart(void *data, calldata_t *)
+{
+    auto watch = static_cast<Watch *>(data);
+
+    QMutexLocker locker(&instance->mutex);
+    watch->recording = true;
+    watch->currentFile = getLastFile(watch->output);
+    watch->closingFile.clear();
+}
+
+void RecordingSpooler::onRecordingFileChanged(void *data, calldata_t *cd)
+{
+    auto watch = static_cast<Watch *>(data);
+
+    QMutexLocker locker(&instance->mutex);
+    if (watch->inProcessMuxer) {
+        // Muxer has closed the finished segment before the signal
+        instance->enqueue(watch, watch->currentFile);
+    } else {
+        // Mux subprocess finalizes segments in order, so the one before has been closed for sure
+        instance->enqueue(watch, watch->closingFile);
+        watch->closingFile = watch->currentFile;
+    }
+    watch->currentFile = calldata_string(cd, "next_file");
+}
+
+void RecordingSpooler::onRecordingStop(void *data, calldata_t *)
+{
+    auto watch = static_cast<Watch *>(data);
+
+    QMutexLocker locker(&instance->mutex);
+    // Emitted after the muxer (Including subprocess) has exited
+    if (watch->recording) {
+        instance->enqueue(watch, watch->closingFile);
+        instance->enqueue(watch, watch->currentFile);
+    }
+    watch->recording = false;
+    watch->currentFile.clear();
+    watch->closingFile.clear();
+
+    if (watch->released) {
+        instance->watches.remove(watch->output);
+        // Can't disconnect while the signal is being emitted (Delete in worker thread)
+        instance->pool.start([watch]() { delete watch; });
+    }
+}
@@ -0,0 +1,88 @@
+/*
+Branch Output Plugin
+Copyright (C) 2024 OPENSPHERE Inc. info@opensphere.co.jp
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#pragma once
+
+#include <obs-module.h>
+#include <obs.hpp>
+
+#include <QHash>
+#include <QMutex>
+#include <QSharedPointer>
+#include <QString>
+#include <QThreadPool>
+
+#define RECORDING_SPOOL_CHUNK_SIZE (8 * 1024 * 1024)
+
+// Write-behind of recordings for slow destination storage (e.g. SMB/NFS shares).
+// Recording outputs write into local staging directory, and every finished segment is moved to the destination
+// in background thread. Muxer and shared encoder never wait for the share.
+// "stop" is emitted after the muxer has closed the last file. "file_changed" is too for in-process muxer (mp4_output),
+// but ffmpeg_muxer emits it when the change is sent to the mux subprocess, which may still be writing the trailer.
+// So a segment of subprocess muxer is handed over on the next "file_changed" (The subprocess has moved on) or "stop".
+// Exceeding the spool limit of a recording raises warnings (Segments are kept in staging until they're moved).
+class RecordingSpooler {
+    // Staged but not moved yet, per recording (Outlives the watch until its segments are moved)
+    struct Backlog {
+        qint64 pendingBytes;
+        bool overflowed;
+    };
+
+    struct Watch {
+        QString name;
+        OBSOutputAutoRelease output; // Referenced until the last segment is handed over
+        QString destination;
+        qint64 limitBytes;
+        QSharedPointer<Backlog> backlog; // Guarded by spooler's mutex
+        QString currentFile;             // Segment being written now
+        QString closingFile;             // Previous segment the mux subprocess may still be finalizing
+        bool inProcessMuxer;             // Finished segment is closed when "file_changed" is emitted
+        bool recording;
+        bool released; // Delete after the output stops
+        OBSSignal startSignal;
+        OBSSignal fileChangedSignal;
+        OBSSignal stopSignal;
+    };
+
+    QMutex mutex;
+    QHash<obs_output_t *, Watch *> watches;
+    QThreadPool pool;
+
+    static RecordingSpooler *instance;
+
+    RecordingSpooler();
+    ~RecordingSpooler();
+
+    void enqueue(Watch *watch, const QString &file);
+    bool moveFile(const QString &name, const QString &file, const QString &destination);
+
+    static QString getLastFile(obs_output_t *output);
+    static void onRecordingStart(void *data, calldata_t *cd);
+    static void onRecordingFileChanged(void *data, calldata_t *cd);
+    static void onRecordingStop(void *data, calldata_t *cd);
+
+public:
+    static RecordingSpooler *getInstance();
+    // Call from obs_module_unload() (Queued segments are moved before return)
+    static void destroyInstance();
+
+    // Call before starting the output with staging directory as its path (Thread-safe)
+    void watch(const QString &name, obs_output_t *output, const QString &destination, int limitMb);
+    // Call after stopping the output, the last segment is still moved (Thread-safe)
+    void unwatch(obs_output_t *output);
+};
@@ -0,0 +1,150 @@
+/*
+Branch Output Plugin
+Copyright (C) 2024 OPENSPHERE Inc. info@opensphere.co.jp
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#include <obs-module.h>
+#include <util/platform.h>
+
+#include <QFileInfo>
+
+#include "settings-file-writer.hpp"
+#include "plugin-support.h"
+
+SettingsFileWriter *SettingsFileWriter::instance = nullptr;
+
+//--- SettingsFileWriter class ---//
+
+SettingsFileWriter::SettingsFileWriter(QObject *parent) : QObject(parent)
+{
+    // Keep writes in order
+    pool.setMaxThreadCount(1);
+
+    debounceTimer.setSingleShot(true);
+    debounceTimer.setInterval(SETTINGS_WRITE_DEBOUNCE_MS);
+    connect(&debounceTimer, &QTimer::timeout, this, &SettingsFileWriter::writePendingFiles);
+}
+
+SettingsFileWriter::~SettingsFileWriter()
+{
+    flush();
+}
+
+SettingsFileWriter *SettingsFileWriter::getInstance()
+{
+    // First call is made in obs_module_load() (Lives in UI thread)
+    if (!instance) {
+        instance = new SettingsFileWriter();
+    }
+    return instance;
+}
+
+void SettingsFileWriter::destroyInstance()
+{
+    delete instance;
+    instance = nullptr;
+}
+
+bool SettingsFileWriter::writeFile(const QString &path, const QString &json)
+{
+    // Ensure config directory exists
+    os_mkdirs(qUtf8Printable(QFileInfo(path).path()));
+
+    auto content = json.toUtf8();
+    auto written =
+        os_quick_write_utf8_file_safe(qUtf8Printable(path), content.constData(), content.size(), false, "tmp", "bak");
+    if (!written) {
+        obs_log(LOG_WARNING, "Settings writer: Failed to write %s", qUtf8Printable(path));
+        return false;
+    }
+
+    obs_log(LOG_DEBUG, "Settings writer: %s written", qUtf8Printable(path));
+    return true;
+}
+
+void SettingsFileWriter::save(const QString &path, obs_data_t *settings)
+{
+    auto json = QString::fromUtf8(obs_data_get_json(settings));
+
+    QMutexLocker locker(&mutex);
+    pendingFiles[path] = json;
+    locker.unlock();
+
+    // Timer must be manipulated in its own thread
+    QMetaObject::invokeMethod(this, "scheduleWrite", Qt::QueuedConnection);
+}
+
+obs_data_t *SettingsFileWriter::load(const QString &path)
+{
+    QMutexLocker locker(&mutex);
+
+    if (pendingFiles.contains(path)) {
+        return obs_data_create_from_json(qUtf8Printable(pendingFiles[path]));
+    }
+    if (storedFiles.contains(path)) {
+        return obs_data_create_from_json(qUtf8Printable(storedFiles[path]));
+    }
+
+    auto data = obs_data_create_from_json_file(qUtf8Printable(path));
+    if (data) {
+        // Saving the same content again can be skipped
+        storedFiles[path] = QString::fromUtf8(obs_data_get_json(data));
+    }
+    return data;
+}
+
+void SettingsFileWriter::scheduleWrite()
+{
+    // Do not restart the timer, continuous saves (e.g. slider drag) must not postpone writing forever
+    if (!debounceTimer.isActive()) {
+        debounceTimer.start();
+    }
+}
+
+void SettingsFileWriter::writePendingFiles()
+{
+    QMutexLocker locker(&mutex);
+
+    for (auto it = pendingFiles.begin(); it != pendingFiles.end(); it++) {
+        if (storedFiles.value(it.key()) == it.value()) {
+            // Unchanged
+            continue;
+        }
+        storedFiles[it.key()] = it.value();
+
+        auto path = it.key();
+        auto json = it.value();
+        pool.start([this, path, json]() {
+            if (writeFile(path, json)) {
+                return;
+            }
+
+            // Next save of the same content must try again (Unless newer content has been written meanwhile)
+            QMutexLocker locker(&mutex);
+            if (storedFiles.value(path) == json) {
+                storedFiles.remove(path);
+            }
+        });
+    }
+    pendingFiles.clear();
+}
+
+void SettingsFileWriter::flush()
+{
+    debounceTimer.stop();
+    writePendingFiles();
+    pool.waitForDone();
+}
@@ -0,0 +1,66 @@
+/*
+Branch Output Plugin
+Copyright (C) 2024 OPENSPHERE Inc. info@opensphere.co.jp
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#pragma once
+
+#include <obs-module.h>
+
+#include <QObject>
+#include <QHash>
+#include <QMutex>
+#include <QString>
+#include <QThreadPool>
+#include <QTimer>
+
+#define SETTINGS_WRITE_DEBOUNCE_MS 1000
+
+// Persists settings JSON files in background thread.
+// Saves within a debounce window are coalesced (Last one wins), and unchanged content is not written at all.
+class SettingsFileWriter : public QObject {
+    Q_OBJECT
+
+    QMutex mutex;
+    QHash<QString, QString> pendingFiles; // Path -> JSON waiting for debounce
+    QHash<QString, QString> storedFiles;  // Path -> JSON already written (or being written)
+    QTimer debounceTimer;
+    QThreadPool pool;
+
+    static SettingsFileWriter *instance;
+
+    explicit SettingsFileWriter(QObject *parent = nullptr);
+    ~SettingsFileWriter();
+
+    // Return false on failure
+    static bool writeFile(const QString &path, const QString &json);
+
+private slots:
+    void scheduleWrite();
+    void writePendingFiles();
+
+public:
+    static SettingsFileWriter *getInstance();
+    // Call from obs_module_unload() (Pending files are written before return)
+    static void destroyInstance();
+
+    // Thread-safe
+    void save(const QString &path, obs_data_t *settings);
+    // Return latest content including unwritten one, nullptr when the file doesn't exist
+    obs_data_t *load(const QString &path);
+    // Write pending files synchronously
+    void flush();
+};
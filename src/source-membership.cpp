@@ -0,0 +1,205 @@
+/*
+Branch Output Plugin
+Copyright (C) 2024 OPENSPHERE Inc. info@opensphere.co.jp
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#include <obs-module.h>
+#include <obs-frontend-api.h>
+
+#include "source-membership.hpp"
+#include "plugin-support.h"
+
+SourceMembershipIndex *SourceMembershipIndex::instance = nullptr;
+
+//--- SourceMembershipIndex class ---//
+
+SourceMembershipIndex::SourceMembershipIndex() : dirty(true)
+{
+    auto handler = obs_get_signal_handler();
+    sourceCreateSignal.Connect(handler, "source_create", onMembershipChanged, this);
+    sourceRemoveSignal.Connect(handler, "source_remove", onMembershipChanged, this);
+    sourceDestroySignal.Connect(handler, "source_destroy", onMembershipChanged, this);
+
+    // Scene is created before it's added to the list
+    obs_frontend_add_event_callback(onFrontendEvent, this);
+}
+
+SourceMembershipIndex::~SourceMembershipIndex()
+{
+    obs_frontend_remove_event_callback(onFrontendEvent, this);
+    sourceCreateSignal.Disconnect();
+    sourceRemoveSignal.Disconnect();
+    sourceDestroySignal.Disconnect();
+
+    QMutexLocker locker(&mutex);
+    for (auto it = watchedScenes.begin(); it != watchedScenes.end(); it++) {
+        unwatchScene(it.value());
+    }
+    watchedScenes.clear();
+}
+
+void SourceMembershipIndex::createInstance()
+{
+    if (!instance) {
+        instance = new SourceMembershipIndex();
+    }
+}
+
+void SourceMembershipIndex::destroyInstance()
+{
+    delete instance;
+    instance = nullptr;
+}
+
+// Callback from global and scene signal handlers (Any thread)
+void SourceMembershipIndex::onMembershipChanged(void *data, calldata_t *)
+{
+    // DO NOT lock here, signals may be emitted while rebuild() is enumerating sources.
+    auto index = static_cast<SourceMembershipIndex *>(data);
+    index->dirty = true;
+}
+
+void SourceMembershipIndex::onFrontendEvent(enum obs_frontend_event event, void *data)
+{
+    auto index = static_cast<SourceMembershipIndex *>(data);
+
+    switch (event) {
+    case OBS_FRONTEND_EVENT_SCENE_LIST_CHANGED:
+        index->dirty = true;
+        break;
+    default:
+        break;
+    }
+}
+
+// Must be called with mutex held
+void SourceMembershipIndex::watchScene(obs_source_t *source)
+{
+    auto it = watchedScenes.find(source);
+    if (it != watchedScenes.end()) {
+        if (!obs_weak_source_expired(it.value())) {
+            return;
+        }
+        // Address has been reused by new source
+        obs_weak_source_release(it.value());
+        watchedScenes.erase(it);
+    }
+
+    auto handler = obs_source_get_signal_handler(source);
+    signal_handler_connect(handler, "item_add", onMembershipChanged, this);
+    signal_handler_connect(handler, "item_remove", onMembershipChanged, this);
+    watchedScenes.insert(source, obs_source_get_weak_source(source));
+}
+
+// Must be called with mutex held
+void SourceMembershipIndex::unwatchScene(obs_weak_source_t *weak)
+{
+    OBSSourceAutoRelease source = obs_weak_source_get_source(weak);
+    if (source) {
+        auto handler = obs_source_get_signal_handler(source);
+        signal_handler_disconnect(handler, "item_add", onMembershipChanged, this);
+        signal_handler_disconnect(handler, "item_remove", onMembershipChanged, this);
+    }
+    obs_weak_source_release(weak);
+}
+
+// Must be called with mutex held
+void SourceMembershipIndex::collectSceneItems(obs_scene_t *scene)
+{
+    obs_scene_enum_items(
+        scene,
+        [](obs_scene_t *, obs_sceneitem_t *item, void *param) {
+            auto index = static_cast<SourceMembershipIndex *>(param);
+            auto source = obs_sceneitem_get_source(item);
+            index->frontendSources.insert(source);
+
+            if (obs_sceneitem_is_group(item)) {
+                // Groups have own item signals
+                index->watchScene(source);
+                index->collectSceneItems(obs_group_from_source(source));
+            }
+            return true;
+        },
+        this
+    );
+}
+
+// Must be called with mutex held
+void SourceMembershipIndex::rebuild()
+{
+    // Clear first, signals during rebuild will request another one
+    dirty = false;
+
+    frontendSources.clear();
+    publicSources.clear();
+
+    // Forget destroyed scenes
+    for (auto it = watchedScenes.begin(); it != watchedScenes.end();) {
+        if (obs_weak_source_expired(it.value())) {
+            obs_weak_source_release(it.value());
+            it = watchedScenes.erase(it);
+        } else {
+            it++;
+        }
+    }
+
+    obs_frontend_source_list list = {0};
+    obs_frontend_get_scenes(&list);
+    {
+        for (size_t i = 0; i < list.sources.num; i++) {
+            auto sceneSource = list.sources.array[i];
+            frontendSources.insert(sceneSource);
+            watchScene(sceneSource);
+            collectSceneItems(obs_scene_from_source(sceneSource));
+        }
+    }
+    obs_frontend_source_list_free(&list);
+
+    auto callback = [](void *param, obs_source_t *source) {
+        auto index = static_cast<SourceMembershipIndex *>(param);
+        index->publicSources.insert(source);
+        return true;
+    };
+    obs_enum_scenes(callback, this);
+    obs_enum_sources(callback, this);
+
+    obs_log(
+        LOG_DEBUG, "Source membership index rebuilt (frontend=%lld, public=%lld)", (long long)frontendSources.size(),
+        (long long)publicSources.size()
+    );
+}
+
+bool SourceMembershipIndex::inFrontend(obs_source_t *source)
+{
+    if (!source) {
+        return false;
+    }
+
+    QMutexLocker locker(&mutex);
+    if (dirty) {
+        rebuild();
+    }
+    return frontendSources.contains(source);
+}
+
+bool SourceMembershipIndex::isPrivate(obs_source_t *source)
+{
+    QMutexLocker locker(&mutex);
+    if (dirty) {
+        rebuild();
+    }
+    return !publicSources.contains(source);
+}
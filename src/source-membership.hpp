@@ -0,0 +1,72 @@
+/*
+Branch Output Plugin
+Copyright (C) 2024 OPENSPHERE Inc. info@opensphere.co.jp
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#pragma once
+
+#include <obs-module.h>
+#include <obs.hpp>
+#include <obs-frontend-api.h>
+
+#include <QHash>
+#include <QMutex>
+#include <QSet>
+
+#include <atomic>
+
+// Cached answer of "Is this source displayed in frontend?" and "Is this source public?".
+// Sets are rebuilt lazily on the next lookup after source create/remove/destroy, scene item add/remove signals
+// or frontend scene list change,
+// so lookups are O(1) and the scene graph is only walked once per change.
+class SourceMembershipIndex {
+    QMutex mutex;
+    std::atomic<bool> dirty;
+
+    QSet<obs_source_t *> frontendSources; // Frontend scenes and everything placed in them (Including groups)
+    QSet<obs_source_t *> publicSources;   // Enumerated by obs_enum_scenes() and obs_enum_sources()
+
+    // Scenes and groups connected to "item_add" / "item_remove"
+    QHash<obs_source_t *, obs_weak_source_t *> watchedScenes;
+
+    OBSSignal sourceCreateSignal;
+    OBSSignal sourceRemoveSignal;
+    OBSSignal sourceDestroySignal;
+
+    static SourceMembershipIndex *instance;
+
+    static void onMembershipChanged(void *data, calldata_t *cd);
+    static void onFrontendEvent(enum obs_frontend_event event, void *data);
+
+    void rebuild();
+    void collectSceneItems(obs_scene_t *scene);
+    void watchScene(obs_source_t *source);
+    void unwatchScene(obs_weak_source_t *weak);
+
+    SourceMembershipIndex();
+    ~SourceMembershipIndex();
+
+public:
+    // Return nullptr until createInstance() (Callers fall back to scanning)
+    static inline SourceMembershipIndex *getInstance() { return instance; }
+    // Call from obs_module_post_load()
+    static void createInstance();
+    // Call from obs_module_unload()
+    static void destroyInstance();
+
+    bool inFrontend(obs_source_t *source);
+    bool isPrivate(obs_source_t *source);
+};
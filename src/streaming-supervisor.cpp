@@ -0,0 +1,88 @@
+/*
+Branch Output Plugin
+Copyright (C) 2024 OPENSPHERE Inc. info@opensphere.co.jp
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#include <obs-module.h>
+#include <util/platform.h>
+
+#include "streaming-supervisor.hpp"
+#include "reconnect-coordinator.hpp"
+
+//--- StreamingSupervisor class ---//
+
+void StreamingSupervisor::beginConnectAttempt(SupervisedStreaming &streaming)
+{
+    streaming.connectAttemptingAt = os_gettime_ns();
+}
+
+bool StreamingSupervisor::connectAttemptingTimedOut(const SupervisedStreaming &streaming)
+{
+    return streaming.connectAttemptingAt &&
+           os_gettime_ns() - streaming.connectAttemptingAt > CONNECT_ATTEMPTING_TIMEOUT_NS;
+}
+
+bool StreamingSupervisor::gaveUp(const SupervisedStreaming &streaming)
+{
+    return streaming.active && streaming.output && !obs_output_active(streaming.output);
+}
+
+void StreamingSupervisor::settleReconnectAttempt(SupervisedStreaming &streaming)
+{
+    if (!streaming.reconnectPending || !streaming.output) {
+        return;
+    }
+
+    if (obs_output_active(streaming.output) && !obs_output_reconnecting(streaming.output)) {
+        ReconnectCoordinator::getInstance()->reportSuccess(streaming.ingestHost, streaming.output);
+    } else {
+        ReconnectCoordinator::getInstance()->reportFailure(streaming.ingestHost, streaming.output);
+    }
+    streaming.reconnectPending = false;
+}
+
+bool StreamingSupervisor::acquireReconnect(SupervisedStreaming &streaming, uint64_t *waitMs)
+{
+    if (!ReconnectCoordinator::getInstance()->tryAcquire(streaming.ingestHost, streaming.output, waitMs)) {
+        return false;
+    }
+
+    streaming.reconnectPending = true;
+    return true;
+}
+
+bool StreamingSupervisor::reconnect(SupervisedStreaming &streaming)
+{
+    obs_output_force_stop(streaming.output);
+    beginConnectAttempt(streaming);
+
+    if (obs_output_start(streaming.output)) {
+        return true;
+    }
+
+    if (streaming.reconnectPending) {
+        ReconnectCoordinator::getInstance()->reportFailure(streaming.ingestHost, streaming.output);
+        streaming.reconnectPending = false;
+    }
+    return false;
+}
+
+void StreamingSupervisor::release(SupervisedStreaming &streaming)
+{
+    if (streaming.reconnectPending) {
+        ReconnectCoordinator::getInstance()->release(streaming.ingestHost, streaming.output);
+    }
+}
@@ -0,0 +1,120 @@
+/*
+Branch Output Plugin
+Copyright (C) 2024 OPENSPHERE Inc. info@opensphere.co.jp
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#pragma once
+
+#include <obs-module.h>
+#include <obs.hpp>
+
+#include <QString>
+
+#include <vector>
+
+#include "plugin-support.h"
+
+#define CONNECT_ATTEMPTING_TIMEOUT_NS 15000000000ULL
+
+// Streaming output state looked at by supervision (Filter's streaming context extends it with encoders and signals)
+struct SupervisedStreaming {
+    OBSOutputAutoRelease output;
+    uint64_t connectAttemptingAt;
+    bool active;           // Started by us (Kept while libobs or we are reconnecting)
+    QString ingestHost;    // Key for ReconnectCoordinator
+    bool reconnectPending; // Plugin level reconnect attempt waiting for result
+};
+
+// Streaming part of the filter's supervision: Connect attempts and plugin level reconnects after libobs gave up.
+// It only touches outputs and ReconnectCoordinator, so the standalone benchmark soaks it against an output shim.
+// Call from UI thread (Same as supervision), restarting outputs must be done with owner's output mutex locked.
+class StreamingSupervisor {
+public:
+    // Call right before obs_output_start() (Supervision waits for the result until timed out)
+    static void beginConnectAttempt(SupervisedStreaming &streaming);
+    static bool connectAttemptingTimedOut(const SupervisedStreaming &streaming);
+    // libobs gave up reconnecting by itself (obs_output_active() is true while libobs is reconnecting)
+    static bool gaveUp(const SupervisedStreaming &streaming);
+    // Report result of plugin level reconnect attempt (Call after connect attempt timed out)
+    static void settleReconnectAttempt(SupervisedStreaming &streaming);
+    // Return true when the streaming may reconnect now, otherwise set milliseconds to wait to waitMs
+    static bool acquireReconnect(SupervisedStreaming &streaming, uint64_t *waitMs);
+    // Force stop and start the output again, return false when it couldn't be started
+    static bool reconnect(SupervisedStreaming &streaming);
+    // Give up pending attempt without result (Call before the output is stopped)
+    static void release(SupervisedStreaming &streaming);
+
+    template<class T> static int countAlive(const std::vector<T> &streamings)
+    {
+        int count = 0;
+        for (auto &streaming : streamings) {
+            if (streaming.output && obs_output_active(streaming.output)) {
+                count++;
+            }
+        }
+        return count;
+    }
+
+    template<class T> static int countActive(const std::vector<T> &streamings)
+    {
+        int count = 0;
+        for (auto &streaming : streamings) {
+            if (streaming.active) {
+                count++;
+            }
+        }
+        return count;
+    }
+
+    // Return false while any started streaming is still in its connect attempt (Wait for results),
+    // otherwise settle every plugin level reconnect attempt and return true.
+    template<class T> static bool settle(std::vector<T> &streamings)
+    {
+        if (countActive(streamings) > 0) {
+            for (auto &streaming : streamings) {
+                if (streaming.output && !connectAttemptingTimedOut(streaming)) {
+                    return false;
+                }
+            }
+        }
+
+        for (auto &streaming : streamings) {
+            settleReconnectAttempt(streaming);
+        }
+        return true;
+    }
+
+    // Reconnect every streaming libobs gave up with backoff shared by the same ingest host.
+    // reconnectOutput(index) restarts the output (See reconnect()), waitReconnect(waitMs) is called for blocked ones.
+    template<class T, class R, class W>
+    static void reconnectGaveUp(const QString &name, std::vector<T> &streamings, R reconnectOutput, W waitReconnect)
+    {
+        for (size_t i = 0; i < streamings.size(); i++) {
+            if (!gaveUp(streamings[i])) {
+                continue;
+            }
+
+            uint64_t waitMs = 0;
+            if (!acquireReconnect(streamings[i], &waitMs)) {
+                waitReconnect(waitMs);
+                continue;
+            }
+
+            obs_log(LOG_INFO, "%s: Attempting reactivate the stream output %zu", qUtf8Printable(name), i);
+            reconnectOutput(i);
+        }
+    }
+};
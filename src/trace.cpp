@@ -0,0 +1,132 @@
+/*
+Branch Output Plugin
+Copyright (C) 2024 OPENSPHERE Inc. info@opensphere.co.jp
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#include "trace.hpp"
+
+#ifdef ENABLE_TRACING
+
+#include <obs-module.h>
+
+#include <QString>
+
+#include <functional>
+#include <thread>
+
+#include "plugin-support.h"
+
+static const char *siteNames[TRACE_SITE_COUNT] = {
+    "pushAudio", "popAudio", "audioFilterCallback", "startOutput", "stopOutput", "onIntervalTimerTimeout",
+};
+
+// Zero initialized as static storage
+Tracer::Histogram Tracer::histograms[TRACE_SITE_COUNT];
+Tracer::Event Tracer::events[TRACE_EVENT_CAPACITY];
+std::atomic<uint64_t> Tracer::eventCount(0);
+
+//--- Tracer class ---//
+
+// Called from any thread
+void Tracer::record(TraceSite site, uint64_t startNs, uint64_t endNs)
+{
+    auto durationNs = endNs - startNs;
+
+    // Bucket N holds [2^N, 2^(N+1)) ns
+    size_t bucket = 0;
+    while (bucket < TRACE_HISTOGRAM_BUCKETS - 1 && (durationNs >> (bucket + 1))) {
+        bucket++;
+    }
+
+    auto &histogram = histograms[site];
+    histogram.buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+    histogram.count.fetch_add(1, std::memory_order_relaxed);
+    histogram.totalNs.fetch_add(durationNs, std::memory_order_relaxed);
+
+    auto maxNs = histogram.maxNs.load(std::memory_order_relaxed);
+    while (durationNs > maxNs &&
+           !histogram.maxNs.compare_exchange_weak(maxNs, durationNs, std::memory_order_relaxed)) {
+    }
+
+    auto &event = events[eventCount.fetch_add(1, std::memory_order_relaxed) & (TRACE_EVENT_CAPACITY - 1)];
+    event.startNs.store(startNs, std::memory_order_relaxed);
+    event.durationNs.store(durationNs, std::memory_order_relaxed);
+    event.threadId.store(std::hash<std::thread::id>()(std::this_thread::get_id()), std::memory_order_relaxed);
+    event.site.store(site, std::memory_order_relaxed);
+}
+
+// Upper bound of the bucket which contains the percentile
+uint64_t Tracer::getPercentileNs(const Histogram &histogram, uint64_t count, int percent)
+{
+    auto threshold = (count * percent + 99) / 100;
+    uint64_t cumulative = 0;
+    for (size_t i = 0; i < TRACE_HISTOGRAM_BUCKETS; i++) {
+        cumulative += histogram.buckets[i].load(std::memory_order_relaxed);
+        if (cumulative >= threshold) {
+            return 2ULL << i;
+        }
+    }
+    return histogram.maxNs.load(std::memory_order_relaxed);
+}
+
+void Tracer::logHistograms()
+{
+    for (size_t i = 0; i < TRACE_SITE_COUNT; i++) {
+        auto &histogram = histograms[i];
+        auto count = histogram.count.load(std::memory_order_relaxed);
+        if (!count) {
+            continue;
+        }
+
+        obs_log(
+            LOG_INFO, "Trace %s: count=%llu avg=%.1fus p50<%.1fus p99<%.1fus max=%.1fus", siteNames[i],
+            (unsigned long long)count, (double)histogram.totalNs.load(std::memory_order_relaxed) / count / 1000.0,
+            (double)getPercentileNs(histogram, count, 50) / 1000.0,
+            (double)getPercentileNs(histogram, count, 99) / 1000.0,
+            (double)histogram.maxNs.load(std::memory_order_relaxed) / 1000.0
+        );
+    }
+}
+
+bool Tracer::writeChromeTrace(const char *path)
+{
+    auto total = eventCount.load(std::memory_order_relaxed);
+    auto first = total > TRACE_EVENT_CAPACITY ? total - TRACE_EVENT_CAPACITY : 0;
+
+    // Chrome trace event format ("X" is complete event, timestamps are in microseconds)
+    QString json = "{\"traceEvents\":[";
+    for (auto i = first; i < total; i++) {
+        auto &event = events[i & (TRACE_EVENT_CAPACITY - 1)];
+        json += QString("%1{\"name\":\"%2\",\"ph\":\"X\",\"pid\":1,\"tid\":%3,\"ts\":%4,\"dur\":%5}")
+                    .arg(i > first ? "," : "")
+                    .arg(siteNames[event.site.load(std::memory_order_relaxed)])
+                    .arg(event.threadId.load(std::memory_order_relaxed) & 0x7fffffff)
+                    .arg((double)event.startNs.load(std::memory_order_relaxed) / 1000.0, 0, 'f', 3)
+                    .arg((double)event.durationNs.load(std::memory_order_relaxed) / 1000.0, 0, 'f', 3);
+    }
+    json += "]}";
+
+    auto content = json.toUtf8();
+    if (!os_quick_write_utf8_file(path, content.constData(), content.size(), false)) {
+        obs_log(LOG_WARNING, "Failed to write trace to %s", path);
+        return false;
+    }
+
+    obs_log(LOG_INFO, "Trace written to %s (%llu events)", path, (unsigned long long)(total - first));
+    return true;
+}
+
+#endif
@@ -0,0 +1,93 @@
+/*
+Branch Output Plugin
+Copyright (C) 2024 OPENSPHERE Inc. info@opensphere.co.jp
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#pragma once
+
+// Hot path timing, compiled in with ENABLE_TRACING CMake option (TRACE_SCOPE() is empty otherwise)
+
+enum TraceSite {
+    TRACE_SITE_PUSH_AUDIO,
+    TRACE_SITE_POP_AUDIO,
+    TRACE_SITE_AUDIO_FILTER_CALLBACK,
+    TRACE_SITE_START_OUTPUT,
+    TRACE_SITE_STOP_OUTPUT,
+    TRACE_SITE_INTERVAL_TIMER,
+    TRACE_SITE_COUNT,
+};
+
+#ifdef ENABLE_TRACING
+
+#include <util/platform.h>
+
+#include <atomic>
+
+#define TRACE_HISTOGRAM_BUCKETS 40  // Power of 2 nanoseconds (Last one holds everything above ~9 minutes)
+#define TRACE_EVENT_CAPACITY 65536  // Recent events kept for Chrome trace (Must be power of 2)
+#define TRACE_JSON_NAME "trace.json"
+
+#define TRACE_SCOPE(site) TraceScope _traceScope(site)
+
+// Lock-free duration histograms per site and ring of recent events.
+// Recording is wait-free for any thread (Only relaxed atomics), readers may see events being overwritten.
+class Tracer {
+    struct Histogram {
+        std::atomic<uint64_t> buckets[TRACE_HISTOGRAM_BUCKETS];
+        std::atomic<uint64_t> count;
+        std::atomic<uint64_t> totalNs;
+        std::atomic<uint64_t> maxNs;
+    };
+
+    struct Event {
+        std::atomic<uint64_t> startNs;
+        std::atomic<uint64_t> durationNs;
+        std::atomic<uint64_t> threadId;
+        std::atomic<int> site;
+    };
+
+    static Histogram histograms[TRACE_SITE_COUNT];
+    static Event events[TRACE_EVENT_CAPACITY];
+    static std::atomic<uint64_t> eventCount;
+
+    static uint64_t getPercentileNs(const Histogram &histogram, uint64_t count, int percent);
+
+public:
+    static void record(TraceSite site, uint64_t startNs, uint64_t endNs);
+
+    // Summary of every site to OBS log
+    static void logHistograms();
+    // Recent events as Chrome trace file (Open with chrome://tracing or Perfetto)
+    static bool writeChromeTrace(const char *path);
+};
+
+class TraceScope {
+    TraceSite site;
+    uint64_t startNs;
+
+public:
+    inline explicit TraceScope(TraceSite _site) : site(_site), startNs(os_gettime_ns()) {}
+    inline ~TraceScope() { Tracer::record(site, startNs, os_gettime_ns()); }
+
+    TraceScope(const TraceScope &) = delete;
+    TraceScope &operator=(const TraceScope &) = delete;
+};
+
+#else
+
+#define TRACE_SCOPE(site)
+
+#endif
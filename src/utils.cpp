@@ -119,3 +119,45 @@ QString getOutputFilename(const char *path, const char *container, bool noSpace,
 
     return strPath;
 }
+
+// Flatten settings into comparable strings (Default values are included)
+QMap<QString, QString> getSettingsValues(obs_data_t *settings)
+{
+    QMap<QString, QString> values;
+
+    for (auto item = obs_data_first(settings); item; obs_data_item_next(&item)) {
+        QString value;
+
+        switch (obs_data_item_gettype(item)) {
+        case OBS_DATA_STRING:
+            value = obs_data_item_get_string(item);
+            break;
+        case OBS_DATA_NUMBER:
+            value = obs_data_item_numtype(item) == OBS_DATA_NUM_INT ? QString::number(obs_data_item_get_int(item))
+                                                                     : QString::number(obs_data_item_get_double(item));
+            break;
+        case OBS_DATA_BOOLEAN:
+            value = obs_data_item_get_bool(item) ? "true" : "false";
+            break;
+        case OBS_DATA_OBJECT: {
+            OBSDataAutoRelease obj = obs_data_item_get_obj(item);
+            value = obj ? obs_data_get_json(obj) : "";
+            break;
+        }
+        case OBS_DATA_ARRAY: {
+            OBSDataArrayAutoRelease array = obs_data_item_get_array(item);
+            for (size_t i = 0; array && i < obs_data_array_count(array); i++) {
+                OBSDataAutoRelease element = obs_data_array_item(array, i);
+                value += obs_data_get_json(element);
+            }
+            break;
+        }
+        default:
+            break;
+        }
+
+        values[obs_data_item_get_name(item)] = value;
+    }
+
+    return values;
+}
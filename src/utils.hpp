@@ -27,9 +27,14 @@ with this program. If not, see <https://www.gnu.org/licenses/>
 #include <QString>
 #include <QWidget>
 #include <QVariant>
+#include <QMap>
+
+#include "indexed-prop-name.hpp"
+#include "source-membership.hpp"
 
 QString getOutputFilename(const char *path, const char *container, bool noSpace, bool overwrite, const char *format);
 QString getFormatExt(const char *container);
+QMap<QString, QString> getSettingsValues(obs_data_t *settings);
 
 using OBSProperties = OBSPtr<obs_properties_t *, obs_properties_destroy>;
 using OBSAudio = OBSPtr<audio_t *, audio_output_close>;
@@ -82,6 +87,12 @@ inline bool sourceInFrontend(obs_source_t *source)
         return false;
     }
 
+    auto index = SourceMembershipIndex::getInstance();
+    if (index) {
+        return index->inFrontend(source);
+    }
+
+    // Fallback scan (Before plugin post load)
     auto found = false;
 
     obs_frontend_source_list lsit = {0};
@@ -104,6 +115,12 @@ inline bool sourceInFrontend(obs_source_t *source)
 // Decide source/scene is private or not
 inline bool sourceIsPrivate(obs_source_t *source)
 {
+    auto index = SourceMembershipIndex::getInstance();
+    if (index) {
+        return index->isPrivate(source);
+    }
+
+    // Fallback scan (Before plugin post load)
     auto finder = source;
     auto callback = [](void *param, obs_source_t *_source) {
         auto _finder = (obs_source_t **)param;
@@ -142,8 +159,3 @@ inline void loadHotkey(obs_hotkey_id id, const char *name)
         obs_hotkey_load(id, array);
     }
 }
-
-inline QString getIndexedPropNameFormat(size_t index, size_t base = 0)
-{
-    return index == base ? QString("%1") : QString("%%1_%1").arg(index);
-}
@@ -0,0 +1,141 @@
+/*
+Branch Output Plugin
+Copyright (C) 2024 OPENSPHERE Inc. info@opensphere.co.jp
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#include <obs-module.h>
+
+#include "main-canvas-mirror.hpp"
+
+//--- MainCanvasMirror class ---//
+
+MainCanvasMirror::MainCanvasMirror(obs_source_t *_source) : source(_source) {}
+
+// Called from graphics thread
+bool MainCanvasMirror::parentOnProgram(obs_source_t *parent)
+{
+    OBSSourceAutoRelease output = obs_get_output_source(0);
+    if (!output) {
+        return false;
+    }
+    if (output == parent) {
+        return true;
+    }
+    if (obs_source_get_type(output) != OBS_SOURCE_TYPE_TRANSITION) {
+        return false;
+    }
+
+    // Main canvas blends two scenes while transitioning
+    OBSSourceAutoRelease transitionTo = obs_transition_get_source(output, OBS_TRANSITION_SOURCE_B);
+    if (transitionTo) {
+        return false;
+    }
+
+    OBSSourceAutoRelease program = obs_transition_get_active_source(output);
+    return program == parent;
+}
+
+// Called from graphics thread
+void MainCanvasMirror::render(gs_effect_t *)
+{
+    OBSSourceAutoRelease parent = obs_weak_source_get_source(weakParent);
+    if (!parent) {
+        return;
+    }
+
+    // Main canvas is rendered earlier in the same frame (Main mix always comes first)
+    auto texture = parentOnProgram(parent) ? obs_get_main_texture() : nullptr;
+    if (!texture) {
+        obs_source_video_render(parent);
+        return;
+    }
+
+    const auto previous = gs_framebuffer_srgb_enabled();
+    gs_enable_framebuffer_srgb(true);
+    gs_blend_state_push();
+    gs_blend_function(GS_BLEND_ONE, GS_BLEND_ZERO);
+
+    auto effect = obs_get_base_effect(OBS_EFFECT_DEFAULT);
+    gs_effect_set_texture_srgb(gs_effect_get_param_by_name(effect, "image"), texture);
+    while (gs_effect_loop(effect, "Draw")) {
+        gs_draw_sprite(texture, 0, 0, 0);
+    }
+
+    gs_blend_state_pop();
+    gs_enable_framebuffer_srgb(previous);
+}
+
+obs_source_info MainCanvasMirror::createSourceInfo()
+{
+    obs_source_info info = {0};
+
+    info.id = MAIN_CANVAS_MIRROR_ID;
+    info.type = OBS_SOURCE_TYPE_INPUT;
+    // Never listed in frontend
+    info.output_flags = OBS_SOURCE_VIDEO | OBS_SOURCE_CAP_DISABLED;
+
+    info.get_name = [](void *) {
+        return "Branch Output Main Canvas Mirror";
+    };
+
+    // Parent is given by create() right after the source is created
+    info.create = [](obs_data_t *, obs_source_t *source) -> void * {
+        return new MainCanvasMirror(source);
+    };
+    info.destroy = [](void *data) {
+        delete static_cast<MainCanvasMirror *>(data);
+    };
+
+    info.get_width = [](void *data) -> uint32_t {
+        auto mirror = static_cast<MainCanvasMirror *>(data);
+        OBSSourceAutoRelease parent = mirror ? obs_weak_source_get_source(mirror->weakParent) : nullptr;
+        return parent ? obs_source_get_width(parent) : 0;
+    };
+    info.get_height = [](void *data) -> uint32_t {
+        auto mirror = static_cast<MainCanvasMirror *>(data);
+        OBSSourceAutoRelease parent = mirror ? obs_weak_source_get_source(mirror->weakParent) : nullptr;
+        return parent ? obs_source_get_height(parent) : 0;
+    };
+    info.video_render = [](void *data, gs_effect_t *effect) {
+        auto mirror = static_cast<MainCanvasMirror *>(data);
+        if (mirror) {
+            mirror->render(effect);
+        }
+    };
+    // Parent is activated and shown through the mirror like a child (It's rendered whenever off program)
+    info.enum_active_sources = [](void *data, obs_source_enum_proc_t enumCallback, void *param) {
+        auto mirror = static_cast<MainCanvasMirror *>(data);
+        OBSSourceAutoRelease parent = mirror ? obs_weak_source_get_source(mirror->weakParent) : nullptr;
+        if (parent) {
+            enumCallback(mirror->source, parent, param);
+        }
+    };
+
+    return info;
+}
+
+obs_source_t *MainCanvasMirror::create(const QString &name, obs_source_t *parent)
+{
+    auto source = obs_source_create_private(MAIN_CANVAS_MIRROR_ID, qUtf8Printable(name), nullptr);
+    auto mirror = source ? static_cast<MainCanvasMirror *>(obs_obj_get_data(source)) : nullptr;
+    if (!mirror) {
+        obs_source_release(source);
+        return nullptr;
+    }
+
+    mirror->weakParent = obs_source_get_weak_source(parent);
+    return source;
+}
@@ -0,0 +1,45 @@
+/*
+Branch Output Plugin
+Copyright (C) 2024 OPENSPHERE Inc. info@opensphere.co.jp
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#pragma once
+
+#include <obs-module.h>
+#include <obs.hpp>
+
+#include <QString>
+
+#define MAIN_CANVAS_MIRROR_ID "osi_branch_output_main_canvas_mirror"
+
+// Private source which draws the main canvas texture while its parent scene is on program, so a view of the
+// program scene doesn't render the scene again. Otherwise (Other scene on program, or in the middle of
+// a transition) the parent is rendered as usual, so the view can keep this source all the time.
+// Main canvas texture has canvas base size, so parent must be as large as the canvas.
+class MainCanvasMirror {
+    obs_source_t *source;
+    OBSWeakSourceAutoRelease weakParent;
+
+    explicit MainCanvasMirror(obs_source_t *source);
+
+    bool parentOnProgram(obs_source_t *parent);
+    void render(gs_effect_t *effect);
+
+public:
+    static obs_source_info createSourceInfo();
+    // Return new private source (Release with obs_source_release())
+    static obs_source_t *create(const QString &name, obs_source_t *parent);
+};
@@ -0,0 +1,494 @@
+/*
+Branch Output Plugin
+Copyright (C) 2024 OPENSPHERE Inc. info@opensphere.co.jp
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#include <obs-module.h>
+
+#include <QCryptographicHash>
+
+#include "video-engine.hpp"
+#include "main-canvas-mirror.hpp"
+#include "../plugin-support.h"
+
+VideoEngine *VideoEngine::instance = nullptr;
+
+//--- VideoEngine class ---//
+
+VideoEngine::VideoEngine() : hardwareSessionLimit(0) {}
+
+VideoEngine::~VideoEngine()
+{
+    // Normally all encoders have been released at this time
+    foreach (auto entry, encoders) {
+        obs_log(LOG_WARNING, "Video engine: Closing shared encoder with %zu users", entry->refs);
+        obs_encoder_release(entry->encoder);
+        delete entry;
+    }
+    encoders.clear();
+
+    foreach (auto entry, views) {
+        setViewActive(entry, true);
+        obs_view_set_source(entry->view, 0, nullptr);
+        obs_view_remove(entry->view);
+        delete entry;
+    }
+    views.clear();
+}
+
+VideoEngine *VideoEngine::getInstance()
+{
+    // First call is made in obs_module_load() before any worker thread runs
+    if (!instance) {
+        instance = new VideoEngine();
+    }
+    return instance;
+}
+
+void VideoEngine::destroyInstance()
+{
+    delete instance;
+    instance = nullptr;
+}
+
+QString VideoEngine::getHardwareFamily(const char *encoderId)
+{
+    QString id = encoderId;
+    if (id.contains("nvenc")) {
+        return "nvenc";
+    } else if (id.contains("qsv")) {
+        return "qsv";
+    } else if (id.contains("amf")) {
+        return "amf";
+    } else if (id.contains("vaapi")) {
+        return "vaapi";
+    } else if (id.contains("videotoolbox")) {
+        return "videotoolbox";
+    }
+
+    // Unknown vendor's encoder which takes GPU texture
+    if (obs_get_encoder_caps(encoderId) & OBS_ENCODER_CAP_PASS_TEXTURE) {
+        return id;
+    }
+    return "";
+}
+
+void VideoEngine::setHardwareSessionLimit(int limit)
+{
+    QMutexLocker locker(&mutex);
+    hardwareSessionLimit = limit;
+}
+
+void VideoEngine::setFallbackEncoder(const QString &encoder)
+{
+    QMutexLocker locker(&mutex);
+    fallbackEncoder = encoder;
+}
+
+QString VideoEngine::makeViewKey(obs_source_t *parent, const obs_video_info *ovi, bool letterbox, bool mainCanvas)
+{
+    return QString("%1|%2x%3@%4/%5%6%7")
+        .arg(obs_source_get_uuid(parent))
+        .arg(ovi->base_width)
+        .arg(ovi->base_height)
+        .arg(ovi->fps_num)
+        .arg(ovi->fps_den)
+        .arg(letterbox ? "|letterbox" : "")
+        .arg(mainCanvas ? "|main" : "");
+}
+
+QString VideoEngine::makeEncoderKey(const QString &viewKey, obs_data_t *settings, const obs_video_info *encvi)
+{
+    auto encoderId = obs_data_get_string(settings, "video_encoder");
+
+    // Filter settings contain everything (Servers, keys, audio...), so only hash properties the encoder knows.
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    OBSDataAutoRelease defaults = obs_encoder_defaults(encoderId);
+    for (auto item = obs_data_first(defaults); item; obs_data_item_next(&item)) {
+        auto itemName = obs_data_item_get_name(item);
+        QString value;
+
+        switch (obs_data_item_gettype(item)) {
+        case OBS_DATA_STRING:
+            value = obs_data_get_string(settings, itemName);
+            break;
+        case OBS_DATA_NUMBER:
+            if (obs_data_item_numtype(item) == OBS_DATA_NUM_INT) {
+                value = QString::number(obs_data_get_int(settings, itemName));
+            } else {
+                value = QString::number(obs_data_get_double(settings, itemName));
+            }
+            break;
+        case OBS_DATA_BOOLEAN:
+            value = obs_data_get_bool(settings, itemName) ? "true" : "false";
+            break;
+        case OBS_DATA_OBJECT: {
+            OBSDataAutoRelease obj = obs_data_get_obj(settings, itemName);
+            value = obj ? obs_data_get_json(obj) : "";
+            break;
+        }
+        default:
+            continue;
+        }
+
+        hash.addData(QString("%1=%2\n").arg(itemName).arg(value).toUtf8());
+    }
+
+    return QString("%1|%2|%3|%4x%5|%6|/%7")
+        .arg(viewKey)
+        .arg(encoderId)
+        .arg(QString::fromLatin1(hash.result().toHex()))
+        .arg(encvi->output_width)
+        .arg(encvi->output_height)
+        .arg((int)encvi->scale_type)
+        .arg(obs_data_get_int(settings, "frame_rate_divisor"));
+}
+
+// Must be called with mutex held
+size_t VideoEngine::countHardwareSessions(const QString &family)
+{
+    // Every shared encoder holds one session regardless of its users, unless all of them are idle in standby
+    size_t count = 0;
+    foreach (auto entry, encoders) {
+        if (entry->hardwareFamily == family && entry->refs > entry->idleStandbyUsers) {
+            count++;
+        }
+    }
+    return count;
+}
+
+// Must be called with mutex held, return nullptr when no fallback is configured
+obs_data_t *VideoEngine::createFallbackSettings(obs_data_t *settings)
+{
+    if (fallbackEncoder.isEmpty()) {
+        return nullptr;
+    }
+
+    auto parts = fallbackEncoder.split(':');
+    auto encoderId = parts[0];
+    auto fallbackSettings = obs_encoder_defaults(qUtf8Printable(encoderId));
+    if (!fallbackSettings) {
+        obs_log(LOG_WARNING, "Video engine: Fallback encoder '%s' not found", qUtf8Printable(encoderId));
+        return nullptr;
+    }
+
+    obs_data_set_string(fallbackSettings, "video_encoder", qUtf8Printable(encoderId));
+    if (parts.size() > 1) {
+        obs_data_set_string(fallbackSettings, "preset", qUtf8Printable(parts[1]));
+    }
+
+    // Keep bitrate and keyframe interval of requested encoder (Services may require them)
+    auto bitrate = obs_data_get_int(settings, "bitrate");
+    if (bitrate > 0) {
+        obs_data_set_string(fallbackSettings, "rate_control", "CBR");
+        obs_data_set_int(fallbackSettings, "bitrate", bitrate);
+    }
+    obs_data_set_int(fallbackSettings, "keyint_sec", obs_data_get_int(settings, "keyint_sec"));
+    obs_data_set_int(fallbackSettings, "frame_rate_divisor", obs_data_get_int(settings, "frame_rate_divisor"));
+
+    return fallbackSettings;
+}
+
+// Must be called with mutex held
+VideoEngine::SharedVideoEncoder *VideoEngine::findEncoder(const QString &key)
+{
+    foreach (auto entry, encoders) {
+        if (!entry->exclusive && entry->key == key) {
+            return entry;
+        }
+    }
+    return nullptr;
+}
+
+// Must be called with mutex held
+VideoEngine::SharedVideoView *
+VideoEngine::acquireView(
+    const QString &name, obs_source_t *parent, const obs_video_info *ovi, bool letterbox, bool mainCanvas
+)
+{
+    auto key = makeViewKey(parent, ovi, letterbox, mainCanvas);
+
+    foreach (auto entry, views) {
+        if (entry->key == key) {
+            entry->refs++;
+            return entry;
+        }
+    }
+
+    OBSSceneAutoRelease scene;
+    OBSSourceAutoRelease mirror;
+    if (mainCanvas) {
+        // Parent on program is already rendered by main output, so the view copies it from there
+        mirror = MainCanvasMirror::create(QString("%1 (Main Canvas)").arg(name), parent);
+        if (!mirror) {
+            obs_log(LOG_ERROR, "%s: Main canvas mirror creation failed", qUtf8Printable(name));
+            return nullptr;
+        }
+        obs_log(LOG_INFO, "%s: Capturing from main canvas while on program", qUtf8Printable(name));
+    } else if (letterbox) {
+        // Wrap parent source with private scene which scales it into the fixed view size
+        scene = obs_scene_create_private(qUtf8Printable(QString("%1 (Letterbox)").arg(name)));
+        auto item = obs_scene_add(scene, parent);
+        if (!item) {
+            obs_log(LOG_ERROR, "%s: Letterbox scene creation failed", qUtf8Printable(name));
+            return nullptr;
+        }
+
+        vec2 bounds;
+        vec2_set(&bounds, (float)ovi->base_width, (float)ovi->base_height);
+        obs_sceneitem_set_bounds_type(item, OBS_BOUNDS_SCALE_INNER);
+        obs_sceneitem_set_bounds_alignment(item, OBS_ALIGN_CENTER);
+        obs_sceneitem_set_bounds(item, &bounds);
+    }
+
+    // Create view without source, it's associated with parent source (or its letterbox wrapper) on activation
+    OBSView view = obs_view_create();
+
+    // obs_view_add2() modifies its argument
+    obs_video_info viewvi = *ovi;
+    auto videoOutput = obs_view_add2(view, &viewvi);
+    if (!videoOutput) {
+        obs_log(LOG_ERROR, "%s: Video output association failed", qUtf8Printable(name));
+        return nullptr;
+    }
+
+    auto entry = new SharedVideoView();
+    entry->key = key;
+    entry->view = std::move(view);
+    entry->source = scene ? obs_scene_get_source(scene) : mirror ? mirror.Get() : parent;
+    entry->scene = std::move(scene);
+    entry->mirror = std::move(mirror);
+    entry->videoOutput = videoOutput;
+    entry->active = false;
+    entry->refs = 1;
+    views.push_back(entry);
+
+    // Idle view holds source's activation by itself (Deactivated source behaves differently e.g. media restart)
+    obs_source_inc_active(entry->source);
+
+    obs_log(LOG_DEBUG, "Video engine: Shared view created (views=%lld)", (long long)views.size());
+    return entry;
+}
+
+// Must be called with mutex held
+void VideoEngine::releaseView(SharedVideoView *view)
+{
+    if (--view->refs > 0) {
+        return;
+    }
+
+    views.removeOne(view);
+    setViewActive(view, true);
+    obs_view_set_source(view->view, 0, nullptr);
+    obs_view_remove(view->view);
+    delete view;
+    obs_log(LOG_DEBUG, "Video engine: Shared view destroyed");
+}
+
+// Must be called with mutex held
+void VideoEngine::setViewActive(SharedVideoView *view, bool active)
+{
+    if (view->active == active) {
+        return;
+    }
+    view->active = active;
+
+    // Swap view's source and own activation so that the source never sees deactivation
+    if (active) {
+        obs_view_set_source(view->view, 0, view->source);
+        obs_source_dec_active(view->source);
+    } else {
+        obs_source_inc_active(view->source);
+        obs_view_set_source(view->view, 0, nullptr);
+    }
+}
+
+obs_encoder_t *VideoEngine::acquireEncoder(
+    const QString &name, obs_source_t *parent, obs_data_t *settings, const obs_video_info *ovi,
+    const obs_video_info *encvi, bool letterbox, bool *fallback, bool exclusive, bool mainCanvas
+)
+{
+    auto viewKey = makeViewKey(parent, ovi, letterbox, mainCanvas);
+    auto key = makeEncoderKey(viewKey, settings, encvi);
+    auto family = getHardwareFamily(obs_data_get_string(settings, "video_encoder"));
+
+    QMutexLocker locker(&mutex);
+
+    auto shared = exclusive ? nullptr : findEncoder(key);
+    OBSDataAutoRelease fallbackSettings;
+
+    if (!shared && !family.isEmpty() && hardwareSessionLimit > 0 &&
+        countHardwareSessions(family) >= (size_t)hardwareSessionLimit) {
+        // Sharing doesn't need new session, but this one does
+        fallbackSettings = createFallbackSettings(settings);
+        if (!fallbackSettings) {
+            obs_log(
+                LOG_ERROR, "%s: No more %s sessions available (limit=%d)", qUtf8Printable(name), qUtf8Printable(family),
+                hardwareSessionLimit
+            );
+            return nullptr;
+        }
+
+        obs_log(
+            LOG_WARNING, "%s: No more %s sessions available (limit=%d), Falling back to '%s'", qUtf8Printable(name),
+            qUtf8Printable(family), hardwareSessionLimit, qUtf8Printable(fallbackEncoder)
+        );
+        settings = fallbackSettings;
+        key = makeEncoderKey(viewKey, settings, encvi);
+        shared = exclusive ? nullptr : findEncoder(key);
+    }
+
+    if (shared) {
+        shared->refs++;
+        obs_log(
+            LOG_INFO, "%s: Sharing video encoder '%s' (users=%zu)", qUtf8Printable(name),
+            obs_encoder_get_name(shared->encoder), shared->refs
+        );
+        if (fallback) {
+            *fallback = shared->fallback;
+        }
+        return obs_encoder_get_ref(shared->encoder);
+    }
+
+    auto view = acquireView(name, parent, ovi, letterbox, mainCanvas);
+    if (!view) {
+        return nullptr;
+    }
+
+    auto encoder = obs_video_encoder_create(
+        obs_data_get_string(settings, "video_encoder"), qUtf8Printable(name), settings, nullptr
+    );
+    if (!encoder && !fallbackSettings && !family.isEmpty()) {
+        // Hardware may be unavailable (Driver issue, sessions used by other applications...)
+        fallbackSettings = createFallbackSettings(settings);
+        if (fallbackSettings) {
+            obs_log(
+                LOG_WARNING, "%s: Hardware encoder creation failed, Falling back to '%s'", qUtf8Printable(name),
+                qUtf8Printable(fallbackEncoder)
+            );
+            settings = fallbackSettings;
+            key = makeEncoderKey(viewKey, settings, encvi);
+            encoder = obs_video_encoder_create(
+                obs_data_get_string(settings, "video_encoder"), qUtf8Printable(name), settings, nullptr
+            );
+        }
+    }
+    if (!encoder) {
+        obs_log(LOG_ERROR, "%s: Video encoder creation failed", qUtf8Printable(name));
+        releaseView(view);
+        return nullptr;
+    }
+
+    if (ovi->base_width == encvi->output_width && ovi->base_height == encvi->output_height) {
+        // No scaling
+        obs_encoder_set_scaled_size(encoder, 0, 0);
+    } else {
+        obs_log(
+            LOG_DEBUG, "%s: Output resolution is %dx%d (scaling=%d)", qUtf8Printable(name), encvi->output_width,
+            encvi->output_height, encvi->scale_type
+        );
+        obs_encoder_set_scaled_size(encoder, encvi->output_width, encvi->output_height);
+        obs_encoder_set_gpu_scale_type(encoder, encvi->scale_type);
+    }
+
+    auto divisor = (uint32_t)obs_data_get_int(settings, "frame_rate_divisor");
+    if (divisor > 1) {
+#if LIBOBS_API_VER >= MAKE_SEMANTIC_VERSION(30, 2, 0)
+        // Encoder only receives every n-th frame of the view
+        obs_log(LOG_DEBUG, "%s: Frame rate divisor is %u", qUtf8Printable(name), divisor);
+        obs_encoder_set_frame_rate_divisor(encoder, divisor);
+#else
+        obs_log(LOG_WARNING, "%s: Frame rate divisor requires OBS 30.2 or later", qUtf8Printable(name));
+#endif
+    }
+    obs_encoder_set_video(encoder, view->videoOutput);
+
+    auto entry = new SharedVideoEncoder();
+    entry->key = key;
+    entry->view = view;
+    entry->encoder = encoder;
+    entry->hardwareFamily = fallbackSettings ? QString() : family;
+    entry->fallback = fallbackSettings != nullptr;
+    entry->exclusive = exclusive;
+    entry->idleStandbyUsers = 0;
+    entry->refs = 1;
+    encoders.push_back(entry);
+
+    obs_log(LOG_DEBUG, "Video engine: Shared encoder created (encoders=%lld)", (long long)encoders.size());
+
+    if (fallback) {
+        *fallback = entry->fallback;
+    }
+    return obs_encoder_get_ref(encoder);
+}
+
+void VideoEngine::releaseEncoder(obs_encoder_t *encoder)
+{
+    QMutexLocker locker(&mutex);
+
+    foreach (auto entry, encoders) {
+        if (entry->encoder != encoder) {
+            continue;
+        }
+
+        if (--entry->refs == 0) {
+            encoders.removeOne(entry);
+            obs_encoder_release(entry->encoder);
+            releaseView(entry->view);
+            delete entry;
+            obs_log(LOG_DEBUG, "Video engine: Shared encoder destroyed");
+        }
+        break;
+    }
+}
+
+void VideoEngine::setStandbyIdle(obs_encoder_t *encoder, bool idle)
+{
+    QMutexLocker locker(&mutex);
+
+    foreach (auto entry, encoders) {
+        if (entry->encoder != encoder) {
+            continue;
+        }
+
+        if (idle) {
+            entry->idleStandbyUsers++;
+        } else if (entry->idleStandbyUsers > 0) {
+            entry->idleStandbyUsers--;
+        }
+        break;
+    }
+}
+
+void VideoEngine::updateViewActivity()
+{
+    QMutexLocker locker(&mutex);
+
+    foreach (auto view, views) {
+        auto active = false;
+        foreach (auto entry, encoders) {
+            if (entry->view == view && obs_encoder_active(entry->encoder)) {
+                active = true;
+                break;
+            }
+        }
+
+        if (view->active != active) {
+            setViewActive(view, active);
+            obs_log(LOG_DEBUG, "Video engine: Shared view %s", active ? "activated" : "deactivated");
+        }
+    }
+}
@@ -0,0 +1,113 @@
+/*
+Branch Output Plugin
+Copyright (C) 2024 OPENSPHERE Inc. info@opensphere.co.jp
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#pragma once
+
+#include <obs-module.h>
+#include <obs.hpp>
+
+#include <QList>
+#include <QMutex>
+#include <QString>
+
+// Shares view and video encoder between outputs which render the same source with the same encoder setup.
+// Views are keyed by parent source and video spec. Encoders are keyed by view, encoder id, encoder settings and
+// scaled size, so several renditions of one branch are scaled on GPU from a single view,
+// and a source is rendered and encoded only once no matter how many filters branch it out identically.
+// Hardware encoders are counted per vendor family against a session budget, and new encoders fall back to
+// a software encoder when the budget is exhausted (Consumer GPUs limit concurrent encoding sessions).
+class VideoEngine {
+    struct SharedVideoView {
+        QString key;
+        OBSView view;
+        OBSSceneAutoRelease scene;   // Letterbox wrapper of parent source (Letterbox mode only)
+        OBSSourceAutoRelease mirror; // Main canvas mirror of parent source (Main canvas mode only)
+        OBSSource source;            // Rendered by the view while it's active (Parent source or its wrapper)
+        video_t *videoOutput;
+        bool active; // Any encoder of the view is running
+        size_t refs;
+    };
+
+    struct SharedVideoEncoder {
+        QString key;
+        SharedVideoView *view;
+        obs_encoder_t *encoder;
+        QString hardwareFamily; // Empty for software encoder
+        bool fallback;
+        bool exclusive;        // Never found by findEncoder()
+        size_t idleStandbyUsers; // Users in warm standby which don't initialize it (Hold no session)
+        size_t refs;
+    };
+
+    QMutex mutex;
+    QList<SharedVideoView *> views;
+    QList<SharedVideoEncoder *> encoders;
+    int hardwareSessionLimit; // Per hardware family, 0 means unlimited
+    QString fallbackEncoder;  // "encoder_id" or "encoder_id:preset", empty means no fallback
+
+    static VideoEngine *instance;
+
+    static QString makeViewKey(obs_source_t *parent, const obs_video_info *ovi, bool letterbox, bool mainCanvas);
+    static QString makeEncoderKey(const QString &viewKey, obs_data_t *settings, const obs_video_info *encvi);
+    size_t countHardwareSessions(const QString &family);
+    obs_data_t *createFallbackSettings(obs_data_t *settings);
+    SharedVideoEncoder *findEncoder(const QString &key);
+
+    SharedVideoView *acquireView(
+        const QString &name, obs_source_t *parent, const obs_video_info *ovi, bool letterbox, bool mainCanvas
+    );
+    void releaseView(SharedVideoView *view);
+    void setViewActive(SharedVideoView *view, bool active);
+
+    VideoEngine();
+    ~VideoEngine();
+
+public:
+    static VideoEngine *getInstance();
+    // Call from obs_module_unload()
+    static void destroyInstance();
+
+    // Return vendor family of hardware encoder ("nvenc", "qsv", "amf"...), empty for software encoder
+    static QString getHardwareFamily(const char *encoderId);
+
+    void setHardwareSessionLimit(int limit);
+    void setFallbackEncoder(const QString &encoder);
+
+    // Return new reference of the shared encoder (Give back with releaseEncoder()), nullptr on failure.
+    // ovi describes the view (Source resolution), encvi describes the encoder output (Scaled size and filter).
+    // With letterbox, the view keeps ovi's size and parent source is fitted into it whenever it's resized.
+    // fallback is set when software encoder is used instead of requested hardware encoder.
+    // Exclusive encoder is never shared (Its settings are changed on the fly e.g. adaptive bitrate).
+    // With mainCanvas, the view copies main canvas texture instead of rendering parent while parent is on program
+    // (Parent must be as large as the canvas). The view follows program changes without restarting the encoder.
+    obs_encoder_t *acquireEncoder(
+        const QString &name, obs_source_t *parent, obs_data_t *settings, const obs_video_info *ovi,
+        const obs_video_info *encvi, bool letterbox = false, bool *fallback = nullptr, bool exclusive = false,
+        bool mainCanvas = false
+    );
+    // Caller must drop own encoder reference as well. View is destroyed with the last user.
+    void releaseEncoder(obs_encoder_t *encoder);
+    // Hardware encoder is counted against the session budget from creation until its last release, whether or not
+    // it's running (Connecting and reconnecting outputs keep their sessions). Only the encoder whose users are all
+    // idle in warm standby without initializing it isn't counted, so mark such a user until it starts or stops.
+    void setStandbyIdle(obs_encoder_t *encoder, bool idle);
+
+    // Views render nothing until one of their encoders is started by an output (Connecting and reconnecting
+    // outputs are free of render cost). Call whenever outputs may have started or stopped (Thread-safe).
+    void updateViewActivity();
+};
@@ -0,0 +1,151 @@
+/*
+Branch Output Plugin
+Copyright (C) 2024 OPENSPHERE Inc. info@opensphere.co.jp
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#include <obs-module.h>
+
+#include <chrono>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+#include "audio/audio-capture.hpp"
+#include "audio/audio-mix.hpp"
+#include "benchmark.hpp"
+#include "obs-stub.hpp"
+
+struct AudioBenchmarkResult {
+    uint64_t pushNs;
+    uint64_t popNs;
+    uint64_t maxTickNs;
+    uint64_t frames; // Output frames per capture
+    uint64_t underruns;
+};
+
+static inline uint64_t elapsedNs(std::chrono::steady_clock::time_point since)
+{
+    auto elapsed = std::chrono::steady_clock::now() - since;
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+}
+
+static inline uint64_t framesToNs(uint64_t frames)
+{
+    return frames * 1000000000ULL / AUDIO_BENCHMARK_SAMPLE_RATE;
+}
+
+// Producer and consumer are interleaved in one thread, consumer keeps two blocks behind (Drift compensation primes)
+static AudioBenchmarkResult runCase(speaker_layout speakers, size_t chunkFrames, size_t captureCount, bool drift)
+{
+    AudioBenchmarkResult result = {0};
+    auto channels = get_audio_channels(speakers);
+
+    // Same spec, so every capture is hosted by one mixer pool
+    std::vector<AudioCapture *> captures;
+    for (size_t i = 0; i < captureCount; i++) {
+        auto capture = new AudioCapture("Benchmark", AUDIO_BENCHMARK_SAMPLE_RATE, speakers, false);
+        capture->setDriftCompensation(drift);
+        captures.push_back(capture);
+    }
+    auto audio = captures[0]->getAudio();
+    if (!audio) {
+        fprintf(stderr, "Audio engine attach failed\n");
+        for (auto capture : captures) {
+            delete capture;
+        }
+        return result;
+    }
+
+    std::vector<float> input(channels * chunkFrames);
+    for (size_t i = 0; i < input.size(); i++) {
+        input[i] = (float)(i % 200) / 100.0f - 1.0f;
+    }
+    audio_data chunk = {};
+    for (size_t ch = 0; ch < channels; ch++) {
+        chunk.data[ch] = (uint8_t *)&input[ch * chunkFrames];
+    }
+    chunk.frames = (uint32_t)chunkFrames;
+
+    std::vector<float> output(MAX_AUDIO_MIXES * channels * AUDIO_OUTPUT_FRAMES);
+    audio_output_data mixes[MAX_AUDIO_MIXES] = {};
+    for (size_t mix = 0; mix < MAX_AUDIO_MIXES; mix++) {
+        for (size_t ch = 0; ch < channels; ch++) {
+            mixes[mix].data[ch] = &output[(mix * channels + ch) * AUDIO_OUTPUT_FRAMES];
+        }
+    }
+    auto mixers = (uint32_t)((1U << captureCount) - 1);
+
+    uint64_t pushedFrames = 0;
+    auto totalFrames = (uint64_t)AUDIO_BENCHMARK_SAMPLE_RATE * AUDIO_BENCHMARK_SECONDS;
+    while (result.frames < totalFrames) {
+        chunk.timestamp = framesToNs(pushedFrames);
+        for (auto capture : captures) {
+            auto pushStartedAt = std::chrono::steady_clock::now();
+            capture->pushAudio(&chunk);
+            result.pushNs += elapsedNs(pushStartedAt);
+        }
+        pushedFrames += chunkFrames;
+
+        while (pushedFrames >= result.frames + AUDIO_OUTPUT_FRAMES * 3) {
+            // libobs clears mixes before calling back
+            memset(output.data(), 0, output.size() * sizeof(float));
+
+            auto tickStartedAt = std::chrono::steady_clock::now();
+            ObsStub::renderAudio(audio, framesToNs(result.frames) + framesToNs(AUDIO_OUTPUT_FRAMES * 2), mixers, mixes);
+            auto tickNs = elapsedNs(tickStartedAt);
+
+            result.popNs += tickNs;
+            result.maxTickNs = tickNs > result.maxTickNs ? tickNs : result.maxTickNs;
+            result.frames += AUDIO_OUTPUT_FRAMES;
+        }
+    }
+
+    for (auto capture : captures) {
+        result.underruns += capture->getUnderruns();
+        delete capture;
+    }
+    return result;
+}
+
+void runAudioBenchmark()
+{
+    static const speaker_layout layouts[] = {SPEAKERS_MONO, SPEAKERS_STEREO, SPEAKERS_5POINT1, SPEAKERS_7POINT1};
+    static const size_t chunkSizes[] = {128, 480, 1024, 2048};
+
+    printf("Audio benchmark (Mix kernel: %s)\n", mixAndClampKernelName());
+
+    for (auto drift : {false, true}) {
+        for (auto speakers : layouts) {
+            for (auto chunkFrames : chunkSizes) {
+                for (size_t captureCount = 1; captureCount <= MAX_AUDIO_MIXES; captureCount++) {
+                    auto result = runCase(speakers, chunkFrames, captureCount, drift);
+                    if (!result.frames) {
+                        continue;
+                    }
+
+                    auto capturedFrames = (double)result.frames * captureCount;
+                    printf(
+                        "audio ch=%u chunk=%zu captures=%zu drift=%s push=%.2fns/frame pop=%.2fns/frame "
+                        "worst tick=%.1fus underruns=%llu\n",
+                        get_audio_channels(speakers), chunkFrames, captureCount, drift ? "on" : "off",
+                        (double)result.pushNs / capturedFrames, (double)result.popNs / capturedFrames,
+                        (double)result.maxTickNs / 1000.0, (unsigned long long)result.underruns
+                    );
+                }
+            }
+        }
+    }
+}
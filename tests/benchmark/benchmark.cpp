@@ -0,0 +1,56 @@
+/*
+Branch Output Plugin
+Copyright (C) 2024 OPENSPHERE Inc. info@opensphere.co.jp
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#include <obs-module.h>
+
+#include <stdio.h>
+#include <string.h>
+
+#include "benchmark.hpp"
+#include "obs-stub.hpp"
+
+// Usage: branch-output-benchmark [audio|soak] [-v]
+int main(int argc, char *argv[])
+{
+    auto audio = true;
+    auto soak = true;
+
+    // Reconnect failures are expected in soak
+    ObsStub::setLogLevel(LOG_ERROR);
+
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "audio")) {
+            soak = false;
+        } else if (!strcmp(argv[i], "soak")) {
+            audio = false;
+        } else if (!strcmp(argv[i], "-v")) {
+            ObsStub::setLogLevel(LOG_DEBUG);
+        } else {
+            fprintf(stderr, "Usage: %s [audio|soak] [-v]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    if (audio) {
+        runAudioBenchmark();
+    }
+    if (soak) {
+        runSupervisionSoak();
+    }
+    return 0;
+}
@@ -0,0 +1,35 @@
+/*
+Branch Output Plugin
+Copyright (C) 2024 OPENSPHERE Inc. info@opensphere.co.jp
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#pragma once
+
+#define AUDIO_BENCHMARK_SECONDS 10 // Length of audio pushed through per case
+#define AUDIO_BENCHMARK_SAMPLE_RATE 48000
+
+#define SOAK_SECONDS 1800    // Simulated duration per case
+#define SOAK_TICK_MS 100     // Supervision is driven by signals, so it runs far more often than the 5s polling
+#define SOAK_RESTART_PER_MILLE 2 // Filters stopped and started again per tick (Settings changes, interlock)
+
+// AudioCapture push/pop through AudioEngine's mixer callback (Same path as libobs audio thread takes).
+// Every combination of channel count, chunk size, captures per mixer pool and drift compensation is reported
+// as ns/frame and worst tick latency.
+void runAudioBenchmark();
+
+// N filters x M services through StreamingSupervisor and ReconnectCoordinator on simulated outputs.
+// Each case is reported as supervision cost per filter tick and the numbers of reconnects.
+void runSupervisionSoak();
@@ -0,0 +1,182 @@
+/*
+Branch Output Plugin
+Copyright (C) 2024 OPENSPHERE Inc. info@opensphere.co.jp
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#include <obs-module.h>
+
+#include <QString>
+
+#include <algorithm>
+#include <chrono>
+#include <stdio.h>
+#include <vector>
+
+#include "streaming-supervisor.hpp"
+#include "reconnect-coordinator.hpp"
+#include "benchmark.hpp"
+#include "obs-stub.hpp"
+
+struct SoakFilter {
+    QString name;
+    std::vector<SupervisedStreaming> streamings;
+};
+
+struct SoakResult {
+    uint64_t superviseNs;
+    uint64_t maxSuperviseNs;
+    uint64_t supervisions;
+    uint64_t startStopNs;
+    uint64_t restarts;
+    uint64_t reconnects;
+    uint64_t reconnectWaits;
+};
+
+static inline uint64_t elapsedNs(std::chrono::steady_clock::time_point since)
+{
+    auto elapsed = std::chrono::steady_clock::now() - since;
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+}
+
+// Same as BranchOutputFilter::startStreamingOutputs() (Encoders are attached in real filter)
+static void startFilter(SoakFilter &filter, size_t serviceCount)
+{
+    filter.streamings.resize(serviceCount);
+    for (size_t i = 0; i < serviceCount; i++) {
+        auto &streaming = filter.streamings[i];
+        streaming.output = obs_output_create("rtmp_output", qUtf8Printable(filter.name), nullptr, nullptr);
+        // Services of the same index go to the same ingest host across filters (Backoff is shared)
+        streaming.ingestHost =
+            ReconnectCoordinator::getIngestHost(QString("rtmp://ingest-%1.example.com/live").arg(i));
+
+        StreamingSupervisor::beginConnectAttempt(streaming);
+        streaming.active = obs_output_start(streaming.output);
+    }
+}
+
+// Same as BranchOutputFilter::stopStreamingOutput() for every streaming
+static void stopFilter(SoakFilter &filter)
+{
+    for (auto &streaming : filter.streamings) {
+        StreamingSupervisor::release(streaming);
+        if (streaming.output && streaming.active) {
+            obs_output_stop(streaming.output);
+        }
+    }
+    filter.streamings.clear();
+}
+
+// Streaming part of BranchOutputFilter::onIntervalTimerTimeout() (Interlock and source checks always pass)
+static void superviseFilter(SoakFilter &filter, SoakResult &result)
+{
+    if (StreamingSupervisor::countActive(filter.streamings) == 0) {
+        return;
+    }
+    if (!StreamingSupervisor::settle(filter.streamings)) {
+        return;
+    }
+
+    StreamingSupervisor::reconnectGaveUp(
+        filter.name, filter.streamings,
+        [&](size_t i) {
+            StreamingSupervisor::reconnect(filter.streamings[i]);
+            result.reconnects++;
+        },
+        [&](uint64_t) { result.reconnectWaits++; }
+    );
+}
+
+static SoakResult runCase(size_t filterCount, size_t serviceCount)
+{
+    SoakResult result = {0};
+
+    // Defaults of BranchOutputFilter (7 retries with 1 sec delay) against flaky ingest
+    ObsStubOutputFaults faults = {0};
+    faults.startFailPercent = 2;
+    faults.connectFailPercent = 10;
+    faults.dropPerMille = 1;
+    faults.recoverPercent = 50;
+    faults.connectNs = 500000000ULL;
+    faults.retryNs = 7000000000ULL;
+    ObsStub::setOutputFaults(faults, (uint32_t)(filterCount * 100 + serviceCount));
+
+    std::vector<SoakFilter> filters(filterCount);
+    for (size_t i = 0; i < filterCount; i++) {
+        filters[i].name = QString("Filter %1").arg(i);
+        startFilter(filters[i], serviceCount);
+    }
+
+    uint32_t restartRandom = 1;
+    auto ticks = (uint64_t)SOAK_SECONDS * 1000 / SOAK_TICK_MS;
+    for (uint64_t tick = 0; tick < ticks; tick++) {
+        ObsStub::advanceTime((uint64_t)SOAK_TICK_MS * 1000000ULL);
+        ObsStub::tickOutputs();
+
+        for (auto &filter : filters) {
+            // Park-Miller (Independent of output faults)
+            restartRandom = (uint32_t)((uint64_t)restartRandom * 48271 % 2147483647);
+            if (restartRandom % 1000 < SOAK_RESTART_PER_MILLE) {
+                auto startedAt = std::chrono::steady_clock::now();
+                stopFilter(filter);
+                startFilter(filter, serviceCount);
+                result.startStopNs += elapsedNs(startedAt);
+                result.restarts++;
+            }
+
+            auto startedAt = std::chrono::steady_clock::now();
+            superviseFilter(filter, result);
+            auto superviseNs = elapsedNs(startedAt);
+
+            result.superviseNs += superviseNs;
+            result.maxSuperviseNs = std::max(result.maxSuperviseNs, superviseNs);
+            result.supervisions++;
+        }
+    }
+
+    for (auto &filter : filters) {
+        stopFilter(filter);
+    }
+    // Forget backoff of this case
+    ReconnectCoordinator::destroyInstance();
+    return result;
+}
+
+void runSupervisionSoak()
+{
+    static const size_t filterCounts[] = {1, 8, 32, 128};
+    static const size_t serviceCounts[] = {1, 3, 6};
+
+    printf("Supervision soak (%d secs simulated per case, tick=%dms)\n", SOAK_SECONDS, SOAK_TICK_MS);
+
+    for (auto filterCount : filterCounts) {
+        for (auto serviceCount : serviceCounts) {
+            auto result = runCase(filterCount, serviceCount);
+            printf(
+                "soak filters=%zu services=%zu supervise=%.0fns/filter worst=%.1fus start/stop=%.1fus "
+                "restarts=%llu reconnects=%llu waits=%llu\n",
+                filterCount, serviceCount, (double)result.superviseNs / result.supervisions,
+                (double)result.maxSuperviseNs / 1000.0,
+                result.restarts ? (double)result.startStopNs / result.restarts / 1000.0 : 0.0,
+                (unsigned long long)result.restarts, (unsigned long long)result.reconnects,
+                (unsigned long long)result.reconnectWaits
+            );
+        }
+    }
+
+    if (ObsStub::countOutputs()) {
+        fprintf(stderr, "Supervision soak: %zu outputs leaked\n", ObsStub::countOutputs());
+    }
+}
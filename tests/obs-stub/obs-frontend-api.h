@@ -0,0 +1,52 @@
+/*
+Branch Output Plugin
+Copyright (C) 2024 OPENSPHERE Inc. info@opensphere.co.jp
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#pragma once
+
+// Frontend API of the libobs stub: Scene list is set by ObsStub::setFrontendScenes() (Which emits the event too)
+
+#include <obs-module.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct obs_frontend_source_list {
+    struct {
+        obs_source_t **array;
+        size_t num;
+    } sources;
+};
+
+enum obs_frontend_event {
+    OBS_FRONTEND_EVENT_SCENE_CHANGED,
+    OBS_FRONTEND_EVENT_SCENE_LIST_CHANGED,
+};
+
+typedef void (*obs_frontend_event_cb)(enum obs_frontend_event event, void *private_data);
+
+void obs_frontend_add_event_callback(obs_frontend_event_cb callback, void *private_data);
+void obs_frontend_remove_event_callback(obs_frontend_event_cb callback, void *private_data);
+
+// Sources are referenced, release with obs_frontend_source_list_free()
+void obs_frontend_get_scenes(struct obs_frontend_source_list *sources);
+void obs_frontend_source_list_free(struct obs_frontend_source_list *source_list);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,344 @@
+/*
+Branch Output Plugin
+Copyright (C) 2024 OPENSPHERE Inc. info@opensphere.co.jp
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#pragma once
+
+// Thin replacement of libobs for standalone targets (Benchmark and unit tests).
+// Only what the plugin sources linked into them use is declared, and behaviour is simulated (See obs-stub.hpp).
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <string.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define LOG_ERROR 100
+#define LOG_WARNING 200
+#define LOG_INFO 300
+#define LOG_DEBUG 400
+
+#define MAKE_SEMANTIC_VERSION(major, minor, patch) ((major << 24) | (minor << 16) | patch)
+#define LIBOBS_API_VER MAKE_SEMANTIC_VERSION(30, 2, 0)
+
+#define MAX_AV_PLANES 8
+#define MAX_AUDIO_MIXES 6
+#define MAX_AUDIO_CHANNELS 8
+#define AUDIO_OUTPUT_FRAMES 1024
+
+void blogva(int log_level, const char *format, va_list args);
+void blog(int log_level, const char *format, ...);
+
+void *bzalloc(size_t size);
+void bfree(void *ptr);
+
+//--- Settings data (Missing item reads as empty / zero) ---//
+
+typedef struct obs_data obs_data_t;
+
+obs_data_t *obs_data_create(void);
+void obs_data_addref(obs_data_t *data);
+void obs_data_release(obs_data_t *data);
+void obs_data_set_string(obs_data_t *data, const char *name, const char *val);
+void obs_data_set_int(obs_data_t *data, const char *name, long long val);
+void obs_data_set_bool(obs_data_t *data, const char *name, bool val);
+const char *obs_data_get_string(obs_data_t *data, const char *name);
+long long obs_data_get_int(obs_data_t *data, const char *name);
+bool obs_data_get_bool(obs_data_t *data, const char *name);
+// Integers are the only numbers kept, and objects aren't kept at all
+double obs_data_get_double(obs_data_t *data, const char *name);
+obs_data_t *obs_data_get_obj(obs_data_t *data, const char *name);
+const char *obs_data_get_json(obs_data_t *data);
+
+enum obs_data_type {
+    OBS_DATA_NULL,
+    OBS_DATA_STRING,
+    OBS_DATA_NUMBER,
+    OBS_DATA_BOOLEAN,
+    OBS_DATA_OBJECT,
+    OBS_DATA_ARRAY,
+};
+
+enum obs_data_number_type {
+    OBS_DATA_NUM_INVALID,
+    OBS_DATA_NUM_INT,
+    OBS_DATA_NUM_DOUBLE,
+};
+
+typedef struct obs_data_item obs_data_item_t;
+
+// Item is released by obs_data_item_next() at the end
+obs_data_item_t *obs_data_first(obs_data_t *data);
+bool obs_data_item_next(obs_data_item_t **item);
+const char *obs_data_item_get_name(obs_data_item_t *item);
+enum obs_data_type obs_data_item_gettype(obs_data_item_t *item);
+enum obs_data_number_type obs_data_item_numtype(obs_data_item_t *item);
+
+//--- Video ---//
+
+enum obs_scale_type {
+    OBS_SCALE_DISABLE,
+    OBS_SCALE_POINT,
+    OBS_SCALE_BICUBIC,
+    OBS_SCALE_BILINEAR,
+    OBS_SCALE_LANCZOS,
+    OBS_SCALE_AREA,
+};
+
+typedef struct video_output video_t;
+
+struct vec2 {
+    float x, y;
+};
+
+static inline void vec2_set(struct vec2 *dst, float x, float y)
+{
+    dst->x = x;
+    dst->y = y;
+}
+
+struct obs_video_info {
+    uint32_t fps_num;
+    uint32_t fps_den;
+    uint32_t base_width;
+    uint32_t base_height;
+    uint32_t output_width;
+    uint32_t output_height;
+    enum obs_scale_type scale_type;
+};
+
+//--- Audio ---//
+
+enum speaker_layout {
+    SPEAKERS_UNKNOWN,
+    SPEAKERS_MONO,
+    SPEAKERS_STEREO,
+    SPEAKERS_2POINT1,
+    SPEAKERS_4POINT0,
+    SPEAKERS_4POINT1,
+    SPEAKERS_5POINT1,
+    SPEAKERS_7POINT1 = 8,
+};
+
+enum audio_format {
+    AUDIO_FORMAT_UNKNOWN,
+    AUDIO_FORMAT_U8BIT,
+    AUDIO_FORMAT_16BIT,
+    AUDIO_FORMAT_32BIT,
+    AUDIO_FORMAT_FLOAT,
+    AUDIO_FORMAT_U8BIT_PLANAR,
+    AUDIO_FORMAT_16BIT_PLANAR,
+    AUDIO_FORMAT_32BIT_PLANAR,
+    AUDIO_FORMAT_FLOAT_PLANAR,
+};
+
+struct audio_data {
+    uint8_t *data[MAX_AV_PLANES];
+    uint32_t frames;
+    uint64_t timestamp;
+};
+
+struct obs_audio_data {
+    uint8_t *data[MAX_AV_PLANES];
+    uint32_t frames;
+    uint64_t timestamp;
+};
+
+struct audio_output_data {
+    float *data[MAX_AUDIO_CHANNELS];
+};
+
+typedef bool (*audio_input_callback_t)(
+    void *param, uint64_t start_ts, uint64_t end_ts, uint64_t *new_ts, uint32_t active_mixers,
+    struct audio_output_data *mixes
+);
+
+struct audio_output_info {
+    const char *name;
+    uint32_t samples_per_sec;
+    enum audio_format format;
+    enum speaker_layout speakers;
+    audio_input_callback_t input_callback;
+    void *input_param;
+};
+
+#define AUDIO_OUTPUT_SUCCESS 0
+#define AUDIO_OUTPUT_FAIL -1
+
+typedef struct audio_output audio_t;
+
+// No thread is run, the callback is driven by ObsStub::renderAudio()
+int audio_output_open(audio_t **audio, struct audio_output_info *info);
+void audio_output_close(audio_t *audio);
+
+static inline uint32_t get_audio_channels(enum speaker_layout speakers)
+{
+    switch (speakers) {
+    case SPEAKERS_MONO:
+        return 1;
+    case SPEAKERS_STEREO:
+        return 2;
+    case SPEAKERS_2POINT1:
+        return 3;
+    case SPEAKERS_4POINT0:
+        return 4;
+    case SPEAKERS_4POINT1:
+        return 5;
+    case SPEAKERS_5POINT1:
+        return 6;
+    case SPEAKERS_7POINT1:
+        return 8;
+    default:
+        return 0;
+    }
+}
+
+//--- Signals ---//
+
+typedef struct calldata calldata_t;
+typedef struct signal_handler signal_handler_t;
+typedef void (*signal_callback_t)(void *data, calldata_t *cd);
+
+void signal_handler_connect(signal_handler_t *handler, const char *signal, signal_callback_t callback, void *data);
+void signal_handler_disconnect(signal_handler_t *handler, const char *signal, signal_callback_t callback, void *data);
+signal_handler_t *obs_get_signal_handler(void);
+
+//--- Sources and scenes (Scene graph is built by ObsStub, sources never produce audio) ---//
+
+typedef struct obs_source obs_source_t;
+typedef struct obs_weak_source obs_weak_source_t;
+typedef struct obs_scene obs_scene_t;
+typedef struct obs_scene_item obs_sceneitem_t;
+
+// Source types can't be registered and nothing is drawn (Declared for plugin headers only)
+struct obs_source_info;
+typedef struct gs_effect gs_effect_t;
+
+typedef void (*obs_source_audio_capture_t)(
+    void *param, obs_source_t *source, const struct audio_data *audio_data, bool muted
+);
+
+const char *obs_source_get_name(const obs_source_t *source);
+obs_source_t *obs_source_get_ref(obs_source_t *source);
+void obs_source_release(obs_source_t *source);
+signal_handler_t *obs_source_get_signal_handler(const obs_source_t *source);
+obs_weak_source_t *obs_source_get_weak_source(obs_source_t *source);
+obs_source_t *obs_weak_source_get_source(obs_weak_source_t *weak);
+void obs_weak_source_release(obs_weak_source_t *weak);
+bool obs_weak_source_expired(obs_weak_source_t *weak);
+void obs_source_add_audio_capture_callback(obs_source_t *source, obs_source_audio_capture_t callback, void *param);
+void obs_source_remove_audio_capture_callback(obs_source_t *source, obs_source_audio_capture_t callback, void *param);
+
+// Public (Neither private nor removed) scenes / inputs
+void obs_enum_scenes(bool (*enum_proc)(void *, obs_source_t *), void *param);
+void obs_enum_sources(bool (*enum_proc)(void *, obs_source_t *), void *param);
+
+obs_scene_t *obs_scene_from_source(const obs_source_t *source);
+obs_scene_t *obs_group_from_source(const obs_source_t *source);
+void obs_scene_enum_items(
+    obs_scene_t *scene, bool (*callback)(obs_scene_t *, obs_sceneitem_t *, void *), void *param
+);
+obs_source_t *obs_sceneitem_get_source(const obs_sceneitem_t *item);
+bool obs_sceneitem_is_group(obs_sceneitem_t *item);
+
+// Name stands in for UUID (Give unique names)
+const char *obs_source_get_uuid(const obs_source_t *source);
+// Sources never render, so activation isn't tracked
+void obs_source_inc_active(obs_source_t *source);
+void obs_source_dec_active(obs_source_t *source);
+
+enum obs_bounds_type {
+    OBS_BOUNDS_NONE,
+    OBS_BOUNDS_STRETCH,
+    OBS_BOUNDS_SCALE_INNER,
+    OBS_BOUNDS_SCALE_OUTER,
+    OBS_BOUNDS_SCALE_TO_WIDTH,
+    OBS_BOUNDS_SCALE_TO_HEIGHT,
+    OBS_BOUNDS_MAX_ONLY,
+};
+
+#define OBS_ALIGN_CENTER (0)
+
+// Private scene is a private scene source of ObsStub (Bounds are ignored)
+obs_scene_t *obs_scene_create_private(const char *name);
+void obs_scene_release(obs_scene_t *scene);
+obs_source_t *obs_scene_get_source(const obs_scene_t *scene);
+obs_sceneitem_t *obs_scene_add(obs_scene_t *scene, obs_source_t *source);
+void obs_sceneitem_set_bounds_type(obs_sceneitem_t *item, enum obs_bounds_type type);
+void obs_sceneitem_set_bounds_alignment(obs_sceneitem_t *item, uint32_t alignment);
+void obs_sceneitem_set_bounds(obs_sceneitem_t *item, const struct vec2 *bounds);
+
+//--- Views (Source of channel is referenced, nothing is rendered) ---//
+
+typedef struct obs_view obs_view_t;
+
+obs_view_t *obs_view_create(void);
+void obs_view_destroy(obs_view_t *view);
+void obs_view_set_source(obs_view_t *view, uint32_t channel, obs_source_t *source);
+video_t *obs_view_add2(obs_view_t *view, struct obs_video_info *ovi);
+void obs_view_remove(obs_view_t *view);
+
+//--- Outputs (Shim with simulated connection and stats, see ObsStub::tickOutputs()) ---//
+
+typedef struct obs_output obs_output_t;
+
+obs_output_t *obs_output_create(const char *id, const char *name, obs_data_t *settings, obs_data_t *hotkey_data);
+obs_output_t *obs_output_get_ref(obs_output_t *output);
+void obs_output_release(obs_output_t *output);
+bool obs_output_start(obs_output_t *output);
+void obs_output_stop(obs_output_t *output);
+void obs_output_force_stop(obs_output_t *output);
+bool obs_output_active(const obs_output_t *output);
+bool obs_output_reconnecting(const obs_output_t *output);
+float obs_output_get_congestion(obs_output_t *output);
+int obs_output_get_frames_dropped(const obs_output_t *output);
+int obs_output_get_total_frames(const obs_output_t *output);
+
+//--- Encoders (Only settings are kept, they never run) ---//
+
+typedef struct obs_encoder obs_encoder_t;
+
+#define OBS_ENCODER_CAP_PASS_TEXTURE (1 << 1)
+
+// Every encoder id is known with empty defaults and no caps
+obs_data_t *obs_encoder_defaults(const char *id);
+uint32_t obs_get_encoder_caps(const char *encoder_id);
+
+obs_encoder_t *obs_video_encoder_create(
+    const char *id, const char *name, obs_data_t *settings, obs_data_t *hotkey_data
+);
+obs_encoder_t *obs_encoder_get_ref(obs_encoder_t *encoder);
+void obs_encoder_release(obs_encoder_t *encoder);
+const char *obs_encoder_get_name(const obs_encoder_t *encoder);
+const char *obs_encoder_get_id(const obs_encoder_t *encoder);
+bool obs_encoder_active(const obs_encoder_t *encoder);
+void obs_encoder_set_video(obs_encoder_t *encoder, video_t *video);
+void obs_encoder_set_scaled_size(obs_encoder_t *encoder, uint32_t width, uint32_t height);
+void obs_encoder_set_gpu_scale_type(obs_encoder_t *encoder, enum obs_scale_type gpu_scale_type);
+bool obs_encoder_set_frame_rate_divisor(obs_encoder_t *encoder, uint32_t divisor);
+// Referenced, release with obs_data_release()
+obs_data_t *obs_encoder_get_settings(const obs_encoder_t *encoder);
+// Items of settings are merged
+void obs_encoder_update(obs_encoder_t *encoder, obs_data_t *settings);
+
+#ifdef __cplusplus
+}
+#endif
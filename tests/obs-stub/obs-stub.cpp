@@ -0,0 +1,921 @@
+/*
+Branch Output Plugin
+Copyright (C) 2024 OPENSPHERE Inc. info@opensphere.co.jp
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#include <obs-module.h>
+#include <obs-frontend-api.h>
+#include <util/platform.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <random>
+#include <set>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <vector>
+
+#include "obs-stub.hpp"
+
+static std::atomic<int> logLevel(LOG_WARNING);
+static std::mutex logMutex;
+static std::atomic<uint64_t> timeOffsetNs(0);
+
+//--- Logging and memory ---//
+
+void blogva(int log_level, const char *format, va_list args)
+{
+    if (log_level > logLevel.load(std::memory_order_relaxed)) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> locker(logMutex);
+    vfprintf(stderr, format, args);
+    fputc('\n', stderr);
+}
+
+void blog(int log_level, const char *format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    blogva(log_level, format, args);
+    va_end(args);
+}
+
+void *bzalloc(size_t size)
+{
+    return calloc(1, size ? size : 1);
+}
+
+void bfree(void *ptr)
+{
+    free(ptr);
+}
+
+uint64_t os_gettime_ns(void)
+{
+    auto now = std::chrono::steady_clock::now().time_since_epoch();
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(now).count() +
+           timeOffsetNs.load(std::memory_order_relaxed);
+}
+
+//--- Settings data ---//
+
+struct obs_data {
+    long refs;
+    std::map<std::string, std::string> strings;
+    std::map<std::string, long long> ints;
+    std::map<std::string, bool> bools;
+};
+
+obs_data_t *obs_data_create(void)
+{
+    return new obs_data{1, {}, {}, {}};
+}
+
+void obs_data_addref(obs_data_t *data)
+{
+    if (data) {
+        data->refs++;
+    }
+}
+
+void obs_data_release(obs_data_t *data)
+{
+    if (data && --data->refs == 0) {
+        delete data;
+    }
+}
+
+void obs_data_set_string(obs_data_t *data, const char *name, const char *val)
+{
+    data->strings[name] = val ? val : "";
+}
+
+void obs_data_set_int(obs_data_t *data, const char *name, long long val)
+{
+    data->ints[name] = val;
+}
+
+void obs_data_set_bool(obs_data_t *data, const char *name, bool val)
+{
+    data->bools[name] = val;
+}
+
+const char *obs_data_get_string(obs_data_t *data, const char *name)
+{
+    auto it = data->strings.find(name);
+    return it != data->strings.end() ? it->second.c_str() : "";
+}
+
+long long obs_data_get_int(obs_data_t *data, const char *name)
+{
+    auto it = data->ints.find(name);
+    return it != data->ints.end() ? it->second : 0;
+}
+
+bool obs_data_get_bool(obs_data_t *data, const char *name)
+{
+    auto it = data->bools.find(name);
+    return it != data->bools.end() ? it->second : false;
+}
+
+double obs_data_get_double(obs_data_t *data, const char *name)
+{
+    return (double)obs_data_get_int(data, name);
+}
+
+obs_data_t *obs_data_get_obj(obs_data_t *, const char *)
+{
+    return nullptr;
+}
+
+const char *obs_data_get_json(obs_data_t *)
+{
+    return "{}";
+}
+
+struct obs_data_item {
+    std::vector<std::pair<std::string, obs_data_type>> items; // Snapshot of names taken by obs_data_first()
+    size_t index;
+};
+
+obs_data_item_t *obs_data_first(obs_data_t *data)
+{
+    auto item = new obs_data_item{{}, 0};
+    for (auto &entry : data->strings) {
+        item->items.push_back({entry.first, OBS_DATA_STRING});
+    }
+    for (auto &entry : data->ints) {
+        item->items.push_back({entry.first, OBS_DATA_NUMBER});
+    }
+    for (auto &entry : data->bools) {
+        item->items.push_back({entry.first, OBS_DATA_BOOLEAN});
+    }
+
+    if (item->items.empty()) {
+        delete item;
+        return nullptr;
+    }
+    return item;
+}
+
+bool obs_data_item_next(obs_data_item_t **item)
+{
+    if (!*item) {
+        return false;
+    }
+    if (++(*item)->index < (*item)->items.size()) {
+        return true;
+    }
+
+    delete *item;
+    *item = nullptr;
+    return false;
+}
+
+const char *obs_data_item_get_name(obs_data_item_t *item)
+{
+    return item->items[item->index].first.c_str();
+}
+
+enum obs_data_type obs_data_item_gettype(obs_data_item_t *item)
+{
+    return item->items[item->index].second;
+}
+
+enum obs_data_number_type obs_data_item_numtype(obs_data_item_t *item)
+{
+    return obs_data_item_gettype(item) == OBS_DATA_NUMBER ? OBS_DATA_NUM_INT : OBS_DATA_NUM_INVALID;
+}
+
+//--- Audio ---//
+
+struct audio_output {
+    audio_output_info info;
+};
+
+int audio_output_open(audio_t **audio, struct audio_output_info *info)
+{
+    if (!info->input_callback || !get_audio_channels(info->speakers)) {
+        return AUDIO_OUTPUT_FAIL;
+    }
+
+    *audio = new audio_output{*info};
+    return AUDIO_OUTPUT_SUCCESS;
+}
+
+void audio_output_close(audio_t *audio)
+{
+    delete audio;
+}
+
+//--- Signals ---//
+
+struct calldata {
+    obs_source_t *source;
+};
+
+struct SignalConnection {
+    std::string signal;
+    signal_callback_t callback;
+    void *data;
+};
+
+struct signal_handler {
+    std::vector<SignalConnection> connections;
+};
+
+static signal_handler_t globalSignalHandler;
+
+void signal_handler_connect(signal_handler_t *handler, const char *signal, signal_callback_t callback, void *data)
+{
+    handler->connections.push_back({signal, callback, data});
+}
+
+void signal_handler_disconnect(signal_handler_t *handler, const char *signal, signal_callback_t callback, void *data)
+{
+    auto &connections = handler->connections;
+    for (auto it = connections.begin(); it != connections.end(); it++) {
+        if (it->signal == signal && it->callback == callback && it->data == data) {
+            connections.erase(it);
+            return;
+        }
+    }
+}
+
+signal_handler_t *obs_get_signal_handler(void)
+{
+    return &globalSignalHandler;
+}
+
+static void emitSignal(signal_handler_t *handler, const char *signal, obs_source_t *source)
+{
+    calldata cd = {source};
+
+    // Callbacks may connect or disconnect
+    auto connections = handler->connections;
+    for (auto &connection : connections) {
+        if (connection.signal == signal) {
+            connection.callback(connection.data, &cd);
+        }
+    }
+}
+
+//--- Sources and scenes ---//
+
+struct obs_weak_source {
+    obs_source_t *source; // nullptr after destroyed
+    long refs;
+};
+
+struct obs_scene {
+    obs_source_t *source;
+    std::vector<obs_sceneitem_t *> items;
+};
+
+struct obs_scene_item {
+    obs_source_t *source; // Referenced
+    obs_scene_t *parent;
+};
+
+struct obs_source {
+    std::string name;
+    ObsStubSourceType type;
+    bool isPrivate;
+    bool removed;
+    long refs;
+    obs_weak_source_t *weak;
+    signal_handler_t signalHandler;
+    obs_scene_t scene; // Items of scenes and groups
+};
+
+static std::vector<obs_source_t *> sources; // Creation order
+static std::vector<obs_source_t *> frontendScenes;
+
+static void releaseWeak(obs_weak_source_t *weak)
+{
+    if (weak && --weak->refs == 0) {
+        delete weak;
+    }
+}
+
+const char *obs_source_get_name(const obs_source_t *source)
+{
+    return source ? source->name.c_str() : nullptr;
+}
+
+obs_source_t *obs_source_get_ref(obs_source_t *source)
+{
+    if (source) {
+        source->refs++;
+    }
+    return source;
+}
+
+void obs_source_release(obs_source_t *source)
+{
+    if (!source || --source->refs > 0) {
+        return;
+    }
+
+    emitSignal(&globalSignalHandler, "source_destroy", source);
+
+    for (auto item : source->scene.items) {
+        obs_source_release(item->source);
+        delete item;
+    }
+    sources.erase(std::find(sources.begin(), sources.end(), source));
+
+    source->weak->source = nullptr;
+    releaseWeak(source->weak);
+    delete source;
+}
+
+signal_handler_t *obs_source_get_signal_handler(const obs_source_t *source)
+{
+    return source ? (signal_handler_t *)&source->signalHandler : nullptr;
+}
+
+obs_weak_source_t *obs_source_get_weak_source(obs_source_t *source)
+{
+    if (!source) {
+        return nullptr;
+    }
+    source->weak->refs++;
+    return source->weak;
+}
+
+obs_source_t *obs_weak_source_get_source(obs_weak_source_t *weak)
+{
+    return weak ? obs_source_get_ref(weak->source) : nullptr;
+}
+
+void obs_weak_source_release(obs_weak_source_t *weak)
+{
+    releaseWeak(weak);
+}
+
+bool obs_weak_source_expired(obs_weak_source_t *weak)
+{
+    return !weak || !weak->source;
+}
+
+void obs_source_add_audio_capture_callback(obs_source_t *, obs_source_audio_capture_t, void *) {}
+
+void obs_source_remove_audio_capture_callback(obs_source_t *, obs_source_audio_capture_t, void *) {}
+
+static void enumPublicSources(bool scenes, bool (*enum_proc)(void *, obs_source_t *), void *param)
+{
+    auto list = sources;
+    for (auto source : list) {
+        if (source->isPrivate || source->removed || (source->type != OBS_STUB_SOURCE_INPUT) != scenes) {
+            continue;
+        }
+        if (!enum_proc(param, source)) {
+            return;
+        }
+    }
+}
+
+void obs_enum_scenes(bool (*enum_proc)(void *, obs_source_t *), void *param)
+{
+    enumPublicSources(true, enum_proc, param);
+}
+
+void obs_enum_sources(bool (*enum_proc)(void *, obs_source_t *), void *param)
+{
+    enumPublicSources(false, enum_proc, param);
+}
+
+obs_scene_t *obs_scene_from_source(const obs_source_t *source)
+{
+    return source && source->type == OBS_STUB_SOURCE_SCENE ? (obs_scene_t *)&source->scene : nullptr;
+}
+
+obs_scene_t *obs_group_from_source(const obs_source_t *source)
+{
+    return source && source->type == OBS_STUB_SOURCE_GROUP ? (obs_scene_t *)&source->scene : nullptr;
+}
+
+void obs_scene_enum_items(obs_scene_t *scene, bool (*callback)(obs_scene_t *, obs_sceneitem_t *, void *), void *param)
+{
+    if (!scene) {
+        return;
+    }
+
+    auto items = scene->items;
+    for (auto item : items) {
+        if (!callback(scene, item, param)) {
+            return;
+        }
+    }
+}
+
+obs_source_t *obs_sceneitem_get_source(const obs_sceneitem_t *item)
+{
+    return item ? item->source : nullptr;
+}
+
+bool obs_sceneitem_is_group(obs_sceneitem_t *item)
+{
+    return item && item->source->type == OBS_STUB_SOURCE_GROUP;
+}
+
+const char *obs_source_get_uuid(const obs_source_t *source)
+{
+    return obs_source_get_name(source);
+}
+
+void obs_source_inc_active(obs_source_t *) {}
+
+void obs_source_dec_active(obs_source_t *) {}
+
+obs_scene_t *obs_scene_create_private(const char *name)
+{
+    return obs_scene_from_source(ObsStub::createSource(name, OBS_STUB_SOURCE_SCENE, true));
+}
+
+void obs_scene_release(obs_scene_t *scene)
+{
+    if (scene) {
+        obs_source_release(scene->source);
+    }
+}
+
+obs_source_t *obs_scene_get_source(const obs_scene_t *scene)
+{
+    return scene ? scene->source : nullptr;
+}
+
+obs_sceneitem_t *obs_scene_add(obs_scene_t *scene, obs_source_t *source)
+{
+    ObsStub::addSceneItem(scene->source, source);
+    return scene->items.back();
+}
+
+void obs_sceneitem_set_bounds_type(obs_sceneitem_t *, enum obs_bounds_type) {}
+
+void obs_sceneitem_set_bounds_alignment(obs_sceneitem_t *, uint32_t) {}
+
+void obs_sceneitem_set_bounds(obs_sceneitem_t *, const struct vec2 *) {}
+
+//--- Views ---//
+
+struct video_output {
+    obs_video_info info;
+};
+
+struct obs_view {
+    obs_source_t *source; // Referenced
+    video_t *video;
+};
+
+obs_view_t *obs_view_create(void)
+{
+    return new obs_view{nullptr, nullptr};
+}
+
+void obs_view_destroy(obs_view_t *view)
+{
+    if (view) {
+        obs_view_remove(view);
+        obs_source_release(view->source);
+        delete view;
+    }
+}
+
+void obs_view_set_source(obs_view_t *view, uint32_t, obs_source_t *source)
+{
+    obs_source_get_ref(source);
+    obs_source_release(view->source);
+    view->source = source;
+}
+
+video_t *obs_view_add2(obs_view_t *view, struct obs_video_info *ovi)
+{
+    if (!view->video) {
+        view->video = new video_output{*ovi};
+    }
+    return view->video;
+}
+
+void obs_view_remove(obs_view_t *view)
+{
+    delete view->video;
+    view->video = nullptr;
+}
+
+//--- Frontend ---//
+
+struct FrontendEventCallback {
+    obs_frontend_event_cb callback;
+    void *data;
+};
+
+static std::vector<FrontendEventCallback> frontendEventCallbacks;
+
+void obs_frontend_add_event_callback(obs_frontend_event_cb callback, void *private_data)
+{
+    frontendEventCallbacks.push_back({callback, private_data});
+}
+
+void obs_frontend_remove_event_callback(obs_frontend_event_cb callback, void *private_data)
+{
+    for (auto it = frontendEventCallbacks.begin(); it != frontendEventCallbacks.end(); it++) {
+        if (it->callback == callback && it->data == private_data) {
+            frontendEventCallbacks.erase(it);
+            return;
+        }
+    }
+}
+
+static void emitFrontendEvent(enum obs_frontend_event event)
+{
+    auto callbacks = frontendEventCallbacks;
+    for (auto &callback : callbacks) {
+        callback.callback(event, callback.data);
+    }
+}
+
+void obs_frontend_get_scenes(struct obs_frontend_source_list *sources)
+{
+    sources->sources.num = frontendScenes.size();
+    sources->sources.array = (obs_source_t **)bzalloc(frontendScenes.size() * sizeof(obs_source_t *));
+    for (size_t i = 0; i < frontendScenes.size(); i++) {
+        sources->sources.array[i] = obs_source_get_ref(frontendScenes[i]);
+    }
+}
+
+void obs_frontend_source_list_free(struct obs_frontend_source_list *source_list)
+{
+    for (size_t i = 0; i < source_list->sources.num; i++) {
+        obs_source_release(source_list->sources.array[i]);
+    }
+    bfree(source_list->sources.array);
+    source_list->sources.array = nullptr;
+    source_list->sources.num = 0;
+}
+
+//--- Outputs ---//
+
+enum OutputState {
+    OUTPUT_STATE_STOPPED,
+    OUTPUT_STATE_CONNECTING,
+    OUTPUT_STATE_ACTIVE,
+    OUTPUT_STATE_RECONNECTING,
+};
+
+struct obs_output {
+    long refs;
+    OutputState state;
+    uint64_t stateChangedAt;
+    float congestion;
+    int framesDropped;
+    int totalFrames;
+};
+
+static std::set<obs_output_t *> outputs;
+static ObsStubOutputFaults outputFaults = {0, 0, 0, 100, 0, 0};
+static std::mt19937 faultRandom;
+
+static bool rollPercent(int percent)
+{
+    return std::uniform_int_distribution<int>(0, 99)(faultRandom) < percent;
+}
+
+static void setOutputState(obs_output_t *output, OutputState state)
+{
+    output->state = state;
+    output->stateChangedAt = os_gettime_ns();
+}
+
+obs_output_t *obs_output_create(const char *, const char *, obs_data_t *, obs_data_t *)
+{
+    auto output = new obs_output{1, OUTPUT_STATE_STOPPED, 0, 0.0f, 0, 0};
+    outputs.insert(output);
+    return output;
+}
+
+obs_output_t *obs_output_get_ref(obs_output_t *output)
+{
+    if (output) {
+        output->refs++;
+    }
+    return output;
+}
+
+void obs_output_release(obs_output_t *output)
+{
+    if (output && --output->refs == 0) {
+        outputs.erase(output);
+        delete output;
+    }
+}
+
+bool obs_output_start(obs_output_t *output)
+{
+    if (output->state != OUTPUT_STATE_STOPPED) {
+        return false;
+    }
+    if (rollPercent(outputFaults.startFailPercent)) {
+        return false;
+    }
+
+    setOutputState(output, OUTPUT_STATE_CONNECTING);
+    return true;
+}
+
+void obs_output_stop(obs_output_t *output)
+{
+    setOutputState(output, OUTPUT_STATE_STOPPED);
+}
+
+void obs_output_force_stop(obs_output_t *output)
+{
+    setOutputState(output, OUTPUT_STATE_STOPPED);
+}
+
+bool obs_output_active(const obs_output_t *output)
+{
+    // libobs keeps output active while it's reconnecting by itself
+    return output->state == OUTPUT_STATE_ACTIVE || output->state == OUTPUT_STATE_RECONNECTING;
+}
+
+bool obs_output_reconnecting(const obs_output_t *output)
+{
+    return output->state == OUTPUT_STATE_RECONNECTING;
+}
+
+float obs_output_get_congestion(obs_output_t *output)
+{
+    return output->congestion;
+}
+
+int obs_output_get_frames_dropped(const obs_output_t *output)
+{
+    return output->framesDropped;
+}
+
+int obs_output_get_total_frames(const obs_output_t *output)
+{
+    return output->totalFrames;
+}
+
+//--- Encoders ---//
+
+struct obs_encoder {
+    long refs;
+    std::string id;
+    std::string name;
+    obs_data_t *settings;
+    int updates;
+};
+
+obs_data_t *obs_encoder_defaults(const char *)
+{
+    return obs_data_create();
+}
+
+uint32_t obs_get_encoder_caps(const char *)
+{
+    return 0;
+}
+
+obs_encoder_t *obs_video_encoder_create(const char *id, const char *name, obs_data_t *settings, obs_data_t *)
+{
+    auto encoder = new obs_encoder{1, id, name, obs_data_create(), 0};
+    if (settings) {
+        obs_encoder_update(encoder, settings);
+    }
+    return encoder;
+}
+
+obs_encoder_t *obs_encoder_get_ref(obs_encoder_t *encoder)
+{
+    if (encoder) {
+        encoder->refs++;
+    }
+    return encoder;
+}
+
+void obs_encoder_release(obs_encoder_t *encoder)
+{
+    if (encoder && --encoder->refs == 0) {
+        obs_data_release(encoder->settings);
+        delete encoder;
+    }
+}
+
+const char *obs_encoder_get_name(const obs_encoder_t *encoder)
+{
+    return encoder ? encoder->name.c_str() : nullptr;
+}
+
+const char *obs_encoder_get_id(const obs_encoder_t *encoder)
+{
+    return encoder ? encoder->id.c_str() : nullptr;
+}
+
+bool obs_encoder_active(const obs_encoder_t *)
+{
+    return false;
+}
+
+void obs_encoder_set_video(obs_encoder_t *, video_t *) {}
+
+void obs_encoder_set_scaled_size(obs_encoder_t *, uint32_t, uint32_t) {}
+
+void obs_encoder_set_gpu_scale_type(obs_encoder_t *, enum obs_scale_type) {}
+
+bool obs_encoder_set_frame_rate_divisor(obs_encoder_t *, uint32_t)
+{
+    return true;
+}
+
+obs_data_t *obs_encoder_get_settings(const obs_encoder_t *encoder)
+{
+    obs_data_addref(encoder->settings);
+    return encoder->settings;
+}
+
+void obs_encoder_update(obs_encoder_t *encoder, obs_data_t *settings)
+{
+    for (auto &item : settings->strings) {
+        encoder->settings->strings[item.first] = item.second;
+    }
+    for (auto &item : settings->ints) {
+        encoder->settings->ints[item.first] = item.second;
+    }
+    for (auto &item : settings->bools) {
+        encoder->settings->bools[item.first] = item.second;
+    }
+    encoder->updates++;
+}
+
+//--- ObsStub class ---//
+
+void ObsStub::setLogLevel(int level)
+{
+    logLevel = level;
+}
+
+void ObsStub::advanceTime(uint64_t ns)
+{
+    timeOffsetNs.fetch_add(ns, std::memory_order_relaxed);
+}
+
+bool ObsStub::renderAudio(audio_t *audio, uint64_t startTs, uint32_t mixers, audio_output_data *mixes)
+{
+    auto endTs = startTs + (uint64_t)AUDIO_OUTPUT_FRAMES * 1000000000ULL / audio->info.samples_per_sec;
+    uint64_t outTs = 0;
+    return audio->info.input_callback(audio->info.input_param, startTs, endTs, &outTs, mixers, mixes);
+}
+
+void ObsStub::setOutputFaults(const ObsStubOutputFaults &faults, uint32_t seed)
+{
+    outputFaults = faults;
+    faultRandom.seed(seed);
+}
+
+void ObsStub::tickOutputs()
+{
+    auto now = os_gettime_ns();
+
+    for (auto output : outputs) {
+        auto elapsed = now - output->stateChangedAt;
+
+        switch (output->state) {
+        case OUTPUT_STATE_CONNECTING:
+            if (elapsed >= outputFaults.connectNs) {
+                setOutputState(
+                    output, rollPercent(outputFaults.connectFailPercent) ? OUTPUT_STATE_STOPPED : OUTPUT_STATE_ACTIVE
+                );
+            }
+            break;
+        case OUTPUT_STATE_ACTIVE:
+            if (std::uniform_int_distribution<int>(0, 999)(faultRandom) < outputFaults.dropPerMille) {
+                setOutputState(output, OUTPUT_STATE_RECONNECTING);
+            }
+            break;
+        case OUTPUT_STATE_RECONNECTING:
+            if (elapsed >= outputFaults.retryNs) {
+                // Gave up means stopped (obs_output_active() is false)
+                setOutputState(
+                    output, rollPercent(outputFaults.recoverPercent) ? OUTPUT_STATE_ACTIVE : OUTPUT_STATE_STOPPED
+                );
+            }
+            break;
+        default:
+            break;
+        }
+    }
+}
+
+size_t ObsStub::countOutputs()
+{
+    return outputs.size();
+}
+
+void ObsStub::setOutputStats(obs_output_t *output, float congestion, int framesDropped, int totalFrames)
+{
+    output->congestion = congestion;
+    output->framesDropped = framesDropped;
+    output->totalFrames = totalFrames;
+}
+
+int ObsStub::countEncoderUpdates(obs_encoder_t *encoder)
+{
+    return encoder->updates;
+}
+
+obs_source_t *ObsStub::createSource(const char *name, ObsStubSourceType type, bool isPrivate)
+{
+    auto source = new obs_source{name, type, isPrivate, false, 1, new obs_weak_source{nullptr, 1}, {}, {}};
+    source->weak->source = source;
+    source->scene.source = source;
+    sources.push_back(source);
+
+    if (!isPrivate) {
+        emitSignal(&globalSignalHandler, "source_create", source);
+    }
+    return source;
+}
+
+void ObsStub::removeSource(obs_source_t *source)
+{
+    if (source->removed) {
+        return;
+    }
+    source->removed = true;
+
+    auto it = std::find(frontendScenes.begin(), frontendScenes.end(), source);
+    if (it != frontendScenes.end()) {
+        frontendScenes.erase(it);
+        obs_source_release(source);
+        emitFrontendEvent(OBS_FRONTEND_EVENT_SCENE_LIST_CHANGED);
+    }
+    emitSignal(&globalSignalHandler, "source_remove", source);
+}
+
+void ObsStub::addSceneItem(obs_source_t *scene, obs_source_t *source)
+{
+    auto item = new obs_scene_item{obs_source_get_ref(source), &scene->scene};
+    scene->scene.items.push_back(item);
+    emitSignal(&scene->signalHandler, "item_add", scene);
+}
+
+void ObsStub::removeSceneItem(obs_source_t *scene, obs_source_t *source)
+{
+    auto &items = scene->scene.items;
+    for (auto it = items.begin(); it != items.end(); it++) {
+        if ((*it)->source == source) {
+            auto item = *it;
+            items.erase(it);
+            emitSignal(&scene->signalHandler, "item_remove", scene);
+
+            obs_source_release(item->source);
+            delete item;
+            return;
+        }
+    }
+}
+
+void ObsStub::setFrontendScenes(const std::vector<obs_source_t *> &scenes)
+{
+    for (auto scene : scenes) {
+        obs_source_get_ref(scene);
+    }
+    for (auto scene : frontendScenes) {
+        obs_source_release(scene);
+    }
+    frontendScenes = scenes;
+    emitFrontendEvent(OBS_FRONTEND_EVENT_SCENE_LIST_CHANGED);
+}
+
+size_t ObsStub::countSignalConnections(obs_source_t *source)
+{
+    return obs_source_get_signal_handler(source)->connections.size();
+}
+
+size_t ObsStub::countGlobalSignalConnections()
+{
+    return globalSignalHandler.connections.size() + frontendEventCallbacks.size();
+}
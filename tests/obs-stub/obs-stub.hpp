@@ -0,0 +1,80 @@
+/*
+Branch Output Plugin
+Copyright (C) 2024 OPENSPHERE Inc. info@opensphere.co.jp
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#pragma once
+
+#include <obs-module.h>
+
+#include <vector>
+
+// Simulated outputs: Connecting takes connectNs, then the output fails or goes active. Active output drops
+// for libobs' own reconnect, which recovers or gives up after retryNs (Then obs_output_active() turns false).
+struct ObsStubOutputFaults {
+    int startFailPercent;   // obs_output_start() returns false
+    int connectFailPercent; // Connect attempt fails
+    int dropPerMille;       // Active output drops per tick
+    int recoverPercent;     // libobs' own reconnect succeeds
+    uint64_t connectNs;
+    uint64_t retryNs;
+};
+
+enum ObsStubSourceType {
+    OBS_STUB_SOURCE_INPUT,
+    OBS_STUB_SOURCE_SCENE,
+    OBS_STUB_SOURCE_GROUP,
+};
+
+// Control of the libobs stub (Not thread-safe except for logging, drive it from one thread)
+class ObsStub {
+public:
+    // Messages above the level are dropped (Default is LOG_WARNING)
+    static void setLogLevel(int level);
+
+    // Move os_gettime_ns() forward without sleeping
+    static void advanceTime(uint64_t ns);
+
+    // Run input callback of the audio once, same as libobs audio thread does for each tick
+    static bool renderAudio(audio_t *audio, uint64_t startTs, uint32_t mixers, audio_output_data *mixes);
+
+    // Random faults are reproducible with the same seed
+    static void setOutputFaults(const ObsStubOutputFaults &faults, uint32_t seed = 1);
+    // Advance simulated connection of every output (Call after advanceTime())
+    static void tickOutputs();
+    static size_t countOutputs();
+    // Values returned by obs_output_get_congestion() / get_frames_dropped() / get_total_frames()
+    static void setOutputStats(obs_output_t *output, float congestion, int framesDropped, int totalFrames);
+
+    // Calls of obs_encoder_update() (Including the one in creation with settings)
+    static int countEncoderUpdates(obs_encoder_t *encoder);
+
+    // Scene graph: Created source has one reference for the caller (Release with obs_source_release()).
+    // Signals are emitted same as libobs: "source_create" (Public only), "source_remove", "source_destroy" and
+    // "item_add" / "item_remove" on the scene or group.
+    static obs_source_t *createSource(const char *name, ObsStubSourceType type, bool isPrivate = false);
+    // Hide from enumeration and frontend (Source lives until the last reference is released)
+    static void removeSource(obs_source_t *source);
+    // Scene item references the source
+    static void addSceneItem(obs_source_t *scene, obs_source_t *source);
+    static void removeSceneItem(obs_source_t *scene, obs_source_t *source);
+    // Scenes listed by obs_frontend_get_scenes() (Referenced while listed), emits SCENE_LIST_CHANGED
+    static void setFrontendScenes(const std::vector<obs_source_t *> &scenes);
+    // Callbacks connected to signals of the source
+    static size_t countSignalConnections(obs_source_t *source);
+    // Global signals and frontend event callbacks
+    static size_t countGlobalSignalConnections();
+};
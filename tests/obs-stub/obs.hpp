@@ -0,0 +1,160 @@
+/*
+Branch Output Plugin
+Copyright (C) 2024 OPENSPHERE Inc. info@opensphere.co.jp
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#pragma once
+
+// Reference holders and signal connection of obs.hpp which plugin sources linked into standalone targets use
+
+#include <obs-module.h>
+
+template<class T, void release(T)> class OBSRefAutoRelease {
+    T val;
+
+public:
+    inline OBSRefAutoRelease() : val(nullptr) {}
+    inline OBSRefAutoRelease(T val_) : val(val_) {}
+    OBSRefAutoRelease(const OBSRefAutoRelease &) = delete;
+    inline OBSRefAutoRelease(OBSRefAutoRelease &&ref) : val(ref.val) { ref.val = nullptr; }
+    inline ~OBSRefAutoRelease() { release(val); }
+
+    OBSRefAutoRelease &operator=(const OBSRefAutoRelease &) = delete;
+    inline OBSRefAutoRelease &operator=(OBSRefAutoRelease &&ref)
+    {
+        if (this != &ref) {
+            release(val);
+            val = ref.val;
+            ref.val = nullptr;
+        }
+        return *this;
+    }
+    inline OBSRefAutoRelease &operator=(T valIn)
+    {
+        release(val);
+        val = valIn;
+        return *this;
+    }
+
+    inline operator T() const { return val; }
+    inline T Get() const { return val; }
+    inline bool operator==(T p) const { return val == p; }
+    inline bool operator!=(T p) const { return val != p; }
+};
+
+// Reference taken on assignment
+template<class T, T getref(T), void release(T)> class OBSSafeRef {
+    T val;
+
+public:
+    inline OBSSafeRef() : val(nullptr) {}
+    inline OBSSafeRef(T val_) : val(getref(val_)) {}
+    inline OBSSafeRef(const OBSSafeRef &ref) : val(getref(ref.val)) {}
+    inline OBSSafeRef(OBSSafeRef &&ref) : val(ref.val) { ref.val = nullptr; }
+    inline ~OBSSafeRef() { release(val); }
+
+    inline OBSSafeRef &operator=(const OBSSafeRef &ref) { return *this = ref.val; }
+    inline OBSSafeRef &operator=(OBSSafeRef &&ref)
+    {
+        if (this != &ref) {
+            release(val);
+            val = ref.val;
+            ref.val = nullptr;
+        }
+        return *this;
+    }
+    inline OBSSafeRef &operator=(T valIn)
+    {
+        T newVal = getref(valIn);
+        release(val);
+        val = newVal;
+        return *this;
+    }
+
+    inline operator T() const { return val; }
+    inline T Get() const { return val; }
+};
+
+// Sole owner of unreferenced object (Destroyed with the holder)
+template<class T, void destroy(T)> class OBSPtr {
+    T obj;
+
+public:
+    inline OBSPtr() : obj(nullptr) {}
+    inline OBSPtr(T obj_) : obj(obj_) {}
+    OBSPtr(const OBSPtr &) = delete;
+    inline OBSPtr(OBSPtr &&other) : obj(other.obj) { other.obj = nullptr; }
+    inline ~OBSPtr() { destroy(obj); }
+
+    OBSPtr &operator=(const OBSPtr &) = delete;
+    inline OBSPtr &operator=(OBSPtr &&other)
+    {
+        if (this != &other) {
+            destroy(obj);
+            obj = other.obj;
+            other.obj = nullptr;
+        }
+        return *this;
+    }
+
+    inline operator T() const { return obj; }
+};
+
+using OBSSource = OBSSafeRef<obs_source_t *, obs_source_get_ref, obs_source_release>;
+using OBSView = OBSPtr<obs_view_t *, obs_view_destroy>;
+
+using OBSDataAutoRelease = OBSRefAutoRelease<obs_data_t *, obs_data_release>;
+using OBSSourceAutoRelease = OBSRefAutoRelease<obs_source_t *, obs_source_release>;
+using OBSSceneAutoRelease = OBSRefAutoRelease<obs_scene_t *, obs_scene_release>;
+using OBSWeakSourceAutoRelease = OBSRefAutoRelease<obs_weak_source_t *, obs_weak_source_release>;
+using OBSOutputAutoRelease = OBSRefAutoRelease<obs_output_t *, obs_output_release>;
+using OBSEncoderAutoRelease = OBSRefAutoRelease<obs_encoder_t *, obs_encoder_release>;
+
+class OBSSignal {
+    signal_handler_t *handler;
+    const char *signal;
+    signal_callback_t callback;
+    void *param;
+
+public:
+    inline OBSSignal() : handler(nullptr), signal(nullptr), callback(nullptr), param(nullptr) {}
+    OBSSignal(const OBSSignal &) = delete;
+    inline ~OBSSignal() { Disconnect(); }
+
+    OBSSignal &operator=(const OBSSignal &) = delete;
+
+    inline void Connect(signal_handler_t *handler_, const char *signal_, signal_callback_t callback_, void *param_)
+    {
+        Disconnect();
+
+        handler = handler_;
+        signal = signal_;
+        callback = callback_;
+        param = param_;
+        signal_handler_connect(handler, signal, callback, param);
+    }
+
+    inline void Disconnect()
+    {
+        if (handler) {
+            signal_handler_disconnect(handler, signal, callback, param);
+        }
+        handler = nullptr;
+        signal = nullptr;
+        callback = nullptr;
+        param = nullptr;
+    }
+};
@@ -0,0 +1,173 @@
+/*
+Branch Output Plugin
+Copyright (C) 2024 OPENSPHERE Inc. info@opensphere.co.jp
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#include <obs-module.h>
+#include <obs.hpp>
+
+#include "unit-test.hpp"
+#include "obs-stub.hpp"
+#include "adaptive-bitrate.hpp"
+
+// Encoder with bitrate (kbps) in settings, 0 means non bitrate based (e.g. CQP)
+static obs_encoder_t *createEncoder(int64_t bitrate)
+{
+    OBSDataAutoRelease settings = obs_data_create();
+    obs_data_set_string(settings, "rate_control", bitrate ? "CBR" : "CQP");
+    if (bitrate) {
+        obs_data_set_int(settings, "bitrate", bitrate);
+    }
+    return obs_video_encoder_create("obs_x264", "test_video", settings, nullptr);
+}
+
+static int64_t getEncoderBitrate(obs_encoder_t *encoder)
+{
+    OBSDataAutoRelease settings = obs_encoder_get_settings(encoder);
+    return obs_data_get_int(settings, "bitrate");
+}
+
+UNIT_TEST(startsAtConfiguredBitrate)
+{
+    OBSEncoderAutoRelease encoder = createEncoder(6000);
+    OBSOutputAutoRelease output = obs_output_create("rtmp_output", "test_stream", nullptr, nullptr);
+    AdaptiveBitrateController controller("test", encoder, 50);
+    CHECK_EQ(controller.getBitrate(), 6000);
+    CHECK(controller.getEncoder() == encoder);
+
+    // Nothing to raise
+    for (int i = 0; i < ADAPTIVE_BITRATE_STABLE_INTERVALS * 2; i++) {
+        controller.evaluate({output});
+    }
+    CHECK_EQ(controller.getBitrate(), 6000);
+    CHECK_EQ(ObsStub::countEncoderUpdates(encoder), 1);
+}
+
+UNIT_TEST(congestionLowersDownToMinimum)
+{
+    OBSEncoderAutoRelease encoder = createEncoder(6000);
+    OBSOutputAutoRelease output = obs_output_create("rtmp_output", "test_stream", nullptr, nullptr);
+    AdaptiveBitrateController controller("test", encoder, 50);
+
+    ObsStub::setOutputStats(output, ADAPTIVE_BITRATE_CONGESTION_HIGH, 0, 0);
+    controller.evaluate({output});
+    CHECK_EQ(controller.getBitrate(), 4500);
+    CHECK_EQ(getEncoderBitrate(encoder), 4500);
+
+    controller.evaluate({output});
+    CHECK_EQ(controller.getBitrate(), 3375);
+
+    // Floored at the minimum, then the encoder isn't touched anymore
+    controller.evaluate({output});
+    CHECK_EQ(controller.getBitrate(), 3000);
+    auto updates = ObsStub::countEncoderUpdates(encoder);
+    controller.evaluate({output});
+    CHECK_EQ(controller.getBitrate(), 3000);
+    CHECK_EQ(getEncoderBitrate(encoder), 3000);
+    CHECK_EQ(ObsStub::countEncoderUpdates(encoder), updates);
+}
+
+UNIT_TEST(stableIntervalsRaiseUpToConfigured)
+{
+    OBSEncoderAutoRelease encoder = createEncoder(6000);
+    OBSOutputAutoRelease output = obs_output_create("rtmp_output", "test_stream", nullptr, nullptr);
+    AdaptiveBitrateController controller("test", encoder, 50);
+
+    ObsStub::setOutputStats(output, 1.0f, 0, 0);
+    controller.evaluate({output});
+    CHECK_EQ(controller.getBitrate(), 4500);
+
+    ObsStub::setOutputStats(output, 0.0f, 0, 0);
+    for (int i = 1; i < ADAPTIVE_BITRATE_STABLE_INTERVALS; i++) {
+        controller.evaluate({output});
+    }
+    CHECK_EQ(controller.getBitrate(), 4500);
+    controller.evaluate({output});
+    CHECK_EQ(controller.getBitrate(), 4800);
+
+    // Medium congestion holds the bitrate and restarts counting
+    for (int i = 1; i < ADAPTIVE_BITRATE_STABLE_INTERVALS; i++) {
+        controller.evaluate({output});
+    }
+    ObsStub::setOutputStats(output, (ADAPTIVE_BITRATE_CONGESTION_LOW + ADAPTIVE_BITRATE_CONGESTION_HIGH) / 2, 0, 0);
+    controller.evaluate({output});
+    CHECK_EQ(controller.getBitrate(), 4800);
+
+    ObsStub::setOutputStats(output, 0.0f, 0, 0);
+    for (int i = 0; i < ADAPTIVE_BITRATE_STABLE_INTERVALS * 10; i++) {
+        controller.evaluate({output});
+    }
+    CHECK_EQ(controller.getBitrate(), 6000);
+    CHECK_EQ(getEncoderBitrate(encoder), 6000);
+}
+
+UNIT_TEST(droppedFramesLowerBitrate)
+{
+    OBSEncoderAutoRelease encoder = createEncoder(6000);
+    OBSOutputAutoRelease output = obs_output_create("rtmp_output", "test_stream", nullptr, nullptr);
+    AdaptiveBitrateController controller("test", encoder, 50);
+
+    // The first interval only takes counts (Drops before enabling don't matter)
+    ObsStub::setOutputStats(output, 0.0f, 500, 1000);
+    controller.evaluate({output});
+    CHECK_EQ(controller.getBitrate(), 6000);
+
+    // Just below threshold
+    ObsStub::setOutputStats(output, 0.0f, 500 + ADAPTIVE_BITRATE_DROP_PERMILLE - 1, 2000);
+    controller.evaluate({output});
+    CHECK_EQ(controller.getBitrate(), 6000);
+
+    ObsStub::setOutputStats(output, 0.0f, 500 + ADAPTIVE_BITRATE_DROP_PERMILLE * 2 - 1, 3000);
+    controller.evaluate({output});
+    CHECK_EQ(controller.getBitrate(), 4500);
+
+    // Restarted output (Counters reset) isn't counted as drops
+    ObsStub::setOutputStats(output, 0.0f, 0, 10);
+    controller.evaluate({output});
+    CHECK_EQ(controller.getBitrate(), 4500);
+}
+
+UNIT_TEST(worstStreamDecides)
+{
+    OBSEncoderAutoRelease encoder = createEncoder(8000);
+    OBSOutputAutoRelease good = obs_output_create("rtmp_output", "test_good", nullptr, nullptr);
+    OBSOutputAutoRelease bad = obs_output_create("rtmp_output", "test_bad", nullptr, nullptr);
+    AdaptiveBitrateController controller("test", encoder, 25);
+
+    ObsStub::setOutputStats(bad, 0.8f, 0, 0);
+    controller.evaluate({good, bad});
+    CHECK_EQ(controller.getBitrate(), 6000);
+
+    // Stopped outputs are no longer passed
+    for (int i = 0; i < ADAPTIVE_BITRATE_STABLE_INTERVALS; i++) {
+        controller.evaluate({good});
+    }
+    CHECK_EQ(controller.getBitrate(), 6400);
+}
+
+UNIT_TEST(nonBitrateEncoderIsLeftAlone)
+{
+    OBSEncoderAutoRelease encoder = createEncoder(0);
+    OBSOutputAutoRelease output = obs_output_create("rtmp_output", "test_stream", nullptr, nullptr);
+    AdaptiveBitrateController controller("test", encoder, 50);
+
+    ObsStub::setOutputStats(output, 1.0f, 100, 100);
+    controller.evaluate({output});
+    controller.evaluate({output});
+    CHECK_EQ(controller.getBitrate(), 0);
+    CHECK_EQ(ObsStub::countEncoderUpdates(encoder), 1);
+    CHECK_EQ(getEncoderBitrate(encoder), 0);
+}
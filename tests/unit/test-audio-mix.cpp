@@ -0,0 +1,139 @@
+/*
+Branch Output Plugin
+Copyright (C) 2024 OPENSPHERE Inc. info@opensphere.co.jp
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#include <float.h>
+#include <math.h>
+#include <string.h>
+
+#include <random>
+#include <vector>
+
+#include "unit-test.hpp"
+#include "audio/audio-mix.hpp"
+
+// Values around bounds and IEEE specials, mixed into random signal
+static const float specialValues[] = {
+    0.0f,    -0.0f,    1.0f,     -1.0f,     1.0000001f, -1.0000001f, 0.9999999f, FLT_MIN / 2,
+    FLT_MAX, -FLT_MAX, INFINITY, -INFINITY, NAN,        -NAN,        0.5f,       -0.5f,
+};
+
+static std::vector<float> makeSignal(std::mt19937 &random, size_t frames, bool specials)
+{
+    std::uniform_real_distribution<float> sample(-1.5f, 1.5f);
+    std::uniform_int_distribution<size_t> pick(0, sizeof(specialValues) / sizeof(float) - 1);
+
+    std::vector<float> signal(frames);
+    for (size_t i = 0; i < frames; i++) {
+        signal[i] = specials && (i % 3 == 0) ? specialValues[pick(random)] : sample(random);
+    }
+    return signal;
+}
+
+static bool isSilenceOrInRange(float value)
+{
+    return value == value && value >= -1.0f && value <= 1.0f;
+}
+
+UNIT_TEST(selectedKernelIsTheBestAvailable)
+{
+    MixAndClampKernel kernels[MIX_AND_CLAMP_MAX_KERNELS];
+    auto count = getMixAndClampKernels(kernels, MIX_AND_CLAMP_MAX_KERNELS);
+    CHECK(count >= 1);
+    CHECK(!strcmp(mixAndClampKernelName(), kernels[0].name));
+    CHECK(!strcmp(kernels[count - 1].name, "scalar"));
+
+    // Truncated to the requested count
+    MixAndClampKernel best;
+    CHECK_EQ(getMixAndClampKernels(&best, 1), (size_t)1);
+    CHECK(!strcmp(best.name, kernels[0].name));
+}
+
+UNIT_TEST(scalarClampsAndSilencesNan)
+{
+    float out[] = {0.5f, 0.9f, -0.9f, 0.0f, INFINITY, INFINITY, 0.25f};
+    const float in[] = {0.25f, 0.2f, -0.2f, NAN, 1.0f, -INFINITY, -0.5f};
+    const float expected[] = {0.75f, 1.0f, -1.0f, 0.0f, 1.0f, 0.0f, -0.25f};
+
+    mixAndClampScalar(out, in, 7);
+    for (size_t i = 0; i < 7; i++) {
+        CHECK_EQ(out[i], expected[i]);
+    }
+}
+
+// Every kernel must give bit-identical result to scalar one, for any length and alignment (Tail handling)
+UNIT_TEST(kernelsMatchScalar)
+{
+    MixAndClampKernel kernels[MIX_AND_CLAMP_MAX_KERNELS];
+    auto count = getMixAndClampKernels(kernels, MIX_AND_CLAMP_MAX_KERNELS);
+
+    std::mt19937 random(20240601);
+    for (size_t k = 0; k < count; k++) {
+        for (size_t frames = 0; frames <= 67; frames++) {
+            for (size_t align = 0; align < 4; align++) {
+                auto specials = (frames + align) % 2 == 0;
+                auto out = makeSignal(random, frames + align, specials);
+                auto in = makeSignal(random, frames + align, !specials);
+                auto reference = out;
+
+                mixAndClampScalar(reference.data() + align, in.data() + align, frames);
+                kernels[k].func(out.data() + align, in.data() + align, frames);
+
+                auto matched = true;
+                for (size_t i = 0; i < frames + align; i++) {
+                    // Compare bits, so that -0.0 and NaN differences are caught too
+                    if (memcmp(&out[i], &reference[i], sizeof(float))) {
+                        matched = false;
+                    }
+                    if (i >= align && !isSilenceOrInRange(out[i])) {
+                        matched = false;
+                    }
+                }
+                if (!matched) {
+                    fprintf(stderr, "kernel=%s frames=%zu align=%zu\n", kernels[k].name, frames, align);
+                }
+                CHECK(matched);
+            }
+        }
+    }
+}
+
+UNIT_TEST(kernelsMatchScalarOverRepeatedMixing)
+{
+    MixAndClampKernel kernels[MIX_AND_CLAMP_MAX_KERNELS];
+    auto count = getMixAndClampKernels(kernels, MIX_AND_CLAMP_MAX_KERNELS);
+
+    // Same as AudioCapture summing several tracks into one mix buffer
+    std::mt19937 random(7);
+    std::vector<std::vector<float>> inputs;
+    for (int i = 0; i < 6; i++) {
+        inputs.push_back(makeSignal(random, 1024, i == 3));
+    }
+
+    std::vector<float> reference(1024, 0.0f);
+    for (auto &in : inputs) {
+        mixAndClampScalar(reference.data(), in.data(), in.size());
+    }
+
+    for (size_t k = 0; k < count; k++) {
+        std::vector<float> out(1024, 0.0f);
+        for (auto &in : inputs) {
+            kernels[k].func(out.data(), in.data(), in.size());
+        }
+        CHECK(!memcmp(out.data(), reference.data(), out.size() * sizeof(float)));
+    }
+}
@@ -0,0 +1,342 @@
+/*
+Branch Output Plugin
+Copyright (C) 2024 OPENSPHERE Inc. info@opensphere.co.jp
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#include <obs-module.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "unit-test.hpp"
+#include "audio/audio-ring-buffer.hpp"
+
+// Planar block whose samples are consecutive frame numbers (Channel number added as fraction)
+struct TestBlock {
+    std::vector<float> samples[MAX_AV_PLANES];
+    const uint8_t *data[MAX_AV_PLANES];
+
+    TestBlock(size_t channels, size_t frames, size_t firstFrame) : data{}
+    {
+        for (size_t ch = 0; ch < channels; ch++) {
+            samples[ch].resize(frames);
+            for (size_t i = 0; i < frames; i++) {
+                samples[ch][i] = expected(ch, firstFrame + i);
+            }
+            data[ch] = (const uint8_t *)samples[ch].data();
+        }
+    }
+
+    static float expected(size_t channel, size_t frame) { return (float)frame + (float)channel / 10.0f; }
+};
+
+// Compare frames at the reader's position with TestBlock::expected() through peek()
+static bool readerSees(AudioRingBuffer &buffer, int reader, size_t frames, size_t firstFrame)
+{
+    for (size_t ch = 0; ch < buffer.getChannels(); ch++) {
+        AudioSpan spans[2];
+        auto count = buffer.peek(reader, ch, frames, spans);
+
+        size_t frame = firstFrame;
+        for (size_t s = 0; s < count; s++) {
+            for (size_t i = 0; i < spans[s].frames; i++) {
+                if (spans[s].data[i] != TestBlock::expected(ch, frame++)) {
+                    return false;
+                }
+            }
+        }
+        if (frame != firstFrame + frames) {
+            return false;
+        }
+    }
+    return true;
+}
+
+UNIT_TEST(capacityIsRoundedUpToPowerOfTwo)
+{
+    AudioRingBuffer buffer(2, 1000);
+    CHECK_EQ(buffer.getCapacity(), (size_t)1024);
+    CHECK_EQ(buffer.getChannels(), (size_t)2);
+
+    AudioRingBuffer exact(1, 256);
+    CHECK_EQ(exact.getCapacity(), (size_t)256);
+
+    AudioRingBuffer tooManyChannels(MAX_AV_PLANES + 2, 16);
+    CHECK_EQ(tooManyChannels.getChannels(), (size_t)MAX_AV_PLANES);
+}
+
+UNIT_TEST(writeWithoutReaderIsDiscarded)
+{
+    AudioRingBuffer buffer(2, 16);
+
+    // Never full without readers
+    for (size_t i = 0; i < 8; i++) {
+        TestBlock block(2, 16, i * 16);
+        CHECK(buffer.write(block.data, 16));
+    }
+
+    // New reader starts from the current write position
+    auto reader = buffer.addReader();
+    CHECK(reader >= 0);
+    CHECK_EQ(buffer.size(reader), (size_t)0);
+}
+
+UNIT_TEST(peekSplitsAtWrapPoint)
+{
+    AudioRingBuffer buffer(2, 16);
+    auto reader = buffer.addReader();
+
+    TestBlock first(2, 12, 0);
+    CHECK(buffer.write(first.data, 12));
+    CHECK(readerSees(buffer, reader, 12, 0));
+    buffer.consume(reader, 12);
+
+    // 4 frames at the tail of storage, 6 frames from the head
+    TestBlock second(2, 10, 12);
+    CHECK(buffer.write(second.data, 10));
+    CHECK_EQ(buffer.size(reader), (size_t)10);
+
+    AudioSpan spans[2];
+    CHECK_EQ(buffer.peek(reader, 0, 10, spans), (size_t)2);
+    CHECK_EQ(spans[0].frames, (size_t)4);
+    CHECK_EQ(spans[1].frames, (size_t)6);
+    CHECK(readerSees(buffer, reader, 10, 12));
+
+    // Partial peek inside the tail doesn't need the second span
+    CHECK_EQ(buffer.peek(reader, 1, 3, spans), (size_t)1);
+    CHECK_EQ(spans[0].frames, (size_t)3);
+
+    buffer.consume(reader, 10);
+    CHECK_EQ(buffer.size(reader), (size_t)0);
+}
+
+UNIT_TEST(missingChannelIsSilence)
+{
+    AudioRingBuffer buffer(2, 16);
+    auto reader = buffer.addReader();
+
+    // Wrap around with the second plane missing
+    TestBlock head(2, 10, 0);
+    CHECK(buffer.write(head.data, 10));
+    buffer.consume(reader, 10);
+
+    TestBlock mono(1, 12, 10);
+    CHECK(buffer.write(mono.data, 12));
+
+    AudioSpan spans[2];
+    auto count = buffer.peek(reader, 1, 12, spans);
+    CHECK_EQ(count, (size_t)2);
+    for (size_t s = 0; s < count; s++) {
+        for (size_t i = 0; i < spans[s].frames; i++) {
+            CHECK_EQ(spans[s].data[i], 0.0f);
+        }
+    }
+}
+
+UNIT_TEST(writeFailsWhenFull)
+{
+    AudioRingBuffer buffer(1, 16);
+    auto reader = buffer.addReader();
+
+    TestBlock full(1, 16, 0);
+    CHECK(buffer.write(full.data, 16));
+
+    // Rejected as a whole, nothing is overwritten
+    TestBlock overflow(1, 1, 16);
+    CHECK(!buffer.write(overflow.data, 1));
+    CHECK_EQ(buffer.size(reader), (size_t)16);
+    CHECK(readerSees(buffer, reader, 16, 0));
+
+    buffer.consume(reader, 5);
+    TestBlock refill(1, 6, 16);
+    CHECK(!buffer.write(refill.data, 6));
+    CHECK(buffer.write(refill.data, 5));
+    CHECK(readerSees(buffer, reader, 16, 5));
+}
+
+UNIT_TEST(continuityOverManyWraps)
+{
+    AudioRingBuffer buffer(2, 64);
+    auto reader = buffer.addReader();
+
+    // Block and read sizes don't divide the capacity, so every offset gets wrapped at
+    size_t written = 0;
+    size_t read = 0;
+    for (int i = 0; i < 2000; i++) {
+        auto frames = (size_t)(i % 23) + 1;
+        TestBlock block(2, frames, written);
+        if (buffer.write(block.data, frames)) {
+            written += frames;
+        }
+
+        auto available = buffer.size(reader);
+        CHECK_EQ(available, written - read);
+
+        auto readFrames = std::min(available, (size_t)(i % 17) + 1);
+        auto matched = readerSees(buffer, reader, readFrames, read);
+        CHECK(matched);
+        if (!matched) {
+            break;
+        }
+        buffer.consume(reader, readFrames);
+        read += readFrames;
+    }
+
+    CHECK(written > buffer.getCapacity() * 100);
+    CHECK_EQ(buffer.getMaxBlockFrames(), (size_t)23);
+}
+
+UNIT_TEST(flushDropsBufferedFrames)
+{
+    AudioRingBuffer buffer(1, 16);
+    auto reader = buffer.addReader();
+
+    // Nothing to apply without request
+    CHECK(!buffer.handleFlush(reader));
+
+    TestBlock block(1, 10, 0);
+    CHECK(buffer.write(block.data, 10));
+    buffer.requestFlush();
+    CHECK_EQ(buffer.size(reader), (size_t)10);
+
+    CHECK(buffer.handleFlush(reader));
+    CHECK_EQ(buffer.size(reader), (size_t)0);
+    CHECK(!buffer.handleFlush(reader));
+
+    // Reading resumes with the next block
+    TestBlock next(1, 8, 10);
+    CHECK(buffer.write(next.data, 8));
+    CHECK(readerSees(buffer, reader, 8, 10));
+}
+
+UNIT_TEST(readTimestampFollowsReaderPosition)
+{
+    AudioRingBuffer buffer(1, 2048);
+    auto reader = buffer.addReader();
+
+    uint64_t ts = 0;
+    TestBlock block(1, 480, 0);
+    // Block without timestamp doesn't publish one
+    CHECK(buffer.write(block.data, 480));
+    CHECK(!buffer.getReadTimestamp(reader, 48000, &ts));
+
+    CHECK(buffer.write(block.data, 480, 1000000000ULL));
+    CHECK(!buffer.getReadTimestamp(reader, 0, &ts));
+
+    // Reader is 480 frames (10 ms) behind the block
+    CHECK(buffer.getReadTimestamp(reader, 48000, &ts));
+    CHECK_EQ(ts, 990000000ULL);
+
+    buffer.consume(reader, 720);
+    CHECK(buffer.getReadTimestamp(reader, 48000, &ts));
+    CHECK_EQ(ts, 1005000000ULL);
+}
+
+UNIT_TEST(readersHaveIndependentCursors)
+{
+    AudioRingBuffer buffer(2, 64);
+    auto a = buffer.addReader();
+    auto b = buffer.addReader();
+    CHECK(a >= 0 && b >= 0 && a != b);
+
+    TestBlock block(2, 20, 0);
+    CHECK(buffer.write(block.data, 20));
+
+    // Every reader sees the same block, consuming it on one doesn't affect another
+    CHECK(readerSees(buffer, a, 20, 0));
+    buffer.consume(a, 15);
+    CHECK_EQ(buffer.size(a), (size_t)5);
+    CHECK_EQ(buffer.size(b), (size_t)20);
+    CHECK(readerSees(buffer, a, 5, 15));
+    CHECK(readerSees(buffer, b, 20, 0));
+
+    buffer.consume(b, 7);
+    CHECK(readerSees(buffer, b, 13, 7));
+}
+
+UNIT_TEST(slowestReaderLimitsSpace)
+{
+    AudioRingBuffer buffer(1, 16);
+    auto fast = buffer.addReader();
+    auto slow = buffer.addReader();
+
+    TestBlock first(1, 12, 0);
+    CHECK(buffer.write(first.data, 12));
+    buffer.consume(fast, 12);
+
+    // Fast reader is empty, but the slow one still holds 12 frames
+    TestBlock second(1, 8, 12);
+    CHECK(!buffer.write(second.data, 8));
+    CHECK(buffer.write(second.data, 4));
+    CHECK(readerSees(buffer, fast, 4, 12));
+    CHECK(readerSees(buffer, slow, 16, 0));
+
+    // Detached reader no longer holds space
+    buffer.removeReader(slow);
+    TestBlock third(1, 12, 16);
+    CHECK(buffer.write(third.data, 12));
+    CHECK(readerSees(buffer, fast, 16, 12));
+}
+
+UNIT_TEST(readerIdsAreLimitedAndReused)
+{
+    AudioRingBuffer buffer(1, 16);
+
+    int readers[AUDIO_RING_MAX_READERS];
+    for (int i = 0; i < AUDIO_RING_MAX_READERS; i++) {
+        readers[i] = buffer.addReader();
+        CHECK(readers[i] >= 0);
+    }
+    CHECK_EQ(buffer.addReader(), -1);
+
+    TestBlock block(1, 10, 0);
+    CHECK(buffer.write(block.data, 10));
+
+    // Freed id is handed out again, starting from the current write position
+    buffer.removeReader(readers[2]);
+    auto reused = buffer.addReader();
+    CHECK_EQ(reused, readers[2]);
+    CHECK_EQ(buffer.size(reused), (size_t)0);
+    CHECK_EQ(buffer.size(readers[0]), (size_t)10);
+
+    // Out of range ids are ignored
+    buffer.removeReader(-1);
+    buffer.removeReader(AUDIO_RING_MAX_READERS);
+    CHECK_EQ(buffer.addReader(), -1);
+}
+
+UNIT_TEST(flushIsAppliedPerReader)
+{
+    AudioRingBuffer buffer(1, 32);
+    auto a = buffer.addReader();
+    auto b = buffer.addReader();
+
+    TestBlock block(1, 10, 0);
+    CHECK(buffer.write(block.data, 10));
+    buffer.consume(b, 4);
+    buffer.requestFlush();
+
+    // Each reader drops its frames when it handles the request in its own thread
+    CHECK(buffer.handleFlush(a));
+    CHECK_EQ(buffer.size(a), (size_t)0);
+    CHECK_EQ(buffer.size(b), (size_t)6);
+
+    TestBlock next(1, 5, 10);
+    CHECK(buffer.write(next.data, 5));
+    CHECK(buffer.handleFlush(b));
+    CHECK_EQ(buffer.size(b), (size_t)0);
+    CHECK(readerSees(buffer, a, 5, 10));
+}
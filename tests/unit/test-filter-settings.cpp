@@ -0,0 +1,188 @@
+/*
+Branch Output Plugin
+Copyright (C) 2024 OPENSPHERE Inc. info@opensphere.co.jp
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#include <obs-module.h>
+#include <obs.hpp>
+
+#include "unit-test.hpp"
+#include "filter-settings.hpp"
+
+UNIT_TEST(emptySettingsParseAsDefaults)
+{
+    OBSDataAutoRelease settings = obs_data_create();
+    auto parsed = FilterSettings::parse(settings);
+
+    CHECK(parsed->services.isEmpty());
+    CHECK_EQ(parsed->countEnabledServices(), 0);
+    CHECK(!parsed->hasOutputs());
+    CHECK(parsed->resolution.resolution.isEmpty());
+    CHECK_EQ(parsed->resolution.scaleType, OBS_SCALE_DISABLE);
+    CHECK(!parsed->mainCanvas);
+    CHECK(!parsed->streamRecording);
+    CHECK(!parsed->replayBuffer);
+
+    for (size_t i = 0; i < MAX_AUDIO_MIXES; i++) {
+        CHECK(!parsed->tracks[i].streaming);
+        CHECK(!parsed->tracks[i].recording);
+    }
+}
+
+UNIT_TEST(servicesUseZeroOriginIndexedNames)
+{
+    OBSDataAutoRelease settings = obs_data_create();
+    obs_data_set_int(settings, "service_count", 3);
+    obs_data_set_string(settings, "server", "rtmp://a.example.com/live");
+    obs_data_set_string(settings, "key", "key-a");
+    obs_data_set_bool(settings, "use_auth_1", true);
+    obs_data_set_string(settings, "username_1", "user");
+    obs_data_set_string(settings, "password_1", "secret");
+    obs_data_set_string(settings, "server_2", "rtmp://c.example.com/live");
+    obs_data_set_string(settings, "key_2", "key-c");
+    obs_data_set_bool(settings, "custom_rendition_2", true);
+    obs_data_set_string(settings, "rendition_resolution_2", "custom");
+    obs_data_set_int(settings, "rendition_custom_width_2", 1280);
+    obs_data_set_int(settings, "rendition_custom_height_2", 720);
+    obs_data_set_string(settings, "rendition_video_encoder_2", "obs_x264");
+    obs_data_set_int(settings, "rendition_bitrate_2", 2500);
+
+    auto parsed = FilterSettings::parse(settings);
+    CHECK_EQ(parsed->services.size(), 3);
+
+    CHECK(parsed->services[0].server == "rtmp://a.example.com/live");
+    CHECK(parsed->services[0].key == "key-a");
+    CHECK(!parsed->services[0].useAuth);
+    CHECK(!parsed->services[0].customRendition);
+
+    // Service without server is disabled
+    CHECK(!parsed->services[1].isEnabled());
+    CHECK(parsed->services[1].useAuth);
+    CHECK(parsed->services[1].username == "user");
+    CHECK(parsed->services[1].password == "secret");
+
+    auto &rendition = parsed->services[2];
+    CHECK(rendition.server == "rtmp://c.example.com/live");
+    CHECK(rendition.customRendition);
+    CHECK(rendition.renditionResolution.resolution == "custom");
+    CHECK_EQ(rendition.renditionResolution.customWidth, (uint32_t)1280);
+    CHECK_EQ(rendition.renditionResolution.customHeight, (uint32_t)720);
+    CHECK(rendition.renditionVideoEncoder == "obs_x264");
+    CHECK_EQ(rendition.renditionBitrate, 2500);
+
+    CHECK_EQ(parsed->countEnabledServices(), 2);
+    CHECK(parsed->hasOutputs());
+}
+
+UNIT_TEST(tracksUseOneOriginIndexedNames)
+{
+    OBSDataAutoRelease settings = obs_data_create();
+    obs_data_set_bool(settings, "multitrack_audio", true);
+    obs_data_set_string(settings, "audio_source", "master_track");
+    obs_data_set_int(settings, "audio_track", 2);
+    obs_data_set_string(settings, "audio_dest", "both");
+    obs_data_set_string(settings, "audio_source_2", "filter");
+    obs_data_set_string(settings, "audio_dest_2", "streaming");
+    obs_data_set_string(settings, "audio_source_6", "disabled");
+    obs_data_set_string(settings, "audio_dest_6", "recording");
+
+    auto parsed = FilterSettings::parse(settings);
+    CHECK(parsed->multitrackAudio);
+
+    CHECK(parsed->tracks[0].audioSource == "master_track");
+    CHECK_EQ(parsed->tracks[0].audioTrack, 2);
+    CHECK(parsed->tracks[0].streaming && parsed->tracks[0].recording);
+
+    CHECK(parsed->tracks[1].audioSource == "filter");
+    CHECK(parsed->tracks[1].streaming && !parsed->tracks[1].recording);
+
+    CHECK(parsed->tracks[5].audioSource == "disabled");
+    CHECK(!parsed->tracks[5].streaming && parsed->tracks[5].recording);
+
+    // Unknown destination goes nowhere
+    CHECK(!parsed->tracks[2].streaming && !parsed->tracks[2].recording);
+}
+
+UNIT_TEST(scaleTypeAppliesToEveryResolution)
+{
+    const struct {
+        const char *filter;
+        obs_scale_type scaleType;
+    } cases[] = {
+        {"bilinear", OBS_SCALE_BILINEAR},
+        {"area", OBS_SCALE_AREA},
+        {"bicubic", OBS_SCALE_BICUBIC},
+        {"lanczos", OBS_SCALE_LANCZOS},
+        {"disable", OBS_SCALE_DISABLE},
+        {"", OBS_SCALE_DISABLE},
+    };
+
+    for (auto &c : cases) {
+        OBSDataAutoRelease settings = obs_data_create();
+        obs_data_set_string(settings, "downscale_filter", c.filter);
+        obs_data_set_int(settings, "service_count", 2);
+
+        auto parsed = FilterSettings::parse(settings);
+        CHECK_EQ(parsed->resolution.scaleType, c.scaleType);
+        CHECK_EQ(parsed->services[0].renditionResolution.scaleType, c.scaleType);
+        CHECK_EQ(parsed->services[1].renditionResolution.scaleType, c.scaleType);
+    }
+}
+
+UNIT_TEST(recordingAndReplayBufferAreOutputs)
+{
+    OBSDataAutoRelease settings = obs_data_create();
+    obs_data_set_bool(settings, "stream_recording", true);
+    obs_data_set_string(settings, "path", "/tmp/rec");
+    obs_data_set_string(settings, "rec_format", "hybrid_mp4");
+    obs_data_set_string(settings, "split_file", "by_size");
+    obs_data_set_int(settings, "split_file_size_mb", 2048);
+    obs_data_set_int(settings, "start_priority", 3);
+
+    auto parsed = FilterSettings::parse(settings);
+    CHECK(parsed->hasOutputs());
+    CHECK(parsed->path == "/tmp/rec");
+    CHECK(parsed->recFormat == "hybrid_mp4");
+    CHECK(parsed->splitFile == "by_size");
+    CHECK_EQ(parsed->splitFileSizeMb, 2048);
+    CHECK_EQ(parsed->startPriority, 3);
+
+    OBSDataAutoRelease replay = obs_data_create();
+    obs_data_set_bool(replay, "replay_buffer", true);
+    obs_data_set_int(replay, "replay_buffer_max_time_sec", 30);
+    auto parsedReplay = FilterSettings::parse(replay);
+    CHECK(parsedReplay->hasOutputs());
+    CHECK_EQ(parsedReplay->replayBufferMaxTimeSec, 30);
+}
+
+UNIT_TEST(snapshotIsIndependentOfSettings)
+{
+    OBSDataAutoRelease settings = obs_data_create();
+    obs_data_set_int(settings, "service_count", 1);
+    obs_data_set_string(settings, "server", "rtmp://a.example.com/live");
+    obs_data_set_string(settings, "video_encoder", "obs_x264");
+
+    auto parsed = FilterSettings::parse(settings);
+
+    // Later revisions don't leak into the parsed one
+    obs_data_set_string(settings, "server", "rtmp://b.example.com/live");
+    obs_data_set_string(settings, "video_encoder", "jim_nvenc");
+    obs_data_set_int(settings, "service_count", 0);
+
+    CHECK_EQ(parsed->services.size(), 1);
+    CHECK(parsed->services[0].server == "rtmp://a.example.com/live");
+    CHECK(parsed->videoEncoder == "obs_x264");
+}
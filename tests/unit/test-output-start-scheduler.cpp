@@ -0,0 +1,214 @@
+/*
+Branch Output Plugin
+Copyright (C) 2024 OPENSPHERE Inc. info@opensphere.co.jp
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#include <obs-module.h>
+#include <util/platform.h>
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QThread>
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+#include "unit-test.hpp"
+#include "output-start-scheduler.hpp"
+
+// Scheduler dispatches in the thread of QCoreApplication (Same as OBS UI thread)
+static void ensureApplication()
+{
+    static int argc = 1;
+    static char name[] = "test-output-start-scheduler";
+    static char *argv[] = {name, nullptr};
+    static QCoreApplication app(argc, argv);
+}
+
+// Run event loop until the condition holds, return false on timeout
+static bool processEventsUntil(const std::function<bool()> &condition, int timeoutMs = 10000)
+{
+    QElapsedTimer elapsed;
+    elapsed.start();
+    while (!condition()) {
+        if (elapsed.elapsed() > timeoutMs) {
+            return false;
+        }
+        QCoreApplication::processEvents(QEventLoop::AllEvents, 10);
+        QThread::msleep(1);
+    }
+    return true;
+}
+
+// Jobs record when they start from worker threads
+struct JobLog {
+    std::mutex mutex;
+    std::vector<int> started;
+    std::vector<uint64_t> startedAt;
+    std::atomic<int> running{0};
+    std::atomic<int> maxRunning{0};
+    std::atomic<int> finished{0};
+
+    std::function<void()> job(int id, int sleepMs = 0, std::atomic<bool> *hold = nullptr)
+    {
+        return [this, id, sleepMs, hold]() {
+            {
+                std::lock_guard<std::mutex> locker(mutex);
+                started.push_back(id);
+                startedAt.push_back(os_gettime_ns());
+            }
+
+            auto now = ++running;
+            auto max = maxRunning.load();
+            while (now > max && !maxRunning.compare_exchange_weak(max, now)) {}
+
+            if (sleepMs) {
+                QThread::msleep(sleepMs);
+            }
+            while (hold && hold->load()) {
+                QThread::msleep(1);
+            }
+
+            running--;
+            finished++;
+        };
+    }
+
+    std::vector<int> getStarted()
+    {
+        std::lock_guard<std::mutex> locker(mutex);
+        return started;
+    }
+};
+
+UNIT_TEST(jobsRunByPriorityThenFifo)
+{
+    ensureApplication();
+    auto scheduler = OutputStartScheduler::getInstance();
+    scheduler->setMaxConcurrent(1);
+    scheduler->setIntervalMs(0);
+
+    JobLog log;
+    int owners[5];
+    scheduler->schedule(&owners[0], 0, log.job(0));
+    scheduler->schedule(&owners[1], 5, log.job(1));
+    scheduler->schedule(&owners[2], 0, log.job(2));
+    scheduler->schedule(&owners[3], 5, log.job(3));
+    scheduler->schedule(&owners[4], 10, log.job(4));
+
+    CHECK(processEventsUntil([&]() { return log.finished == 5; }));
+    CHECK(log.getStarted() == std::vector<int>({4, 1, 3, 0, 2}));
+    CHECK_EQ(log.maxRunning.load(), 1);
+
+    OutputStartScheduler::destroyInstance();
+}
+
+UNIT_TEST(concurrencyIsLimited)
+{
+    ensureApplication();
+    auto scheduler = OutputStartScheduler::getInstance();
+    scheduler->setMaxConcurrent(2);
+    scheduler->setIntervalMs(0);
+
+    JobLog log;
+    int owners[8];
+    for (int i = 0; i < 8; i++) {
+        scheduler->schedule(&owners[i], 0, log.job(i, 20));
+    }
+
+    CHECK(processEventsUntil([&]() { return log.finished == 8; }));
+    CHECK(log.maxRunning.load() <= 2);
+
+    // Jobs started together may record in any order
+    auto started = log.getStarted();
+    std::sort(started.begin(), started.end());
+    CHECK(started == std::vector<int>({0, 1, 2, 3, 4, 5, 6, 7}));
+
+    OutputStartScheduler::destroyInstance();
+}
+
+UNIT_TEST(startsAreSpacedByInterval)
+{
+    ensureApplication();
+    auto scheduler = OutputStartScheduler::getInstance();
+    scheduler->setMaxConcurrent(4);
+    scheduler->setIntervalMs(50);
+
+    JobLog log;
+    int owners[4];
+    for (int i = 0; i < 4; i++) {
+        scheduler->schedule(&owners[i], 0, log.job(i));
+    }
+
+    CHECK(processEventsUntil([&]() { return log.finished == 4; }));
+
+    // Allow a few ms for scheduling of worker threads
+    std::lock_guard<std::mutex> locker(log.mutex);
+    for (size_t i = 1; i < log.startedAt.size(); i++) {
+        CHECK(log.startedAt[i] - log.startedAt[i - 1] >= 45000000ULL);
+    }
+
+    OutputStartScheduler::destroyInstance();
+}
+
+UNIT_TEST(cancelDropsQueuedJobs)
+{
+    ensureApplication();
+    auto scheduler = OutputStartScheduler::getInstance();
+    scheduler->setMaxConcurrent(1);
+    scheduler->setIntervalMs(0);
+
+    JobLog log;
+    std::atomic<bool> hold(true);
+    int running, cancelled, other;
+    scheduler->schedule(&running, 0, log.job(0, 0, &hold));
+    scheduler->schedule(&cancelled, 0, log.job(1));
+    scheduler->schedule(&other, 0, log.job(2));
+    scheduler->schedule(&cancelled, 0, log.job(3));
+    CHECK(processEventsUntil([&]() { return log.running == 1; }));
+
+    CHECK(scheduler->cancel(&cancelled));
+    CHECK(!scheduler->cancel(&cancelled));
+
+    hold = false;
+    CHECK(processEventsUntil([&]() { return log.finished == 2; }));
+    // Give dropped jobs a chance to run (They must not)
+    processEventsUntil([]() { return false; }, 50);
+    CHECK(log.getStarted() == std::vector<int>({0, 2}));
+
+    OutputStartScheduler::destroyInstance();
+}
+
+UNIT_TEST(cancelWaitsForRunningJob)
+{
+    ensureApplication();
+    auto scheduler = OutputStartScheduler::getInstance();
+    scheduler->setIntervalMs(0);
+
+    JobLog log;
+    int owner;
+    scheduler->schedule(&owner, 0, log.job(0, 50));
+    CHECK(processEventsUntil([&]() { return log.running == 1; }));
+
+    // Nothing queued, but returns only after the job has finished (Owner may be destroyed then)
+    CHECK(!scheduler->cancel(&owner));
+    CHECK_EQ(log.finished.load(), 1);
+
+    OutputStartScheduler::destroyInstance();
+}
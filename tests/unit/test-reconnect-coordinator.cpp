@@ -0,0 +1,195 @@
+/*
+Branch Output Plugin
+Copyright (C) 2024 OPENSPHERE Inc. info@opensphere.co.jp
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#include <obs-module.h>
+
+#include <QSet>
+
+#include "unit-test.hpp"
+#include "obs-stub.hpp"
+#include "reconnect-coordinator.hpp"
+
+#define MS_TO_NS(ms) ((uint64_t)(ms) * 1000000ULL)
+
+// Nominal delay after the failures (Without jitter)
+static uint64_t nominalBackoffMs(int failures)
+{
+    if (failures >= RECONNECT_CIRCUIT_FAILURES) {
+        return RECONNECT_CIRCUIT_COOLDOWN_MS;
+    }
+
+    uint64_t delayMs = RECONNECT_BACKOFF_BASE_MS;
+    for (int i = 1; i < failures; i++) {
+        delayMs *= 2;
+    }
+    return delayMs < RECONNECT_BACKOFF_MAX_MS ? delayMs : RECONNECT_BACKOFF_MAX_MS;
+}
+
+static bool withinJitter(uint64_t waitMs, uint64_t nominalMs)
+{
+    auto jitterMs = nominalMs * RECONNECT_JITTER_PERCENT / 100;
+    // waitMs is truncated and measured a bit later than the failure
+    return waitMs + 1 >= nominalMs - jitterMs && waitMs <= nominalMs + jitterMs;
+}
+
+UNIT_TEST(ingestHostIsHostOfUrl)
+{
+    CHECK(ReconnectCoordinator::getIngestHost("rtmp://live.example.com/app") == "live.example.com");
+    CHECK(ReconnectCoordinator::getIngestHost("rtmps://Live.Example.COM:443/app") == "live.example.com");
+    CHECK(ReconnectCoordinator::getIngestHost("srt://srt.example.com:9000") == "srt.example.com");
+    // Not URL (e.g. Service name)
+    CHECK(ReconnectCoordinator::getIngestHost("auto") == "auto");
+}
+
+UNIT_TEST(oneAttemptPerHost)
+{
+    auto coordinator = ReconnectCoordinator::getInstance();
+    int a, b, c;
+    uint64_t waitMs = 1;
+
+    CHECK(coordinator->tryAcquire("host1", &a, &waitMs));
+    CHECK_EQ(waitMs, 0ULL);
+    // The owner may acquire again
+    CHECK(coordinator->tryAcquire("host1", &a, &waitMs));
+
+    // Others wait until the attempt ends or times out
+    CHECK(!coordinator->tryAcquire("host1", &b, &waitMs));
+    CHECK(waitMs > RECONNECT_ATTEMPT_TIMEOUT_MS - 1000 && waitMs <= RECONNECT_ATTEMPT_TIMEOUT_MS);
+
+    // Other hosts are independent
+    CHECK(coordinator->tryAcquire("host2", &c, &waitMs));
+
+    // Success lets waiting outputs go immediately
+    coordinator->reportSuccess("host1", &a);
+    CHECK(coordinator->tryAcquire("host1", &b, &waitMs));
+
+    ReconnectCoordinator::destroyInstance();
+}
+
+UNIT_TEST(failuresBackOffExponentiallyThenOpenCircuit)
+{
+    auto coordinator = ReconnectCoordinator::getInstance();
+    int a, b;
+    uint64_t waitMs = 0;
+
+    for (int failures = 1; failures <= RECONNECT_CIRCUIT_FAILURES + 1; failures++) {
+        CHECK(coordinator->tryAcquire("host", &a, &waitMs));
+        coordinator->reportFailure("host", &a);
+
+        // Every output of the host waits the same
+        CHECK(!coordinator->tryAcquire("host", &a, &waitMs));
+        CHECK(withinJitter(waitMs, nominalBackoffMs(failures)));
+        CHECK(!coordinator->tryAcquire("host", &b, &waitMs));
+
+        ObsStub::advanceTime(MS_TO_NS(waitMs + 1));
+    }
+
+    // Closed by success
+    CHECK(coordinator->tryAcquire("host", &b, &waitMs));
+    coordinator->reportSuccess("host", &b);
+    CHECK(coordinator->tryAcquire("host", &a, &waitMs));
+    coordinator->reportFailure("host", &a);
+    CHECK(!coordinator->tryAcquire("host", &a, &waitMs));
+    CHECK(withinJitter(waitMs, nominalBackoffMs(1)));
+
+    ReconnectCoordinator::destroyInstance();
+}
+
+UNIT_TEST(jitterSpreadsRetries)
+{
+    auto coordinator = ReconnectCoordinator::getInstance();
+    int owner;
+    uint64_t waitMs = 0;
+
+    QSet<uint64_t> delays;
+    for (int i = 0; i < 32; i++) {
+        auto host = QString("host%1").arg(i);
+        CHECK(coordinator->tryAcquire(host, &owner, &waitMs));
+        coordinator->reportFailure(host, &owner);
+        CHECK(!coordinator->tryAcquire(host, &owner, &waitMs));
+        delays.insert(waitMs);
+    }
+
+    // Same failure count, yet not in lockstep
+    CHECK(delays.size() > 1);
+
+    ReconnectCoordinator::destroyInstance();
+}
+
+UNIT_TEST(onlyOwnerReports)
+{
+    auto coordinator = ReconnectCoordinator::getInstance();
+    int a, b;
+    uint64_t waitMs = 0;
+
+    CHECK(coordinator->tryAcquire("host", &a, &waitMs));
+    coordinator->reportFailure("host", &b);
+    coordinator->reportSuccess("host", &b);
+    coordinator->release("host", &b);
+    CHECK(!coordinator->tryAcquire("host", &b, &waitMs));
+
+    // Reports for unknown host are ignored
+    coordinator->reportFailure("unknown", &a);
+    CHECK(coordinator->tryAcquire("unknown", &b, &waitMs));
+
+    ReconnectCoordinator::destroyInstance();
+}
+
+UNIT_TEST(abandonedAttemptTimesOut)
+{
+    auto coordinator = ReconnectCoordinator::getInstance();
+    int a, b;
+    uint64_t waitMs = 0;
+
+    CHECK(coordinator->tryAcquire("host", &a, &waitMs));
+    ObsStub::advanceTime(MS_TO_NS(RECONNECT_ATTEMPT_TIMEOUT_MS / 2));
+    CHECK(!coordinator->tryAcquire("host", &b, &waitMs));
+
+    ObsStub::advanceTime(MS_TO_NS(RECONNECT_ATTEMPT_TIMEOUT_MS / 2 + 1));
+    CHECK(coordinator->tryAcquire("host", &b, &waitMs));
+
+    // The late report of the former owner is ignored
+    coordinator->reportSuccess("host", &a);
+    CHECK(!coordinator->tryAcquire("host", &a, &waitMs));
+
+    ReconnectCoordinator::destroyInstance();
+}
+
+UNIT_TEST(releaseKeepsFailureCount)
+{
+    auto coordinator = ReconnectCoordinator::getInstance();
+    int a, b;
+    uint64_t waitMs = 0;
+
+    // Release without failure forgets the host
+    CHECK(coordinator->tryAcquire("host", &a, &waitMs));
+    coordinator->release("host", &a);
+    CHECK(coordinator->tryAcquire("host", &b, &waitMs));
+    coordinator->reportFailure("host", &b);
+    ObsStub::advanceTime(MS_TO_NS(nominalBackoffMs(1) * 2));
+
+    // Released after a failure, the next failure backs off further
+    CHECK(coordinator->tryAcquire("host", &a, &waitMs));
+    coordinator->release("host", &a);
+    CHECK(coordinator->tryAcquire("host", &b, &waitMs));
+    coordinator->reportFailure("host", &b);
+    CHECK(!coordinator->tryAcquire("host", &a, &waitMs));
+    CHECK(withinJitter(waitMs, nominalBackoffMs(2)));
+
+    ReconnectCoordinator::destroyInstance();
+}
@@ -0,0 +1,181 @@
+/*
+Branch Output Plugin
+Copyright (C) 2024 OPENSPHERE Inc. info@opensphere.co.jp
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#include <obs-module.h>
+
+#include "unit-test.hpp"
+#include "obs-stub.hpp"
+#include "source-membership.hpp"
+
+// Scene "Scene" on frontend with "Camera" in it, and "Unused" input placed nowhere
+struct TestSceneGraph {
+    obs_source_t *scene;
+    obs_source_t *camera;
+    obs_source_t *unused;
+
+    TestSceneGraph()
+    {
+        scene = ObsStub::createSource("Scene", OBS_STUB_SOURCE_SCENE);
+        camera = ObsStub::createSource("Camera", OBS_STUB_SOURCE_INPUT);
+        unused = ObsStub::createSource("Unused", OBS_STUB_SOURCE_INPUT);
+        ObsStub::addSceneItem(scene, camera);
+        ObsStub::setFrontendScenes({scene});
+    }
+
+    ~TestSceneGraph()
+    {
+        ObsStub::setFrontendScenes({});
+        obs_source_release(unused);
+        obs_source_release(camera);
+        obs_source_release(scene);
+    }
+};
+
+UNIT_TEST(instanceIsCreatedExplicitly)
+{
+    // Callers fall back to scanning until post load
+    CHECK(!SourceMembershipIndex::getInstance());
+
+    SourceMembershipIndex::createInstance();
+    auto index = SourceMembershipIndex::getInstance();
+    CHECK(index);
+    SourceMembershipIndex::createInstance();
+    CHECK(SourceMembershipIndex::getInstance() == index);
+
+    SourceMembershipIndex::destroyInstance();
+    CHECK(!SourceMembershipIndex::getInstance());
+    CHECK_EQ(ObsStub::countGlobalSignalConnections(), (size_t)0);
+}
+
+UNIT_TEST(frontendFollowsSceneItems)
+{
+    TestSceneGraph graph;
+    SourceMembershipIndex::createInstance();
+    auto index = SourceMembershipIndex::getInstance();
+
+    CHECK(index->inFrontend(graph.scene));
+    CHECK(index->inFrontend(graph.camera));
+    CHECK(!index->inFrontend(graph.unused));
+    CHECK(!index->inFrontend(nullptr));
+
+    // "item_add" / "item_remove" of the scene invalidate the cache
+    ObsStub::addSceneItem(graph.scene, graph.unused);
+    CHECK(index->inFrontend(graph.unused));
+    ObsStub::removeSceneItem(graph.scene, graph.camera);
+    CHECK(!index->inFrontend(graph.camera));
+    CHECK(index->inFrontend(graph.unused));
+
+    SourceMembershipIndex::destroyInstance();
+}
+
+UNIT_TEST(nestedGroupsAreWatched)
+{
+    TestSceneGraph graph;
+    auto group = ObsStub::createSource("Group", OBS_STUB_SOURCE_GROUP);
+    auto nested = ObsStub::createSource("Nested", OBS_STUB_SOURCE_GROUP);
+    ObsStub::addSceneItem(graph.scene, group);
+    ObsStub::addSceneItem(group, nested);
+
+    SourceMembershipIndex::createInstance();
+    auto index = SourceMembershipIndex::getInstance();
+
+    CHECK(index->inFrontend(group));
+    CHECK(index->inFrontend(nested));
+    CHECK(!index->inFrontend(graph.unused));
+
+    // Items added into groups are caught by signals of the groups
+    ObsStub::addSceneItem(nested, graph.unused);
+    CHECK(index->inFrontend(graph.unused));
+    ObsStub::removeSceneItem(nested, graph.unused);
+    CHECK(!index->inFrontend(graph.unused));
+
+    SourceMembershipIndex::destroyInstance();
+
+    // Every scene and group signal has been disconnected
+    CHECK_EQ(ObsStub::countSignalConnections(graph.scene), (size_t)0);
+    CHECK_EQ(ObsStub::countSignalConnections(group), (size_t)0);
+    CHECK_EQ(ObsStub::countSignalConnections(nested), (size_t)0);
+
+    ObsStub::removeSceneItem(graph.scene, group);
+    obs_source_release(nested);
+    obs_source_release(group);
+}
+
+UNIT_TEST(sceneOutsideFrontendIsNotCounted)
+{
+    TestSceneGraph graph;
+    SourceMembershipIndex::createInstance();
+    auto index = SourceMembershipIndex::getInstance();
+    CHECK(!index->inFrontend(graph.unused));
+
+    // e.g. Scene of another canvas
+    auto other = ObsStub::createSource("Other", OBS_STUB_SOURCE_SCENE);
+    ObsStub::addSceneItem(other, graph.unused);
+    CHECK(!index->inFrontend(other));
+    CHECK(!index->inFrontend(graph.unused));
+
+    // Scene list change invalidates the cache (The scene has been created before)
+    ObsStub::setFrontendScenes({graph.scene, other});
+    CHECK(index->inFrontend(other));
+    CHECK(index->inFrontend(graph.unused));
+
+    SourceMembershipIndex::destroyInstance();
+    obs_source_release(other);
+}
+
+UNIT_TEST(privateAndRemovedSources)
+{
+    TestSceneGraph graph;
+    auto hidden = ObsStub::createSource("Hidden", OBS_STUB_SOURCE_INPUT, true);
+
+    SourceMembershipIndex::createInstance();
+    auto index = SourceMembershipIndex::getInstance();
+
+    CHECK(!index->isPrivate(graph.scene));
+    CHECK(!index->isPrivate(graph.camera));
+    CHECK(!index->isPrivate(graph.unused));
+    CHECK(index->isPrivate(hidden));
+
+    // Removed source isn't enumerated anymore although it's still referenced
+    ObsStub::removeSource(graph.unused);
+    CHECK(index->isPrivate(graph.unused));
+
+    SourceMembershipIndex::destroyInstance();
+    obs_source_release(hidden);
+}
+
+UNIT_TEST(destroyedSceneIsForgotten)
+{
+    TestSceneGraph graph;
+    auto scene = ObsStub::createSource("Temporary", OBS_STUB_SOURCE_SCENE);
+    ObsStub::addSceneItem(scene, graph.unused);
+    ObsStub::setFrontendScenes({graph.scene, scene});
+
+    SourceMembershipIndex::createInstance();
+    auto index = SourceMembershipIndex::getInstance();
+    CHECK(index->inFrontend(graph.unused));
+
+    ObsStub::removeSource(scene);
+    obs_source_release(scene);
+
+    // "source_destroy" invalidated the cache, and the weak reference of the scene has been dropped
+    CHECK(!index->inFrontend(graph.unused));
+    CHECK(index->inFrontend(graph.camera));
+
+    SourceMembershipIndex::destroyInstance();
+}
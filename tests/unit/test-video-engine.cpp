@@ -0,0 +1,154 @@
+/*
+Branch Output Plugin
+Copyright (C) 2024 OPENSPHERE Inc. info@opensphere.co.jp
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#include <obs-module.h>
+
+#include "unit-test.hpp"
+#include "obs-stub.hpp"
+#include "video/video-engine.hpp"
+#include "video/main-canvas-mirror.hpp"
+
+// Main canvas mirror needs graphics, and no test uses main canvas mode
+obs_source_t *MainCanvasMirror::create(const QString &, obs_source_t *)
+{
+    return nullptr;
+}
+
+static const obs_video_info videoInfo = {30, 1, 1920, 1080, 1920, 1080, OBS_SCALE_BICUBIC};
+
+static obs_data_t *createSettings(const char *encoderId)
+{
+    auto settings = obs_data_create();
+    obs_data_set_string(settings, "video_encoder", encoderId);
+    obs_data_set_int(settings, "bitrate", 6000);
+    return settings;
+}
+
+static void releaseEncoder(obs_encoder_t *encoder)
+{
+    VideoEngine::getInstance()->releaseEncoder(encoder);
+    obs_encoder_release(encoder);
+}
+
+UNIT_TEST(hardwareFamilyOfEncoderId)
+{
+    CHECK(VideoEngine::getHardwareFamily("jim_nvenc") == "nvenc");
+    CHECK(VideoEngine::getHardwareFamily("obs_qsv11_v2") == "qsv");
+    CHECK(VideoEngine::getHardwareFamily("h264_texture_amf") == "amf");
+    CHECK(VideoEngine::getHardwareFamily("obs_x264").isEmpty());
+}
+
+UNIT_TEST(sessionsAreCountedBeforeEncodersStart)
+{
+    auto engine = VideoEngine::getInstance();
+    engine->setHardwareSessionLimit(1);
+    engine->setFallbackEncoder("obs_x264:veryfast");
+
+    auto source1 = ObsStub::createSource("Source 1", OBS_STUB_SOURCE_INPUT);
+    auto source2 = ObsStub::createSource("Source 2", OBS_STUB_SOURCE_INPUT);
+    OBSDataAutoRelease settings = createSettings("jim_nvenc");
+
+    // Burst start: The first output hasn't connected yet when the second one acquires
+    bool fallback = true;
+    auto encoder1 = engine->acquireEncoder("Filter 1", source1, settings, &videoInfo, &videoInfo, false, &fallback);
+    CHECK(encoder1 != nullptr);
+    CHECK(!fallback);
+    CHECK(!strcmp(obs_encoder_get_id(encoder1), "jim_nvenc"));
+
+    auto encoder2 = engine->acquireEncoder("Filter 2", source2, settings, &videoInfo, &videoInfo, false, &fallback);
+    CHECK(encoder2 != nullptr);
+    CHECK(fallback);
+    CHECK(!strcmp(obs_encoder_get_id(encoder2), "obs_x264"));
+
+    // Sharing needs no new session
+    auto shared = engine->acquireEncoder("Filter 3", source1, settings, &videoInfo, &videoInfo, false, &fallback);
+    CHECK(shared == encoder1);
+    CHECK(!fallback);
+
+    releaseEncoder(shared);
+    releaseEncoder(encoder2);
+    releaseEncoder(encoder1);
+    obs_source_release(source2);
+    obs_source_release(source1);
+    VideoEngine::destroyInstance();
+}
+
+UNIT_TEST(exhaustedSessionsFailWithoutFallback)
+{
+    auto engine = VideoEngine::getInstance();
+    engine->setHardwareSessionLimit(1);
+
+    auto source = ObsStub::createSource("Source", OBS_STUB_SOURCE_INPUT);
+    OBSDataAutoRelease settings = createSettings("jim_nvenc");
+
+    // Exclusive encoders are never shared
+    auto encoder1 = engine->acquireEncoder("Filter 1", source, settings, &videoInfo, &videoInfo, false, nullptr, true);
+    CHECK(encoder1 != nullptr);
+    auto encoder2 = engine->acquireEncoder("Filter 2", source, settings, &videoInfo, &videoInfo, false, nullptr, true);
+    CHECK(encoder2 == nullptr);
+
+    // Session is given back with the last release
+    releaseEncoder(encoder1);
+    encoder2 = engine->acquireEncoder("Filter 2", source, settings, &videoInfo, &videoInfo, false, nullptr, true);
+    CHECK(encoder2 != nullptr);
+
+    releaseEncoder(encoder2);
+    obs_source_release(source);
+    VideoEngine::destroyInstance();
+}
+
+UNIT_TEST(idleStandbyUsersHoldNoSession)
+{
+    auto engine = VideoEngine::getInstance();
+    engine->setHardwareSessionLimit(1);
+    engine->setFallbackEncoder("obs_x264");
+
+    auto source1 = ObsStub::createSource("Source 1", OBS_STUB_SOURCE_INPUT);
+    auto source2 = ObsStub::createSource("Source 2", OBS_STUB_SOURCE_INPUT);
+    auto source3 = ObsStub::createSource("Source 3", OBS_STUB_SOURCE_INPUT);
+    OBSDataAutoRelease settings = createSettings("jim_nvenc");
+
+    bool fallback = true;
+    auto standby = engine->acquireEncoder("Standby", source1, settings, &videoInfo, &videoInfo, false, &fallback);
+    CHECK(!fallback);
+    engine->setStandbyIdle(standby, true);
+
+    auto active = engine->acquireEncoder("Active", source2, settings, &videoInfo, &videoInfo, false, &fallback);
+    CHECK(!fallback);
+
+    // Sharing with a user which isn't idle makes the standby encoder count again
+    auto shared = engine->acquireEncoder("Shared", source1, settings, &videoInfo, &videoInfo, false, &fallback);
+    CHECK(shared == standby);
+    releaseEncoder(active);
+    auto encoder = engine->acquireEncoder("Filter", source3, settings, &videoInfo, &videoInfo, false, &fallback);
+    CHECK(fallback);
+    releaseEncoder(encoder);
+    releaseEncoder(shared);
+
+    // Standby activation takes the session back
+    engine->setStandbyIdle(standby, false);
+    encoder = engine->acquireEncoder("Filter", source3, settings, &videoInfo, &videoInfo, false, &fallback);
+    CHECK(fallback);
+
+    releaseEncoder(encoder);
+    releaseEncoder(standby);
+    obs_source_release(source3);
+    obs_source_release(source2);
+    obs_source_release(source1);
+    VideoEngine::destroyInstance();
+}
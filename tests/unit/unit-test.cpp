@@ -0,0 +1,79 @@
+/*
+Branch Output Plugin
+Copyright (C) 2024 OPENSPHERE Inc. info@opensphere.co.jp
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#include <obs-module.h>
+
+#include <string.h>
+
+#include "unit-test.hpp"
+#include "obs-stub.hpp"
+
+static UnitTestCase *firstCase = nullptr;
+static UnitTestCase *lastCase = nullptr;
+static int failures = 0;
+
+//--- UnitTestCase struct ---//
+
+UnitTestCase::UnitTestCase(const char *_name, UnitTestFunc _func) : name(_name), func(_func), next(nullptr)
+{
+    // Keep order of definition
+    if (lastCase) {
+        lastCase->next = this;
+    } else {
+        firstCase = this;
+    }
+    lastCase = this;
+}
+
+void unitTestFail(const char *file, int line, const char *expr)
+{
+    fprintf(stderr, "%s:%d: CHECK(%s) failed\n", file, line, expr);
+    failures++;
+}
+
+// Usage: <test> [case name] [-v]
+int main(int argc, char *argv[])
+{
+    const char *filter = nullptr;
+
+    // Failure paths log warnings by design
+    ObsStub::setLogLevel(LOG_ERROR);
+
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "-v")) {
+            ObsStub::setLogLevel(LOG_DEBUG);
+        } else {
+            filter = argv[i];
+        }
+    }
+
+    int count = 0;
+    for (auto testCase = firstCase; testCase; testCase = testCase->next) {
+        if (filter && strcmp(filter, testCase->name)) {
+            continue;
+        }
+
+        auto before = failures;
+        testCase->func();
+        printf("%s: %s\n", before == failures ? "PASS" : "FAIL", testCase->name);
+        count++;
+    }
+
+    printf("%d cases, %d failed checks\n", count, failures);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,53 @@
+/*
+Branch Output Plugin
+Copyright (C) 2024 OPENSPHERE Inc. info@opensphere.co.jp
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#pragma once
+
+#include <math.h>
+#include <stdio.h>
+
+// Minimal checks for unit tests (No framework dependency).
+// A failed check is reported and counted, then the test case continues.
+// The process exits with non-zero status when any check has failed (For ctest).
+
+typedef void (*UnitTestFunc)();
+
+struct UnitTestCase {
+    const char *name;
+    UnitTestFunc func;
+    UnitTestCase *next;
+
+    UnitTestCase(const char *_name, UnitTestFunc _func);
+};
+
+void unitTestFail(const char *file, int line, const char *expr);
+
+#define UNIT_TEST(name)                          \
+    static void name();                          \
+    static UnitTestCase name##Case(#name, name); \
+    static void name()
+
+#define CHECK(cond)                                  \
+    do {                                             \
+        if (!(cond)) {                               \
+            unitTestFail(__FILE__, __LINE__, #cond); \
+        }                                            \
+    } while (0)
+
+#define CHECK_EQ(a, b) CHECK((a) == (b))
+#define CHECK_NEAR(a, b, eps) CHECK(fabs((double)(a) - (double)(b)) <= (eps))